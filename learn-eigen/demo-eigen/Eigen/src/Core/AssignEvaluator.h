@@ -847,7 +847,7 @@ template<typename Dst, typename Src, typename Func>
 EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE
 void call_assignment(Dst& dst, const Src& src, const Func& func, typename enable_if< evaluator_assume_aliasing<Src>::value, void*>::type = 0)
 {
-  typename plain_matrix_type<Src>::type tmp(src);
+  typename aliasing_temporary_type<Dst,Src>::type tmp(src);
   call_assignment_no_alias(dst, tmp, func);
 }
 
@@ -1003,6 +1003,74 @@ struct Assignment<DstXprType, SrcXprType, Functor, EigenBase2EigenBase, Weak>
   }
 };
 
+/***************************************************************************
+* Part 7 : Dense assignment through a device
+***************************************************************************/
+
+// The loop assigning the coefficients of a dense kernel on a given device (see DenseBase::device()).
+// Devices specialize it to spread the loop over their resources, the default being the
+// sequential loop on the calling thread.
+template<typename Kernel, typename Device>
+struct dense_assignment_loop_with_device
+{
+  static EIGEN_STRONG_INLINE void run(Kernel &kernel, Device &/*device*/)
+  {
+    dense_assignment_loop<Kernel>::run(kernel);
+  }
+};
+
+template<typename DstXprType, typename SrcXprType, typename Functor, typename Device>
+EIGEN_STRONG_INLINE void call_dense_assignment_loop(DstXprType& dst, const SrcXprType& src, const Functor &func, Device &device)
+{
+  typedef evaluator<DstXprType> DstEvaluatorType;
+  typedef evaluator<SrcXprType> SrcEvaluatorType;
+
+  SrcEvaluatorType srcEvaluator(src);
+  resize_if_allowed(dst, src, func);
+  DstEvaluatorType dstEvaluator(dst);
+
+  typedef generic_dense_assignment_kernel<DstEvaluatorType,SrcEvaluatorType,Functor> Kernel;
+  Kernel kernel(dstEvaluator, srcEvaluator, func, dst.const_cast_derived());
+
+  dense_assignment_loop_with_device<Kernel,Device>::run(kernel, device);
+}
+
+// Sources assumed to alias the destination (products) are evaluated by their own, possibly multi-threaded,
+// kernels into a temporary: assigning it on the device would only add a copy.
+template<typename Dst, typename Src, typename Func, typename Device>
+EIGEN_STRONG_INLINE
+void call_assignment_with_device(Dst& dst, const Src& src, const Func& func, Device &/*device*/,
+                                 typename enable_if< evaluator_assume_aliasing<Src>::value, void*>::type = 0)
+{
+  call_assignment(dst, src, func);
+}
+
+template<typename Dst, typename Src, typename Func, typename Device>
+EIGEN_STRONG_INLINE
+void call_assignment_with_device(Dst& dst, const Src& src, const Func& func, Device &device,
+                                 typename enable_if<!evaluator_assume_aliasing<Src>::value, void*>::type = 0)
+{
+  enum {
+    NeedToTranspose = (    (int(Dst::RowsAtCompileTime) == 1 && int(Src::ColsAtCompileTime) == 1)
+                        || (int(Dst::ColsAtCompileTime) == 1 && int(Src::RowsAtCompileTime) == 1)
+                      ) && int(Dst::SizeAtCompileTime) != 1
+  };
+
+  typedef typename internal::conditional<NeedToTranspose, Transpose<Dst>, Dst>::type ActualDstTypeCleaned;
+  typedef typename internal::conditional<NeedToTranspose, Transpose<Dst>, Dst&>::type ActualDstType;
+  ActualDstType actualDst(dst);
+
+  EIGEN_STATIC_ASSERT_LVALUE(Dst)
+  EIGEN_STATIC_ASSERT_SAME_MATRIX_SIZE(ActualDstTypeCleaned,Src)
+  EIGEN_CHECK_BINARY_COMPATIBILIY(Func,typename ActualDstTypeCleaned::Scalar,typename Src::Scalar);
+
+#ifndef EIGEN_NO_DEBUG
+  internal::check_for_aliasing(actualDst, src);
+#endif
+
+  call_dense_assignment_loop(actualDst, src, func, device);
+}
+
 } // namespace internal
 
 } // end namespace Eigen
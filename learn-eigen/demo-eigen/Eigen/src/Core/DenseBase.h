@@ -564,6 +564,9 @@ template<typename Derived> class DenseBase
     }
     EIGEN_DEVICE_FUNC ColwiseReturnType colwise();
 
+    template<typename Device>
+    DeviceWrapper<Derived,Device> device(Device& device);
+
     typedef CwiseNullaryOp<internal::scalar_random_op<Scalar>,PlainObject> RandomReturnType;
     static const RandomReturnType Random(Index rows, Index cols);
     static const RandomReturnType Random(Index size);
@@ -647,6 +647,171 @@ template<typename T, int _Cols, int _Options> class DenseStorage<T, Dynamic, Dyn
     EIGEN_DEVICE_FUNC T *data() { return m_data; }
 };
 
+/** \internal
+  *
+  * \class InlineDenseStorage
+  * \ingroup Core_Module
+  *
+  * \brief Stores the data of a dynamic-size matrix in an inline buffer of \a Capacity coefficients when it fits
+  *
+  * This is the storage of the dynamic-size matrices declared with InlineStorage<Capacity>. Above \a Capacity
+  * coefficients, the data is allocated on the heap as by DenseStorage. The inline buffer is aligned as the heap
+  * allocations are, so that the expressions reading such matrices need not know where their data lives.
+  *
+  * \sa DenseStorage, InlineStorage
+  */
+template<typename T, int Capacity, int _Rows, int _Cols, int _Options> class InlineDenseStorage
+{
+    enum { Align = (_Options&DontAlign)==0 };
+    internal::plain_array<T,Capacity,_Options,Align ? internal::compute_default_alignment<T,Dynamic>::value : 0> m_buffer;
+    T *m_data;
+    Index m_rows;
+    Index m_cols;
+
+    EIGEN_DEVICE_FUNC bool isInline() const { return m_data==m_buffer.array; }
+    EIGEN_DEVICE_FUNC T* allocate(Index size)
+    {
+      return size<=Capacity ? m_buffer.array : internal::conditional_aligned_new_auto<T,Align>(size);
+    }
+    EIGEN_DEVICE_FUNC void deallocate()
+    {
+      if(!isInline())
+        internal::conditional_aligned_delete_auto<T,Align>(m_data, m_rows*m_cols);
+    }
+    // leaves other empty, owning nothing but its inline buffer
+    EIGEN_DEVICE_FUNC void takeFrom(InlineDenseStorage& other)
+    {
+      if(other.isInline())
+      {
+        m_data = m_buffer.array;
+        internal::smart_move(other.m_data, other.m_data+other.m_rows*other.m_cols, m_data);
+      }
+      else
+        m_data = other.m_data;
+      m_rows = other.m_rows;
+      m_cols = other.m_cols;
+      other.m_data = other.m_buffer.array;
+      other.m_rows = _Rows==Dynamic ? 0 : _Rows;
+      other.m_cols = _Cols==Dynamic ? 0 : _Cols;
+    }
+  public:
+    EIGEN_DEVICE_FUNC InlineDenseStorage()
+      : m_data(m_buffer.array), m_rows(_Rows==Dynamic ? 0 : _Rows), m_cols(_Cols==Dynamic ? 0 : _Cols) {}
+    EIGEN_DEVICE_FUNC explicit InlineDenseStorage(internal::constructor_without_unaligned_array_assert)
+      : m_buffer(internal::constructor_without_unaligned_array_assert()), m_data(m_buffer.array),
+        m_rows(_Rows==Dynamic ? 0 : _Rows), m_cols(_Cols==Dynamic ? 0 : _Cols) {}
+    EIGEN_DEVICE_FUNC InlineDenseStorage(Index size, Index rows, Index cols)
+      : m_data(allocate(size)), m_rows(rows), m_cols(cols)
+    {
+      EIGEN_INTERNAL_DENSE_STORAGE_CTOR_PLUGIN({})
+      eigen_internal_assert(size==rows*cols && rows>=0 && cols>=0);
+    }
+    EIGEN_DEVICE_FUNC InlineDenseStorage(const InlineDenseStorage& other)
+      : m_data(allocate(other.m_rows*other.m_cols)), m_rows(other.m_rows), m_cols(other.m_cols)
+    {
+      EIGEN_INTERNAL_DENSE_STORAGE_CTOR_PLUGIN(Index size = m_rows*m_cols)
+      internal::smart_copy(other.m_data, other.m_data+other.m_rows*other.m_cols, m_data);
+    }
+    EIGEN_DEVICE_FUNC InlineDenseStorage& operator=(const InlineDenseStorage& other)
+    {
+      if (this != &other)
+      {
+        resize(other.m_rows*other.m_cols, other.m_rows, other.m_cols);
+        internal::smart_copy(other.m_data, other.m_data+other.m_rows*other.m_cols, m_data);
+      }
+      return *this;
+    }
+#if EIGEN_HAS_RVALUE_REFERENCES
+    EIGEN_DEVICE_FUNC
+    InlineDenseStorage(InlineDenseStorage&& other) EIGEN_NOEXCEPT
+    {
+      takeFrom(other);
+    }
+    EIGEN_DEVICE_FUNC
+    InlineDenseStorage& operator=(InlineDenseStorage&& other) EIGEN_NOEXCEPT
+    {
+      swap(other);
+      return *this;
+    }
+#endif
+    EIGEN_DEVICE_FUNC ~InlineDenseStorage() { deallocate(); }
+    EIGEN_DEVICE_FUNC void swap(InlineDenseStorage& other)
+    {
+      if(isInline() && other.isInline())
+      {
+        internal::plain_array_helper::swap(m_buffer, m_rows*m_cols, other.m_buffer, other.m_rows*other.m_cols);
+        numext::swap(m_rows,other.m_rows);
+        numext::swap(m_cols,other.m_cols);
+      }
+      else if(isInline() || other.isInline())
+      {
+        InlineDenseStorage& onHeap = isInline() ? other : *this;
+        InlineDenseStorage& inlined = isInline() ? *this : other;
+        T* data = onHeap.m_data;
+        const Index rows = onHeap.m_rows, cols = onHeap.m_cols;
+        onHeap.takeFrom(inlined);
+        inlined.m_data = data;
+        inlined.m_rows = rows;
+        inlined.m_cols = cols;
+      }
+      else
+      {
+        numext::swap(m_data,other.m_data);
+        numext::swap(m_rows,other.m_rows);
+        numext::swap(m_cols,other.m_cols);
+      }
+    }
+    EIGEN_DEVICE_FUNC Index rows(void) const EIGEN_NOEXCEPT {return m_rows;}
+    EIGEN_DEVICE_FUNC Index cols(void) const EIGEN_NOEXCEPT {return m_cols;}
+    void conservativeResize(Index size, Index rows, Index cols)
+    {
+      const Index oldSize = m_rows*m_cols;
+      if(size>Capacity && !isInline())
+        m_data = internal::conditional_aligned_realloc_new_auto<T,Align>(m_data, size, oldSize);
+      else if(size>Capacity || !isInline())
+      {
+        T* data = allocate(size);
+        internal::smart_copy(m_data, m_data+numext::mini(size,oldSize), data);
+        deallocate();
+        m_data = data;
+      }
+      m_rows = rows;
+      m_cols = cols;
+    }
+    EIGEN_DEVICE_FUNC void resize(Index size, Index rows, Index cols)
+    {
+      if(size != m_rows*m_cols)
+      {
+        deallocate();
+        m_data = allocate(size);
+        EIGEN_INTERNAL_DENSE_STORAGE_CTOR_PLUGIN({})
+      }
+      m_rows = rows;
+      m_cols = cols;
+    }
+    EIGEN_DEVICE_FUNC const T *data() const { return m_data; }
+    EIGEN_DEVICE_FUNC T *data() { return m_data; }
+};
+
+namespace internal {
+
+/** \internal The storage of the plain matrices and arrays: InlineDenseStorage for the dynamic-size ones
+  * declared with InlineStorage, and DenseStorage for all the others */
+template<typename T, int Size, int _Rows, int _Cols, int _Options,
+         bool HasInlineBuffer = Size==Dynamic && inline_storage_capacity<_Options>::value!=0>
+struct dense_storage_type
+{
+  typedef DenseStorage<T,Size,_Rows,_Cols,_Options> type;
+};
+
+template<typename T, int Size, int _Rows, int _Cols, int _Options>
+struct dense_storage_type<T,Size,_Rows,_Cols,_Options,true>
+{
+  typedef InlineDenseStorage<T,inline_storage_capacity<_Options>::value,_Rows,_Cols,_Options> type;
+};
+
+} // end namespace internal
+
 } // end namespace Eigen
 
 #endif // EIGEN_MATRIX_H
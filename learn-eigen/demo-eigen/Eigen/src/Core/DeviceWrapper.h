@@ -0,0 +1,85 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_DEVICEWRAPPER_H
+#define EIGEN_DEVICEWRAPPER_H
+
+namespace Eigen {
+
+/** \class DeviceWrapper
+  * \ingroup Core_Module
+  *
+  * \brief Pseudo expression providing assignment operators evaluating the coefficients on a device
+  *
+  * \tparam ExpressionType the type of the object on which to do the assignment
+  * \tparam Device the type of the device, e.g., CoreThreadPoolDevice
+  *
+  * This class is the return type of DenseBase::device(), and most of the time this is the only way it is used.
+  * Assignments through a device whose type does not specialize the assignment loop run sequentially.
+  *
+  * \sa DenseBase::device()
+  */
+template<typename ExpressionType, typename Device>
+class DeviceWrapper
+{
+  public:
+    typedef typename ExpressionType::Scalar Scalar;
+
+    DeviceWrapper(ExpressionType& expression, Device& device) : m_expression(expression), m_device(device) {}
+
+    template<typename OtherDerived>
+    EIGEN_STRONG_INLINE ExpressionType& operator=(const DenseBase<OtherDerived>& other)
+    {
+      internal::call_assignment_with_device(m_expression, other.derived(), internal::assign_op<Scalar,typename OtherDerived::Scalar>(), m_device);
+      return m_expression;
+    }
+
+    template<typename OtherDerived>
+    EIGEN_STRONG_INLINE ExpressionType& operator+=(const DenseBase<OtherDerived>& other)
+    {
+      internal::call_assignment_with_device(m_expression, other.derived(), internal::add_assign_op<Scalar,typename OtherDerived::Scalar>(), m_device);
+      return m_expression;
+    }
+
+    template<typename OtherDerived>
+    EIGEN_STRONG_INLINE ExpressionType& operator-=(const DenseBase<OtherDerived>& other)
+    {
+      internal::call_assignment_with_device(m_expression, other.derived(), internal::sub_assign_op<Scalar,typename OtherDerived::Scalar>(), m_device);
+      return m_expression;
+    }
+
+    ExpressionType& expression() const { return m_expression; }
+    Device& device() const { return m_device; }
+
+  protected:
+    ExpressionType& m_expression;
+    Device& m_device;
+};
+
+/** \returns a pseudo expression of \c *this whose assignment operators evaluate the right hand side on \a device
+  *
+  * For instance, with the Eigen/ThreadPool module:
+  * \code
+  * CoreThreadPoolDevice device(pool);
+  * C.device(device) = (A.array() * B.array()).exp() + D.array();
+  * \endcode
+  * evaluates the coefficients of the expression on the threads of \c pool. As with a regular assignment,
+  * the products appearing in the right hand side are evaluated beforehand into temporaries, by their own
+  * kernels.
+  *
+  * \sa class DeviceWrapper
+  */
+template<typename Derived>
+template<typename Device>
+DeviceWrapper<Derived,Device> DenseBase<Derived>::device(Device& device)
+{
+  return DeviceWrapper<Derived,Device>(derived(), device);
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_DEVICEWRAPPER_H
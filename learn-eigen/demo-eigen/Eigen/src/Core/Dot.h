@@ -30,11 +30,18 @@ struct dot_nocheck
 {
   typedef scalar_conj_product_op<typename traits<T>::Scalar,typename traits<U>::Scalar> conj_prod;
   typedef typename conj_prod::result_type ResScalar;
+  typedef CwiseBinaryOp<conj_prod, const T, const U> XprType;
+  EIGEN_DEVICE_FUNC
+  EIGEN_STRONG_INLINE
+  static const XprType xpr(const MatrixBase<T>& a, const MatrixBase<U>& b)
+  {
+    return a.template binaryExpr<conj_prod>(b);
+  }
   EIGEN_DEVICE_FUNC
   EIGEN_STRONG_INLINE
   static ResScalar run(const MatrixBase<T>& a, const MatrixBase<U>& b)
   {
-    return a.template binaryExpr<conj_prod>(b).sum();
+    return xpr(a, b).sum();
   }
 };
 
@@ -43,14 +50,24 @@ struct dot_nocheck<T, U, true>
 {
   typedef scalar_conj_product_op<typename traits<T>::Scalar,typename traits<U>::Scalar> conj_prod;
   typedef typename conj_prod::result_type ResScalar;
+  typedef CwiseBinaryOp<conj_prod, const Transpose<const T>, const U> XprType;
+  EIGEN_DEVICE_FUNC
+  EIGEN_STRONG_INLINE
+  static const XprType xpr(const MatrixBase<T>& a, const MatrixBase<U>& b)
+  {
+    return a.transpose().template binaryExpr<conj_prod>(b);
+  }
   EIGEN_DEVICE_FUNC
   EIGEN_STRONG_INLINE
   static ResScalar run(const MatrixBase<T>& a, const MatrixBase<U>& b)
   {
-    return a.transpose().template binaryExpr<conj_prod>(b).sum();
+    return xpr(a, b).sum();
   }
 };
 
+// dot product split over threads, see ParallelRedux.h
+template<typename T, typename U> struct parallel_dot;
+
 } // end namespace internal
 
 /** \fn MatrixBase::dot
@@ -81,6 +98,13 @@ MatrixBase<Derived>::dot(const MatrixBase<OtherDerived>& other) const
   
   eigen_assert(size() == other.size());
 
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+  // the reductions split over threads take precedence over the single-threaded dispatched kernels
+  Scalar res(0);
+  if(internal::parallel_dot<Derived,OtherDerived>::run(*this, other, res)
+     || internal::dispatched_dot<Derived,OtherDerived>::run(derived(), other.derived(), res))
+    return res;
+#endif
   return internal::dot_nocheck<Derived,OtherDerived>::run(*this, other);
 }
 
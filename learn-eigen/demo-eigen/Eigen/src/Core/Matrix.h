@@ -555,6 +555,24 @@ using Vector = Matrix<Type, Size, 1>;
 template <typename Type, int Size>
 using RowVector = Matrix<Type, 1, Size>;
 
+/** \ingroup matrixtypedefs
+  * \brief \cpp11 Dynamic-size matrix storing up to \p N coefficients without allocating
+  * \sa InlineStorage */
+template <typename Type, int N>
+using SmallMatrixX = Matrix<Type, Dynamic, Dynamic, ColMajor | InlineStorage<N>::value>;
+
+/** \ingroup matrixtypedefs
+  * \brief \cpp11 Dynamic-size vector storing up to \p N coefficients without allocating
+  * \sa InlineStorage */
+template <typename Type, int N>
+using SmallVectorX = Matrix<Type, Dynamic, 1, ColMajor | InlineStorage<N>::value>;
+
+/** \ingroup matrixtypedefs
+  * \brief \cpp11 Dynamic-size row vector storing up to \p N coefficients without allocating
+  * \sa InlineStorage */
+template <typename Type, int N>
+using SmallRowVectorX = Matrix<Type, 1, Dynamic, RowMajor | InlineStorage<N>::value>;
+
 #undef EIGEN_MAKE_TYPEDEFS
 #undef EIGEN_MAKE_FIXED_TYPEDEFS
 
@@ -0,0 +1,178 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_MATRIXBATCH_H
+#define EIGEN_MATRIXBATCH_H
+
+namespace Eigen {
+
+/** \class MatrixBatch
+  * \ingroup Core_Module
+  *
+  * \brief A batch of small matrices of the same size, stored for SIMD processing across the batch
+  *
+  * \tparam _Scalar the type of the coefficients
+  * \tparam _Rows the number of rows of each matrix, or \c Dynamic
+  * \tparam _Cols the number of columns of each matrix, or \c Dynamic
+  *
+  * Operations on a single tiny matrix, e.g. a 3x3 product, cannot make a good use of SIMD instructions.
+  * This class stores a batch of such matrices so that a packet holds the same coefficient of
+  * \c PacketSize consecutive matrices of the batch, i.e., each SIMD lane works on its own matrix.
+  * The matrices are grouped by \c PacketSize, and within a group the coefficients are stored in
+  * column-major order, each coefficient being made of \c PacketSize contiguous scalars.
+  * The batch is padded with zero matrices up to a multiple of \c PacketSize.
+  *
+  * The individual matrices are accessed through matrix(), which returns a strided Map:
+  * \code
+  * MatrixBatch<float,3,3> A(n), B(n), C;
+  * for(Index b=0; b<n; ++b)
+  * {
+  *   A.matrix(b) = ...;
+  *   B.matrix(b) = ...;
+  * }
+  * batchedProduct(A, B, C);  // C.matrix(b) == A.matrix(b) * B.matrix(b)
+  * \endcode
+  *
+  * \sa batchedProduct()
+  */
+template<typename _Scalar, int _Rows, int _Cols> class MatrixBatch
+{
+  public:
+
+    typedef _Scalar Scalar;
+    typedef Eigen::Index Index;
+    enum {
+      RowsAtCompileTime = _Rows,
+      ColsAtCompileTime = _Cols,
+      PacketSize = internal::packet_traits<Scalar>::size
+    };
+    typedef Matrix<Scalar,_Rows,_Cols> MatrixType;
+    typedef Map<MatrixType, Unaligned, Stride<Dynamic,Dynamic> > MatrixMapType;
+    typedef Map<const MatrixType, Unaligned, Stride<Dynamic,Dynamic> > ConstMatrixMapType;
+
+    /** Default constructor, the batch is empty. */
+    MatrixBatch()
+      : m_rows(RowsAtCompileTime==Dynamic ? 0 : RowsAtCompileTime),
+        m_cols(ColsAtCompileTime==Dynamic ? 0 : ColsAtCompileTime),
+        m_size(0)
+    {}
+
+    /** Constructs a batch of \a size fixed-size matrices. */
+    explicit MatrixBatch(Index size)
+      : m_rows(RowsAtCompileTime), m_cols(ColsAtCompileTime), m_size(0)
+    {
+      EIGEN_STATIC_ASSERT(RowsAtCompileTime!=Dynamic && ColsAtCompileTime!=Dynamic, YOU_MADE_A_PROGRAMMING_MISTAKE)
+      resize(size);
+    }
+
+    /** Constructs a batch of \a size matrices of size \a rows x \a cols. */
+    MatrixBatch(Index rows, Index cols, Index size)
+      : m_rows(rows), m_cols(cols), m_size(0)
+    {
+      resize(rows, cols, size);
+    }
+
+    /** Resizes the batch to \a size matrices. The coefficients are left uninitialized. */
+    void resize(Index size)
+    {
+      resize(rows(), cols(), size);
+    }
+
+    /** Resizes the batch to \a size matrices of size \a rows x \a cols. The coefficients are left uninitialized. */
+    void resize(Index rows, Index cols, Index size)
+    {
+      eigen_assert(rows>=0 && (RowsAtCompileTime==Dynamic || RowsAtCompileTime==rows)
+                && cols>=0 && (ColsAtCompileTime==Dynamic || ColsAtCompileTime==cols)
+                && size>=0);
+      m_rows.setValue(rows);
+      m_cols.setValue(cols);
+      m_size = size;
+      m_data.resize(groups() * rows * cols * PacketSize);
+      // keep the padding matrices at zero so that they never hold NaNs or denormals
+      if(size % PacketSize != 0)
+      {
+        Scalar* last = m_data.data() + (groups()-1) * rows * cols * PacketSize;
+        for(Index c=0; c<rows*cols; ++c)
+          for(Index l=size % PacketSize; l<PacketSize; ++l)
+            last[c*PacketSize + l] = Scalar(0);
+      }
+    }
+
+    /** Sets all the coefficients of all the matrices to zero. */
+    void setZero() { m_data.setZero(); }
+
+    /** \returns the number of rows of the matrices */
+    inline Index rows() const { return m_rows.value(); }
+    /** \returns the number of columns of the matrices */
+    inline Index cols() const { return m_cols.value(); }
+    /** \returns the number of matrices in the batch */
+    inline Index size() const { return m_size; }
+    /** \returns the number of groups of \c PacketSize matrices, including the padded one */
+    inline Index groups() const { return (m_size + PacketSize - 1) / PacketSize; }
+
+    /** \returns a pointer to the storage of the batch */
+    inline Scalar* data() { return m_data.data(); }
+    inline const Scalar* data() const { return m_data.data(); }
+
+    /** \returns a writable view of the \a b-th matrix of the batch */
+    inline MatrixMapType matrix(Index b)
+    {
+      eigen_assert(b>=0 && b<m_size);
+      return MatrixMapType(m_data.data() + offset(b), rows(), cols(), Stride<Dynamic,Dynamic>(rows()*PacketSize, PacketSize));
+    }
+
+    /** \returns a read-only view of the \a b-th matrix of the batch */
+    inline ConstMatrixMapType matrix(Index b) const
+    {
+      eigen_assert(b>=0 && b<m_size);
+      return ConstMatrixMapType(m_data.data() + offset(b), rows(), cols(), Stride<Dynamic,Dynamic>(rows()*PacketSize, PacketSize));
+    }
+
+  protected:
+
+    // offset of the first coefficient of the b-th matrix
+    inline Index offset(Index b) const { return (b / PacketSize) * rows() * cols() * PacketSize + b % PacketSize; }
+
+    Matrix<Scalar,Dynamic,1> m_data;
+    internal::variable_if_dynamic<Index,RowsAtCompileTime> m_rows;
+    internal::variable_if_dynamic<Index,ColsAtCompileTime> m_cols;
+    Index m_size;
+};
+
+/** \ingroup Core_Module
+  *
+  * Computes the products \c dst.matrix(b) \c = \c lhs.matrix(b) \c * \c rhs.matrix(b) for all the matrices
+  * of the batches, \a dst being resized as needed. \a dst must not be \a lhs nor \a rhs.
+  *
+  * Each SIMD lane computes the product of one pair of matrices, so that the performance does not depend
+  * on the size of the matrices being a multiple of the packet size. The loops are fully unrolled when
+  * the sizes are known at compile time.
+  *
+  * When Eigen is compiled with OpenMP or with \c EIGEN_GEMM_THREADPOOL, large batches are split across
+  * nbThreads() threads.
+  *
+  * \sa class MatrixBatch
+  */
+template<typename Scalar, int Rows, int LhsCols, int RhsRows, int Cols>
+void batchedProduct(const MatrixBatch<Scalar,Rows,LhsCols>& lhs, const MatrixBatch<Scalar,RhsRows,Cols>& rhs,
+                    MatrixBatch<Scalar,Rows,Cols>& dst)
+{
+  EIGEN_STATIC_ASSERT(LhsCols==Dynamic || RhsRows==Dynamic || LhsCols==RhsRows, INVALID_MATRIX_PRODUCT)
+  enum { Depth = LhsCols!=Dynamic ? LhsCols : RhsRows };
+  eigen_assert(lhs.cols()==rhs.rows() && lhs.size()==rhs.size() && "invalid batched matrix product");
+  eigen_assert((void*)&dst!=(void*)&lhs && (void*)&dst!=(void*)&rhs && "aliasing is not supported by batchedProduct");
+
+  dst.resize(lhs.rows(), rhs.cols(), lhs.size());
+  if(dst.size()==0 || dst.rows()==0 || dst.cols()==0)
+    return;
+  internal::batched_gemm<Scalar,Index,Rows,Cols,Depth>(lhs.data(), rhs.data(), dst.data(),
+                                                      lhs.rows(), rhs.cols(), lhs.cols(), lhs.groups());
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_MATRIXBATCH_H
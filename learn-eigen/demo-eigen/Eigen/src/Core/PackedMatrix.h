@@ -0,0 +1,249 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_PACKEDMATRIX_H
+#define EIGEN_PACKEDMATRIX_H
+
+namespace Eigen {
+
+/** \class PackedMatrix
+  * \ingroup Core_Module
+  *
+  * \brief A dense matrix stored in the packed panel layout of the matrix-matrix product kernel
+  *
+  * \tparam _Scalar the type of the coefficients
+  * \tparam _Side either \c #OnTheLeft if the matrix is meant to be the left factor of the products,
+  *               or \c #OnTheRight if it is meant to be the right factor
+  *
+  * Every general matrix-matrix product copies both of its operands into temporary buffers laid out
+  * for the gebp kernel before doing any arithmetic. When the same matrix takes part in many products,
+  * e.g. the weights of a layer applied to successive inputs, this class allows to pay for this copy
+  * once: the matrix is packed at construction time, and the products with a PackedMatrix only pack
+  * the other operand:
+  * \code
+  * PackedMatrix<float,OnTheLeft> W(weights);
+  * for(...)
+  *   Y = W * X;
+  * \endcode
+  *
+  * The product of a PackedMatrix with a matrix expression is evaluated directly into the destination
+  * if the latter is a column-major matrix with unit inner stride which does not share its memory with
+  * the other operand, e.g. \c X \c = \c W \c * \c X, and through a temporary otherwise.
+  * The other operand is evaluated if it does not expose its coefficients in memory, or if its scalar
+  * factor or conjugation cannot be read from its storage.
+  *
+  * The depth blocking is chosen at packing time from the current cache sizes, see
+  * setCpuCacheSizes(). Products with a PackedMatrix are not parallelized.
+  *
+  * \sa MatrixBase::operator*()
+  */
+
+namespace internal {
+
+template<typename PackedType, typename Other, int Side> struct packed_matrix_product_impl;
+
+template<typename Scalar, typename Other>
+struct traits<packed_matrix_product_impl<PackedMatrix<Scalar,OnTheLeft>,Other,OnTheLeft> >
+{
+  typedef typename make_proper_matrix_type<Scalar, Dynamic, Other::ColsAtCompileTime,
+                                           AutoAlign | ColMajor, Dynamic, Other::MaxColsAtCompileTime>::type ReturnType;
+};
+
+template<typename Scalar, typename Other>
+struct traits<packed_matrix_product_impl<PackedMatrix<Scalar,OnTheRight>,Other,OnTheRight> >
+{
+  typedef typename make_proper_matrix_type<Scalar, Other::RowsAtCompileTime, Dynamic,
+                                           AutoAlign | ColMajor, Other::MaxRowsAtCompileTime, Dynamic>::type ReturnType;
+};
+
+template<typename Scalar, typename Index, int Side> struct general_matrix_matrix_product_packed;
+
+} // end namespace internal
+
+template<typename _Scalar, int _Side> class PackedMatrix
+{
+  public:
+
+    typedef _Scalar Scalar;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    typedef Eigen::Index Index;
+    enum { Side = _Side };
+
+    /** Default constructor, the packed matrix is empty until compute() is called. */
+    PackedMatrix() : m_rows(0), m_cols(0), m_kc(0) {}
+
+    /** Packs the matrix \a matrix. \sa compute() */
+    template<typename Derived>
+    explicit PackedMatrix(const MatrixBase<Derived>& matrix)
+      : m_rows(0), m_cols(0), m_kc(0)
+    {
+      compute(matrix);
+    }
+
+    /** Packs the matrix \a matrix, replacing the current content of \c *this.
+      *
+      * \a matrix can be any expression; it is evaluated if its coefficients are not directly
+      * accessible in memory with a unit inner stride.
+      */
+    template<typename Derived>
+    PackedMatrix& compute(const MatrixBase<Derived>& matrix)
+    {
+      EIGEN_STATIC_ASSERT(int(Side)==OnTheLeft || int(Side)==OnTheRight, INVALID_TEMPLATE_PARAMETER)
+      EIGEN_STATIC_ASSERT((internal::is_same<Scalar,typename Derived::Scalar>::value),
+        YOU_MIXED_DIFFERENT_NUMERIC_TYPES__YOU_NEED_TO_USE_THE_CAST_METHOD_OF_MATRIXBASE_TO_CAST_NUMERIC_TYPES_EXPLICITLY)
+      enum { StorageOrder = (int(Derived::Flags)&RowMajorBit) ? RowMajor : ColMajor };
+      typedef Ref<const Matrix<Scalar,Dynamic,Dynamic,StorageOrder>, 0, OuterStride<> > MatrixRef;
+      typedef internal::general_matrix_matrix_product_packed<Scalar,Index,Side> Impl;
+
+      MatrixRef mat(matrix.derived());
+      m_rows = mat.rows();
+      m_cols = mat.cols();
+      const Index depth = depthSize();
+      const Index size = int(Side)==OnTheLeft ? m_rows : m_cols;
+      m_kc = Impl::blockingDepth(depth, size);
+      m_data.resize(Impl::packedSize(depth, m_kc, size));
+      if(m_data.size()>0)
+        Impl::template pack<StorageOrder>(m_data.data(), m_kc, mat.data(), mat.outerStride(), m_rows, m_cols);
+      return *this;
+    }
+
+    /** \returns the number of rows of the packed matrix */
+    EIGEN_CONSTEXPR inline Index rows() const EIGEN_NOEXCEPT { return m_rows; }
+    /** \returns the number of columns of the packed matrix */
+    EIGEN_CONSTEXPR inline Index cols() const EIGEN_NOEXCEPT { return m_cols; }
+
+    /** \returns the block size along the inner dimension of the products used to pack the matrix */
+    inline Index blockingDepth() const { return m_kc; }
+
+    /** \returns a pointer to the packed coefficients */
+    inline const Scalar* data() const { return m_data.data(); }
+
+    /** \returns an expression of the product of \c *this by the matrix \a other.
+      * \c *this must have been packed \c #OnTheLeft. */
+    template<typename OtherDerived>
+    inline const internal::packed_matrix_product_impl<PackedMatrix,OtherDerived,Side>
+    operator*(const MatrixBase<OtherDerived>& other) const
+    {
+      EIGEN_STATIC_ASSERT(int(Side)==OnTheLeft, THE_PACKED_MATRIX_WAS_PACKED_FOR_THE_OTHER_SIDE_OF_THE_PRODUCT)
+      return internal::packed_matrix_product_impl<PackedMatrix,OtherDerived,Side>(*this, other.derived());
+    }
+
+    /** \returns an expression of the product of the matrix \a other by \a packed.
+      * \a packed must have been packed \c #OnTheRight. */
+    template<typename OtherDerived> friend
+    inline const internal::packed_matrix_product_impl<PackedMatrix,OtherDerived,Side>
+    operator*(const MatrixBase<OtherDerived>& other, const PackedMatrix& packed)
+    {
+      EIGEN_STATIC_ASSERT(int(Side)==OnTheRight, THE_PACKED_MATRIX_WAS_PACKED_FOR_THE_OTHER_SIDE_OF_THE_PRODUCT)
+      return internal::packed_matrix_product_impl<PackedMatrix,OtherDerived,Side>(packed, other.derived());
+    }
+
+  protected:
+
+    // the inner dimension of the products
+    Index depthSize() const { return int(Side)==OnTheLeft ? m_cols : m_rows; }
+
+    Matrix<Scalar,Dynamic,1> m_data;
+    Index m_rows;
+    Index m_cols;
+    Index m_kc;
+};
+
+namespace internal {
+
+template<typename PackedType, typename Other, int Side>
+struct packed_matrix_product_impl
+  : public ReturnByValue<packed_matrix_product_impl<PackedType,Other,Side> >
+{
+  typedef typename PackedType::Scalar Scalar;
+  typedef general_matrix_matrix_product_packed<Scalar,Index,Side> Impl;
+  enum { OtherStorageOrder = (int(Other::Flags)&RowMajorBit) ? RowMajor : ColMajor };
+  typedef Ref<const Matrix<Scalar,Dynamic,Dynamic,OtherStorageOrder>, 0, OuterStride<> > OtherRef;
+
+  packed_matrix_product_impl(const PackedType& packed, const Other& other)
+    : m_packed(packed), m_other(other)
+  {
+    EIGEN_STATIC_ASSERT((is_same<Scalar,typename Other::Scalar>::value),
+      YOU_MIXED_DIFFERENT_NUMERIC_TYPES__YOU_NEED_TO_USE_THE_CAST_METHOD_OF_MATRIXBASE_TO_CAST_NUMERIC_TYPES_EXPLICITLY)
+    eigen_assert((int(Side)==OnTheLeft ? packed.cols()==other.rows() : other.cols()==packed.rows())
+                 && "invalid matrix product" && "if you wanted a coeff-wise or a dot product use the respective explicit functions");
+  }
+
+  EIGEN_CONSTEXPR inline Index rows() const EIGEN_NOEXCEPT { return int(Side)==OnTheLeft ? m_packed.rows() : m_other.rows(); }
+  EIGEN_CONSTEXPR inline Index cols() const EIGEN_NOEXCEPT { return int(Side)==OnTheLeft ? m_other.cols() : m_packed.cols(); }
+
+  template<typename Dest> void evalTo(Dest& dst) const
+  {
+    enum {
+      // the gebp kernel writes to a column-major destination with unit inner stride, and a row vector with
+      // unit inner stride can be seen as such a matrix with an outer stride of 1
+      DirectEval = (int(Dest::Flags)&DirectAccessBit) && int(Dest::InnerStrideAtCompileTime)==1
+                && (!(int(Dest::Flags)&RowMajorBit) || int(Dest::RowsAtCompileTime)==1)
+    };
+    eval_to(dst, typename conditional<DirectEval,true_type,false_type>::type());
+  }
+
+  /** \internal adds \a alpha times the product to the column-major matrix \a res */
+  void scaleAndAddTo(Scalar* res, Index resStride, const Scalar& alpha) const
+  {
+    OtherRef other(m_other);
+    scaleAndAddTo(other, res, resStride, alpha);
+  }
+
+protected:
+
+  void scaleAndAddTo(const OtherRef& other, Scalar* res, Index resStride, const Scalar& alpha) const
+  {
+    if(rows()==0 || cols()==0)
+      return;
+    const Index depth = int(Side)==OnTheLeft ? m_packed.cols() : m_packed.rows();
+    if(depth==0)
+      return;
+    if(int(Side)==OnTheLeft)
+      Impl::template run<OtherStorageOrder>(rows(), cols(), depth, m_packed.data(), m_packed.blockingDepth(),
+                                            other.data(), other.outerStride(), res, resStride, alpha);
+    else
+      Impl::template run<OtherStorageOrder>(rows(), cols(), depth, other.data(), other.outerStride(),
+                                            m_packed.data(), m_packed.blockingDepth(), res, resStride, alpha);
+  }
+
+  // \returns whether the memory spanned by \a other intersects the one of \a dst
+  template<typename Dest> static bool shares_memory(const OtherRef& other, const Dest& dst)
+  {
+    if(other.size()==0 || dst.size()==0)
+      return false;
+    const Scalar* otherEnd = other.data() + (other.outerSize()-1)*other.outerStride() + other.innerSize();
+    const Scalar* dstEnd = dst.data() + (dst.outerSize()-1)*dst.outerStride() + dst.innerSize();
+    return std::less<const Scalar*>()(other.data(), dstEnd) && std::less<const Scalar*>()(dst.data(), otherEnd);
+  }
+
+  template<typename Dest> void eval_to(Dest& dst, true_type) const
+  {
+    // the other operand is evaluated before dst is cleared, and read from a temporary if it is stored in dst
+    OtherRef other(m_other);
+    if(shares_memory(other, dst))
+      return eval_to(dst, false_type());
+    dst.setZero();
+    scaleAndAddTo(other, dst.data(), (int(Dest::Flags)&RowMajorBit) ? 1 : dst.outerStride(), Scalar(1));
+  }
+
+  template<typename Dest> void eval_to(Dest& dst, false_type) const
+  {
+    Matrix<Scalar,Dynamic,Dynamic,ColMajor> tmp = Matrix<Scalar,Dynamic,Dynamic,ColMajor>::Zero(rows(), cols());
+    scaleAndAddTo(tmp.data(), tmp.outerStride(), Scalar(1));
+    dst = tmp;
+  }
+
+  const PackedType& m_packed;
+  typename Other::Nested m_other;
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_PACKEDMATRIX_H
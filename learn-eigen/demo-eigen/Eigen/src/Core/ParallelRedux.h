@@ -0,0 +1,416 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_PARALLEL_REDUX_H
+#define EIGEN_PARALLEL_REDUX_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal */
+inline void manage_parallel_reductions(Action action, bool* v)
+{
+  static bool m_enabled = false;
+
+  if(action==SetAction)
+  {
+    eigen_internal_assert(v!=0);
+    m_enabled = *v;
+  }
+  else if(action==GetAction)
+  {
+    eigen_internal_assert(v!=0);
+    *v = m_enabled;
+  }
+  else
+  {
+    eigen_internal_assert(false);
+  }
+}
+
+} // end namespace internal
+
+/** \returns whether the full reductions of large dynamic-size objects may be split over several threads
+  * \sa setParallelReductions() */
+inline bool parallelReductions()
+{
+  bool ret;
+  internal::manage_parallel_reductions(GetAction, &ret);
+  return ret;
+}
+
+/** Enables or disables the splitting of the full reductions of large dynamic-size objects, e.g., sum(),
+  * prod(), minCoeff(), maxCoeff(), mean(), squaredNorm(), norm(), dot() and stableNorm(), over the
+  * threads used by the products (OpenMP, or the pool registered with setGemmThreadPool()). It is disabled
+  * by default.
+  *
+  * The coefficients are split into as many consecutive chunks as nbThreads() allows, each one being
+  * reduced as the whole object would be on a single thread, and the partial results are combined in the
+  * order of the chunks. The chunks only depend on the size of the object and on nbThreads(), and not on
+  * the threads actually available (e.g., when called from a parallel region), so that the results are
+  * reproducible bit for bit for a given number of threads. They usually differ in the last bits from the
+  * ones of the single-threaded reductions.
+  *
+  * The partial reductions of large objects by sum(), prod(), minCoeff(), maxCoeff(), mean(), squaredNorm(),
+  * norm() and redux(), e.g., \c A.colwise().sum(), are split in the same way into chunks of consecutive
+  * inner vectors of \c A.
+  *
+  * \sa parallelReductions(), setNbThreads() */
+inline void setParallelReductions(bool enable)
+{
+  internal::manage_parallel_reductions(SetAction, &enable);
+}
+
+namespace internal {
+
+// minimal cost, in the units of the cost model of the evaluators, of a chunk of a parallel reduction
+const double ParallelReduxMinTaskCost = 100000;
+
+/** \internal \returns the number of chunks among which a reduction of \a units independent units costing
+  * \a cost in total is split, which is 1 when the parallel reductions are disabled or not available */
+inline Index parallel_redux_chunks(Index units, double cost)
+{
+#if (defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)) && !defined(EIGEN_USE_BLAS)
+  if(!parallelReductions())
+    return 1;
+  const double chunks = numext::mini(double(numext::mini(Index(nbThreads()), units)), cost / ParallelReduxMinTaskCost);
+  return numext::maxi(Index(1), Index(chunks));
+#else
+  EIGEN_UNUSED_VARIABLE(units);
+  EIGEN_UNUSED_VARIABLE(cost);
+  return 1;
+#endif
+}
+
+// A chunk of a parallel reduction: the coefficients of the inner vectors [outerStart,outerEnd) restricted
+// to [innerStart,innerEnd), or the coefficients [innerStart,innerEnd) of the linear order for
+// LinearVectorizedTraversal.
+struct redux_chunk
+{
+  Index outerStart, outerEnd, innerStart, innerEnd;
+};
+
+// reduction of one chunk, mimicking the one of the whole object by redux_impl
+template<typename Func, typename Evaluator, int Traversal = redux_traits<Func, Evaluator>::Traversal>
+struct redux_chunk_impl
+{
+  typedef typename Evaluator::Scalar Scalar;
+
+  static Scalar run(const Evaluator& eval, const Func& func, const redux_chunk& c)
+  {
+    Scalar res = eval.coeffByOuterInner(c.outerStart, c.innerStart);
+    for(Index i=c.innerStart+1; i<c.innerEnd; ++i)
+      res = func(res, eval.coeffByOuterInner(c.outerStart, i));
+    for(Index j=c.outerStart+1; j<c.outerEnd; ++j)
+      for(Index i=c.innerStart; i<c.innerEnd; ++i)
+        res = func(res, eval.coeffByOuterInner(j, i));
+    return res;
+  }
+
+  template<typename XprType>
+  static Index aligned_start(const XprType&) { return 0; }
+
+  // reduces the coefficients left out of the chunks into res
+  static void reduce_edges(const Evaluator&, const Func&, Scalar&, Index /*alignedStart*/, Index /*alignedEnd*/, Index /*size*/) {}
+};
+
+template<typename Func, typename Evaluator>
+struct redux_chunk_impl<Func, Evaluator, SliceVectorizedTraversal>
+{
+  typedef typename Evaluator::Scalar Scalar;
+  typedef typename redux_traits<Func, Evaluator>::PacketType PacketType;
+  enum { PacketSize = redux_traits<Func, Evaluator>::PacketSize };
+
+  static Scalar run(const Evaluator& eval, const Func& func, const redux_chunk& c)
+  {
+    const Index packetEnd = c.innerStart + ((c.innerEnd-c.innerStart)/PacketSize)*PacketSize;
+    if(packetEnd==c.innerStart)
+      return redux_chunk_impl<Func, Evaluator, DefaultTraversal>::run(eval, func, c);
+
+    PacketType packet_res = eval.template packetByOuterInner<Unaligned,PacketType>(c.outerStart, c.innerStart);
+    for(Index j=c.outerStart; j<c.outerEnd; ++j)
+      for(Index i=(j==c.outerStart ? c.innerStart+PacketSize : c.innerStart); i<packetEnd; i+=PacketSize)
+        packet_res = func.packetOp(packet_res, eval.template packetByOuterInner<Unaligned,PacketType>(j,i));
+    Scalar res = func.predux(packet_res);
+    for(Index j=c.outerStart; j<c.outerEnd; ++j)
+      for(Index i=packetEnd; i<c.innerEnd; ++i)
+        res = func(res, eval.coeffByOuterInner(j,i));
+    return res;
+  }
+
+  template<typename XprType>
+  static Index aligned_start(const XprType&) { return 0; }
+
+  static void reduce_edges(const Evaluator&, const Func&, Scalar&, Index, Index, Index) {}
+};
+
+template<typename Func, typename Evaluator>
+struct redux_chunk_impl<Func, Evaluator, LinearVectorizedTraversal>
+{
+  typedef typename Evaluator::Scalar Scalar;
+  typedef typename redux_traits<Func, Evaluator>::PacketType PacketType;
+  enum {
+    PacketSize = redux_traits<Func, Evaluator>::PacketSize,
+    Alignment = Evaluator::Alignment
+  };
+
+  // the chunk is made of whole packets, starting at a multiple of PacketSize from the first aligned coefficient
+  static Scalar run(const Evaluator& eval, const Func& func, const redux_chunk& c)
+  {
+    PacketType p0 = eval.template packet<Alignment,PacketType>(c.innerStart);
+    Index index = c.innerStart + PacketSize;
+    if(c.innerEnd-c.innerStart >= 2*PacketSize)
+    {
+      PacketType p1 = eval.template packet<Alignment,PacketType>(index);
+      for(index += PacketSize; index+2*PacketSize <= c.innerEnd; index += 2*PacketSize)
+      {
+        p0 = func.packetOp(p0, eval.template packet<Alignment,PacketType>(index));
+        p1 = func.packetOp(p1, eval.template packet<Alignment,PacketType>(index+PacketSize));
+      }
+      p0 = func.packetOp(p0, p1);
+    }
+    for(; index < c.innerEnd; index += PacketSize)
+      p0 = func.packetOp(p0, eval.template packet<Alignment,PacketType>(index));
+    return func.predux(p0);
+  }
+
+  template<typename XprType>
+  static Index aligned_start(const XprType& xpr)
+  {
+    return internal::first_default_aligned(xpr);
+  }
+
+  static void reduce_edges(const Evaluator& eval, const Func& func, Scalar& res, Index alignedStart, Index alignedEnd, Index size)
+  {
+    for(Index index=0; index<alignedStart; ++index)
+      res = func(res, eval.coeff(index));
+    for(Index index=alignedEnd; index<size; ++index)
+      res = func(res, eval.coeff(index));
+  }
+};
+
+/* Full reduction split over threads.
+ *
+ * A single evaluator of the expression is shared by the threads, so that the nested products and other
+ * temporaries are evaluated once. The chunks are made of:
+ * - whole packets starting at the first aligned coefficient for LinearVectorizedTraversal, the unaligned
+ *   head and the tail being reduced by the calling thread;
+ * - whole inner vectors for matrices;
+ * - consecutive coefficients (whole packets for SliceVectorizedTraversal) of the single inner vector of vectors.
+ */
+template<typename Func, typename Derived, bool IsDynamic>
+struct parallel_redux
+{
+  typedef typename Derived::Scalar Scalar;
+  typedef redux_evaluator<Derived> Evaluator;
+  typedef redux_traits<Func, Evaluator> Traits;
+  typedef redux_chunk_impl<Func, Evaluator> ChunkImpl;
+  enum {
+    Traversal = Traits::Traversal,
+    PacketSize = Traits::PacketSize,
+    CoeffCost = int(Evaluator::CoeffReadCost) + int(functor_traits<Func>::Cost)
+  };
+
+  struct Task
+  {
+    Task(const Evaluator& eval, const Func& func, const Derived& xpr, Index chunks, Index start, Index units, Index step, Scalar* partial)
+      : m_eval(eval), m_func(func), m_xpr(xpr), m_chunks(chunks), m_start(start), m_units(units), m_step(step), m_partial(partial)
+    {}
+
+    void operator()(Index t) const
+    {
+      const Index first = m_start + (m_units*t/m_chunks)*m_step;
+      const Index last = m_start + (m_units*(t+1)/m_chunks)*m_step;
+      redux_chunk c;
+      if(int(Traversal)==LinearVectorizedTraversal)
+      {
+        c.outerStart = 0;     c.outerEnd = 1;
+        c.innerStart = first; c.innerEnd = last;
+      }
+      else if(m_xpr.outerSize()>1)
+      {
+        c.outerStart = first; c.outerEnd = last;
+        c.innerStart = 0;     c.innerEnd = m_xpr.innerSize();
+      }
+      else
+      {
+        c.outerStart = 0;     c.outerEnd = 1;
+        c.innerStart = first; c.innerEnd = (t+1==m_chunks) ? m_xpr.innerSize() : last;
+      }
+      m_partial[t] = ChunkImpl::run(m_eval, m_func, c);
+    }
+
+    const Evaluator& m_eval;
+    const Func& m_func;
+    const Derived& m_xpr;
+    Index m_chunks, m_start, m_units, m_step;
+    Scalar* m_partial;
+  };
+
+  /** \internal Reduces \a xpr with \a func on several threads into \a res. \returns false, without computing
+    * anything, when the reduction is not worth splitting */
+  static bool run(const Derived& xpr, const Func& func, Scalar& res)
+  {
+    const Index size = xpr.size();
+    const double cost = double(size) * double(CoeffCost);
+    if(cost < 2*ParallelReduxMinTaskCost || !parallelReductions())
+      return false;
+
+    Index start = 0, units, step = 1, alignedEnd = size;
+    if(int(Traversal)==LinearVectorizedTraversal)
+    {
+      start = ChunkImpl::aligned_start(xpr);
+      units = (size-start)/PacketSize;
+      step = PacketSize;
+      alignedEnd = start + units*PacketSize;
+    }
+    else if(xpr.outerSize()>1)
+      units = xpr.outerSize();
+    else
+    {
+      step = int(Traversal)==SliceVectorizedTraversal ? Index(PacketSize) : Index(1);
+      units = xpr.innerSize()/step;
+    }
+
+    const Index chunks = parallel_redux_chunks(units, cost);
+    if(chunks<=1)
+      return false;
+
+    Evaluator eval(xpr);
+    ei_declare_aligned_stack_constructed_variable(Scalar, partial, chunks, 0);
+    parallel_product_run(chunks, Task(eval, func, xpr, chunks, start, units, step, partial));
+
+    res = partial[0];
+    for(Index t=1; t<chunks; ++t)
+      res = func(res, partial[t]);
+    ChunkImpl::reduce_edges(eval, func, res, start, alignedEnd, size);
+    return true;
+  }
+};
+
+// fixed-size objects are never split, and do not instantiate the threaded reduction
+template<typename Func, typename Derived>
+struct parallel_redux<Func, Derived, false>
+{
+  static bool run(const Derived&, const Func&, typename Derived::Scalar&) { return false; }
+};
+
+/** \internal Computes the dot product of \a a and \a b on several threads. \returns false when it is not worth it */
+template<typename T, typename U>
+struct parallel_dot
+{
+  typedef dot_nocheck<T,U> Dot;
+  typedef typename Dot::XprType XprType;
+  typedef typename Dot::ResScalar ResScalar;
+
+  static bool run(const MatrixBase<T>& a, const MatrixBase<U>& b, ResScalar& res)
+  {
+    return parallel_redux<scalar_sum_op<ResScalar,ResScalar>,XprType>::run(Dot::xpr(a, b), scalar_sum_op<ResScalar,ResScalar>(), res);
+  }
+};
+
+/* stableNorm() split over threads.
+ *
+ * The chunks are made of whole blocks of the sequential algorithm for vectors, and of whole inner vectors
+ * for matrices, each one computing its own scale and scaled sum of squares. The partial sums are then
+ * rescaled to the largest scale, in the order of the chunks.
+ */
+template<typename MatrixType, bool IsDynamic>
+struct parallel_stable_norm
+{
+  typedef typename MatrixType::RealScalar RealScalar;
+  enum { BlockSize = 4096 };
+
+  template<typename VectorType>
+  static void chunk(const VectorType& vec, Index first, Index last, RealScalar& ssq, RealScalar& scale,
+                    typename enable_if<VectorType::IsVectorAtCompileTime>::type* = 0)
+  {
+    typedef Block<const VectorType, VectorType::IsRowMajor ? 1 : Dynamic, VectorType::IsRowMajor ? Dynamic : 1> SegmentType;
+    RealScalar invScale(1);
+    const Index start = first*BlockSize;
+    const Index size = numext::mini(vec.size(), last*BlockSize) - start;
+    stable_norm_impl_inner_step(VectorType::IsRowMajor ? SegmentType(vec, 0, start, 1, size) : SegmentType(vec, start, 0, size, 1),
+                                ssq, scale, invScale);
+  }
+
+  template<typename OtherMatrixType>
+  static void chunk(const OtherMatrixType& mat, Index first, Index last, RealScalar& ssq, RealScalar& scale,
+                    typename enable_if<!OtherMatrixType::IsVectorAtCompileTime>::type* = 0)
+  {
+    RealScalar invScale(1);
+    for(Index j=first; j<last; ++j)
+      stable_norm_impl_inner_step(mat.innerVector(j), ssq, scale, invScale);
+  }
+
+  struct Task
+  {
+    Task(const MatrixType& mat, Index chunks, Index units, RealScalar* ssq, RealScalar* scale)
+      : m_mat(mat), m_chunks(chunks), m_units(units), m_ssq(ssq), m_scale(scale)
+    {}
+
+    void operator()(Index t) const
+    {
+      m_ssq[t] = RealScalar(0);
+      m_scale[t] = RealScalar(0);
+      chunk(m_mat, m_units*t/m_chunks, m_units*(t+1)/m_chunks, m_ssq[t], m_scale[t]);
+    }
+
+    const MatrixType& m_mat;
+    Index m_chunks, m_units;
+    RealScalar* m_ssq;
+    RealScalar* m_scale;
+  };
+
+  static bool run(const MatrixType& mat, RealScalar& res)
+  {
+    using std::sqrt;
+    if(mat.size()<2*BlockSize)
+      return false;
+
+    // the units are the blocks of 4096 coefficients of vectors, and the inner vectors of matrices
+    const Index units = MatrixType::IsVectorAtCompileTime ? numext::div_ceil(mat.size(), Index(BlockSize)) : mat.outerSize();
+    // each coefficient is read twice, by maxCoeff() and squaredNorm()
+    const Index chunks = parallel_redux_chunks(units, 4. * double(mat.size()) * double(NumTraits<typename MatrixType::Scalar>::ReadCost));
+    if(chunks<=1)
+      return false;
+
+    ei_declare_aligned_stack_constructed_variable(RealScalar, ssq, chunks, 0);
+    ei_declare_aligned_stack_constructed_variable(RealScalar, scale, chunks, 0);
+    parallel_product_run(chunks, Task(mat, chunks, units, ssq, scale));
+
+    RealScalar totalSsq(0), totalScale(0);
+    for(Index t=0; t<chunks; ++t)
+    {
+      if(scale[t]!=scale[t])  // we got a NaN
+        totalScale = scale[t];
+      else if(scale[t]>totalScale)
+      {
+        totalSsq = totalSsq * numext::abs2(totalScale/scale[t]) + ssq[t];
+        totalScale = scale[t];
+      }
+      else if(scale[t]==totalScale)
+        totalSsq += ssq[t];
+      else if(scale[t]>RealScalar(0))
+        totalSsq += ssq[t] * numext::abs2(scale[t]/totalScale);
+    }
+    res = totalScale * sqrt(totalSsq);
+    return true;
+  }
+};
+
+template<typename MatrixType>
+struct parallel_stable_norm<MatrixType, false>
+{
+  static bool run(const MatrixType&, typename MatrixType::RealScalar&) { return false; }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_PARALLEL_REDUX_H
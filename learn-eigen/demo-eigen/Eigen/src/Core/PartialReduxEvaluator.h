@@ -128,6 +128,235 @@ struct packetwise_redux_impl<Func, Evaluator, NoUnrolling>
   }
 };
 
+/* Partial reductions evaluated at once.
+ *
+ * When the reduction runs across the outer dimension of the argument, e.g., colwise() on a row-major
+ * matrix, the reduced vectors are strided and reducing them one after the other walks the whole argument
+ * once per packet of the result. The result is then rather computed at once by accumulating the inner
+ * vectors of the argument, packet by packet, into the destination, which streams through the argument in
+ * storage order. When parallelReductions() is enabled, a wide result is split over the threads, each of
+ * them accumulating its own coefficients. Otherwise the outer dimension is split, each chunk of consecutive
+ * inner vectors being accumulated into its own partial result, and the partial results being combined in
+ * the order of the chunks.
+ *
+ * When the reduction runs along the inner vectors, the lazy evaluation is already contiguous, and the
+ * result is computed at once only to split its coefficients over the threads.
+ *
+ * This is done by the assignment of a partial reduction to a plain vector, which is written in place, so
+ * that the evaluation does not allocate.
+ */
+template<typename Func, typename Evaluator,
+         bool Vectorized = (bool(int(Evaluator::Flags)&PacketAccessBit) && bool(functor_traits<Func>::PacketAccess)
+                         && int(unpacket_traits<typename packet_traits<typename Evaluator::Scalar>::type>::size)>1)>
+struct partial_redux_accumulate
+{
+  typedef typename Evaluator::Scalar Scalar;
+
+  // accumulates the coefficients [innerStart,innerEnd) of the inner vectors [outerStart,outerEnd) of eval into acc
+  static void run(const Evaluator& eval, const Func& func, Scalar* acc, Index innerStart, Index innerEnd, Index outerStart, Index outerEnd)
+  {
+    for(Index i=innerStart; i<innerEnd; ++i)
+      acc[i] = eval.coeffByOuterInner(outerStart,i);
+    for(Index j=outerStart+1; j<outerEnd; ++j)
+      for(Index i=innerStart; i<innerEnd; ++i)
+        acc[i] = func(acc[i], eval.coeffByOuterInner(j,i));
+  }
+
+  // combines the partial result other into acc
+  static void combine(const Func& func, Scalar* acc, const Scalar* other, Index innerSize)
+  {
+    for(Index i=0; i<innerSize; ++i)
+      acc[i] = func(acc[i], other[i]);
+  }
+};
+
+template<typename Func, typename Evaluator>
+struct partial_redux_accumulate<Func, Evaluator, true>
+{
+  typedef typename Evaluator::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type PacketType;
+  enum { PacketSize = unpacket_traits<PacketType>::size };
+
+  static void run(const Evaluator& eval, const Func& func, Scalar* acc, Index innerStart, Index innerEnd, Index outerStart, Index outerEnd)
+  {
+    const Index packetEnd = innerStart + ((innerEnd-innerStart)/PacketSize)*PacketSize;
+    for(Index i=innerStart; i<packetEnd; i+=PacketSize)
+      pstoreu(acc+i, eval.template packetByOuterInner<Unaligned,PacketType>(outerStart,i));
+    for(Index i=packetEnd; i<innerEnd; ++i)
+      acc[i] = eval.coeffByOuterInner(outerStart,i);
+
+    // as in packetwise_redux_impl, four inner vectors are reduced together before being accumulated
+    Index j = outerStart+1;
+    for(; j+4<=outerEnd; j+=4)
+    {
+      for(Index i=innerStart; i<packetEnd; i+=PacketSize)
+        pstoreu(acc+i, func.packetOp(ploadu<PacketType>(acc+i),
+                         func.packetOp(
+                           func.packetOp(eval.template packetByOuterInner<Unaligned,PacketType>(j+0,i),eval.template packetByOuterInner<Unaligned,PacketType>(j+1,i)),
+                           func.packetOp(eval.template packetByOuterInner<Unaligned,PacketType>(j+2,i),eval.template packetByOuterInner<Unaligned,PacketType>(j+3,i)))));
+      for(Index i=packetEnd; i<innerEnd; ++i)
+        acc[i] = func(acc[i], func(func(eval.coeffByOuterInner(j+0,i), eval.coeffByOuterInner(j+1,i)),
+                                   func(eval.coeffByOuterInner(j+2,i), eval.coeffByOuterInner(j+3,i))));
+    }
+    for(; j<outerEnd; ++j)
+    {
+      for(Index i=innerStart; i<packetEnd; i+=PacketSize)
+        pstoreu(acc+i, func.packetOp(ploadu<PacketType>(acc+i), eval.template packetByOuterInner<Unaligned,PacketType>(j,i)));
+      for(Index i=packetEnd; i<innerEnd; ++i)
+        acc[i] = func(acc[i], eval.coeffByOuterInner(j,i));
+    }
+  }
+
+  static void combine(const Func& func, Scalar* acc, const Scalar* other, Index innerSize)
+  {
+    const Index packetEnd = (innerSize/PacketSize)*PacketSize;
+    for(Index i=0; i<packetEnd; i+=PacketSize)
+      pstoreu(acc+i, func.packetOp(ploadu<PacketType>(acc+i), ploadu<PacketType>(other+i)));
+    for(Index i=packetEnd; i<innerSize; ++i)
+      acc[i] = func(acc[i], other[i]);
+  }
+};
+
+template<typename ArgType, typename MemberOp, int Direction>
+struct partial_redux_at_once
+{
+  typedef typename MemberOp::BinaryOp Func;
+  typedef typename ArgType::Scalar Scalar;
+  typedef redux_evaluator<ArgType> Evaluator;
+  typedef partial_redux_accumulate<Func, Evaluator> Accumulate;
+  enum {
+    // the reduced vectors are strided
+    ReduxIsOuter = (Direction==int(Vertical)) == bool(ArgType::IsRowMajor),
+    PacketSize = int(Evaluator::Flags)&PacketAccessBit ? int(unpacket_traits<typename packet_traits<Scalar>::type>::size) : 1,
+    CoeffCost = int(evaluator<ArgType>::CoeffReadCost) + int(functor_traits<Func>::Cost),
+    // below this number of coefficients the argument is small enough for the lazy evaluation
+    MinSize = 4096,
+    // the smallest share of a wide result accumulated by a thread, as a number of packets
+    MinInnerPackets = 16
+  };
+
+  // accumulates the coefficients [innerSize*t/chunks, innerSize*(t+1)/chunks) of the result, on packet boundaries
+  struct WideTask
+  {
+    WideTask(const Evaluator& eval, const Func& func, Scalar* res, Index innerSize, Index outerSize, Index chunks)
+      : m_eval(eval), m_func(func), m_res(res), m_innerSize(innerSize), m_outerSize(outerSize), m_chunks(chunks)
+    {}
+
+    Index boundary(Index t) const
+    {
+      return t==m_chunks ? m_innerSize : (m_innerSize/PacketSize*t/m_chunks)*PacketSize;
+    }
+
+    void operator()(Index t) const
+    {
+      Accumulate::run(m_eval, m_func, m_res, boundary(t), boundary(t+1), 0, m_outerSize);
+    }
+
+    const Evaluator& m_eval;
+    const Func& m_func;
+    Scalar* m_res;
+    Index m_innerSize, m_outerSize, m_chunks;
+  };
+
+  // accumulates the inner vectors [outerSize*t/chunks, outerSize*(t+1)/chunks) into the result or a partial result
+  struct OuterTask
+  {
+    OuterTask(const Evaluator& eval, const Func& func, Scalar* res, Scalar* partial, Index innerSize, Index outerSize, Index chunks)
+      : m_eval(eval), m_func(func), m_res(res), m_partial(partial), m_innerSize(innerSize), m_outerSize(outerSize), m_chunks(chunks)
+    {}
+
+    void operator()(Index t) const
+    {
+      Scalar* acc = t==0 ? m_res : m_partial + (t-1)*m_innerSize;
+      Accumulate::run(m_eval, m_func, acc, 0, m_innerSize, m_outerSize*t/m_chunks, m_outerSize*(t+1)/m_chunks);
+    }
+
+    const Evaluator& m_eval;
+    const Func& m_func;
+    Scalar* m_res;
+    Scalar* m_partial;
+    Index m_innerSize, m_outerSize, m_chunks;
+  };
+
+  struct InnerTask
+  {
+    InnerTask(const ArgType& arg, const MemberOp& op, Scalar* res, Index outerSize, Index chunks)
+      : m_arg(arg), m_op(op), m_res(res), m_outerSize(outerSize), m_chunks(chunks)
+    {}
+
+    void operator()(Index t) const
+    {
+      for(Index j=m_outerSize*t/m_chunks; j<m_outerSize*(t+1)/m_chunks; ++j)
+        m_res[j] = m_op(m_arg.template subVector<DirectionType(Direction)>(j));
+    }
+
+    const ArgType& m_arg;
+    const MemberOp& m_op;
+    Scalar* m_res;
+    Index m_outerSize, m_chunks;
+  };
+
+  /** \internal Computes all the coefficients of the partial reduction of \a arg by \a op into the contiguous
+    * vector \a res. \returns false, without computing anything, when the lazy evaluation is preferable */
+  static bool run(const ArgType& arg, const MemberOp& op, Scalar* res)
+  {
+    const Index innerSize = arg.innerSize(), outerSize = arg.outerSize();
+    if(arg.size()<MinSize)
+      return false;
+
+    const double cost = double(arg.size()) * double(CoeffCost) / double(PacketSize);
+    if(!ReduxIsOuter)
+    {
+      // the chunks are made of consecutive inner vectors
+      const Index chunks = parallel_redux_chunks(outerSize, cost);
+      if(chunks<=1)
+        return false;
+      parallel_product_run(chunks, InnerTask(arg, op, res, outerSize, chunks));
+      return true;
+    }
+
+    const Func func(op.binaryFunc());
+    Evaluator eval(arg);
+    const Index wideChunks = parallel_redux_chunks(innerSize/(Index(PacketSize)*MinInnerPackets), cost);
+    if(wideChunks>1)
+    {
+      parallel_product_run(wideChunks, WideTask(eval, func, res, innerSize, outerSize, wideChunks));
+      return true;
+    }
+    const Index chunks = parallel_redux_chunks(outerSize, cost);
+    if(chunks<=1)
+    {
+      Accumulate::run(eval, func, res, 0, innerSize, 0, outerSize);
+      return true;
+    }
+    // the result is narrow, and so are the partial results of the chunks after the first one
+    ei_declare_aligned_stack_constructed_variable(Scalar, partial, (chunks-1)*innerSize, 0);
+    parallel_product_run(chunks, OuterTask(eval, func, res, partial, innerSize, outerSize, chunks));
+    for(Index t=1; t<chunks; ++t)
+      Accumulate::combine(func, res, partial+(t-1)*innerSize, innerSize);
+    return true;
+  }
+};
+
+// whether the partial reduction may be computed at once, see partial_redux_at_once
+template<typename ArgType, typename MemberOp, int Direction>
+struct partial_redux_may_run_at_once
+{
+  enum {
+    TraversalSize = Direction==int(Vertical) ? int(ArgType::RowsAtCompileTime) :  int(ArgType::ColsAtCompileTime),
+    value = TraversalSize==Dynamic && bool(MemberOp::Vectorizable)
+         && is_same<typename ArgType::Scalar, typename PartialReduxExpr<ArgType, MemberOp, Direction>::Scalar>::value
+  };
+};
+
+// whether the destination of a partial reduction is a plain vector, possibly transposed, which the argument can
+// only alias when the reduction does not change it
+template<typename Dst>
+struct partial_redux_plain_dest { enum { value = is_same<Dst, typename Dst::PlainObject>::value }; };
+
+template<typename Dst>
+struct partial_redux_plain_dest<Transpose<Dst> > : partial_redux_plain_dest<Dst> {};
+
 template< typename ArgType, typename MemberOp, int Direction>
 struct evaluator<PartialReduxExpr<ArgType, MemberOp, Direction> >
   : evaluator_base<PartialReduxExpr<ArgType, MemberOp, Direction> >
@@ -225,6 +454,31 @@ protected:
   const MemberOp m_functor;
 };
 
+
+#ifndef EIGEN_GPUCC
+// Dense = PartialReduxExpr, computed at once into the destination when it is worth it
+template<typename DstXprType, typename ArgType, typename MemberOp, int Direction, typename Scalar>
+struct Assignment<DstXprType, PartialReduxExpr<ArgType,MemberOp,Direction>, assign_op<Scalar,Scalar>, Dense2Dense,
+  typename enable_if<partial_redux_may_run_at_once<ArgType,MemberOp,Direction>::value
+                  && partial_redux_plain_dest<DstXprType>::value>::type>
+{
+  typedef PartialReduxExpr<ArgType,MemberOp,Direction> SrcXprType;
+  typedef typename nested_eval<ArgType,1>::type ArgTypeNested;
+  typedef typename remove_all<ArgTypeNested>::type ArgTypeNestedCleaned;
+
+  static void run(DstXprType &dst, const SrcXprType &src, const assign_op<Scalar,Scalar> &func)
+  {
+    Index dstRows = src.rows();
+    Index dstCols = src.cols();
+    if((dst.rows()!=dstRows) || (dst.cols()!=dstCols))
+      dst.resize(dstRows, dstCols);
+    ArgTypeNested arg(src.nestedExpression());
+    if(!partial_redux_at_once<ArgTypeNestedCleaned,MemberOp,Direction>::run(arg, src.functor(), dst.data()))
+      call_dense_assignment_loop(dst, PartialReduxExpr<ArgTypeNestedCleaned,MemberOp,Direction>(arg, src.functor()), func);
+  }
+};
+#endif
+
 } // end namespace internal
 
 } // end namespace Eigen
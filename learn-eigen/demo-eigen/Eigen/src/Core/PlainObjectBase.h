@@ -128,10 +128,13 @@ class PlainObjectBase : public internal::dense_xpr_base<Derived>::type
     template<typename StrideType> struct StridedConstAlignedMapType { typedef Eigen::Map<const Derived, AlignedMax, StrideType> type; };
 
   protected:
-    DenseStorage<Scalar, Base::MaxSizeAtCompileTime, Base::RowsAtCompileTime, Base::ColsAtCompileTime, Options> m_storage;
+    typename internal::dense_storage_type<Scalar, Base::MaxSizeAtCompileTime, Base::RowsAtCompileTime, Base::ColsAtCompileTime, Options>::type m_storage;
 
   public:
-    enum { NeedsToAlign = (SizeAtCompileTime != Dynamic) && (internal::traits<Derived>::Alignment>0) };
+    // the inline buffer of the dynamic-size matrices declared with InlineStorage is aligned as the fixed-size storage is
+    enum { NeedsToAlign = (SizeAtCompileTime != Dynamic
+                           || (Base::MaxSizeAtCompileTime == Dynamic && internal::inline_storage_capacity<Options>::value != 0))
+                       && (internal::traits<Derived>::Alignment>0) };
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW_IF(NeedsToAlign)
 
     EIGEN_DEVICE_FUNC
@@ -975,7 +978,8 @@ class PlainObjectBase : public internal::dense_xpr_base<Derived>::type
                         && ((MaxColsAtCompileTime == Dynamic) || (MaxColsAtCompileTime >= 0))
                         && (MaxRowsAtCompileTime == RowsAtCompileTime || RowsAtCompileTime==Dynamic)
                         && (MaxColsAtCompileTime == ColsAtCompileTime || ColsAtCompileTime==Dynamic)
-                        && (Options & (DontAlign|RowMajor)) == Options),
+                        && (Options & (DontAlign|RowMajor)) == (Options & 0xff)
+                        && internal::inline_storage_capacity<Options>::value >= 0),
         INVALID_MATRIX_TEMPLATE_PARAMETERS)
     }
 
@@ -0,0 +1,127 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_PRODUCTEPILOGUE_H
+#define EIGEN_PRODUCTEPILOGUE_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal Presents the blocks handed by the matrix product kernel to an epilogue functor as blocks of the
+  * destination \a data, with their offsets in it. */
+template<typename Functor, typename Scalar, int StorageOrder>
+class gemm_epilogue_adapter : public gemm_epilogue<Scalar,Index>
+{
+  public:
+    gemm_epilogue_adapter(const Functor& functor, const Scalar* data, Index outerStride)
+      : m_functor(functor), m_data(data), m_outerStride(outerStride) {}
+
+    virtual void operator()(Scalar* block, Index rows, Index cols, Index stride) const
+    {
+      EIGEN_INSTRUMENT_KERNEL(InstrumentGemmEpilogue, 0);
+      const Index offset = Index(block - m_data);
+      const Index outer = offset / m_outerStride;
+      const Index inner = offset % m_outerStride;
+      // the kernel computes the transposed product for a row-major destination
+      if(StorageOrder==RowMajor)
+      {
+        Map<Matrix<Scalar,Dynamic,Dynamic,RowMajor>, 0, OuterStride<> > dstBlock(block, cols, rows, OuterStride<>(stride));
+        m_functor(dstBlock, outer, inner);
+      }
+      else
+      {
+        Map<Matrix<Scalar,Dynamic,Dynamic,ColMajor>, 0, OuterStride<> > dstBlock(block, rows, cols, OuterStride<>(stride));
+        m_functor(dstBlock, inner, outer);
+      }
+    }
+
+  private:
+    const Functor& m_functor;
+    const Scalar* m_data;
+    Index m_outerStride;
+};
+
+template<typename Lhs, typename Rhs, typename Dest, typename Epilogue>
+void product_with_epilogue(const Lhs& lhs, const Rhs& rhs, Dest& dst, const Epilogue& epilogue, true_type /*direct access to dst*/)
+{
+  typedef typename Dest::Scalar Scalar;
+  typedef gemm_epilogue_adapter<Epilogue,Scalar,(int(Dest::Flags)&RowMajorBit) ? RowMajor : ColMajor> Adapter;
+  const Adapter adapter(epilogue, dst.data(), (std::max)(dst.outerStride(), Index(1)));
+
+  // small products are evaluated coefficient-wise, and the whole result is then a single block
+  if((rhs.rows()+dst.rows()+dst.cols())<EIGEN_GEMM_TO_COEFFBASED_THRESHOLD && rhs.rows()>0)
+  {
+    dst.noalias() = lhs.lazyProduct(rhs);
+    if(dst.size()>0)
+      generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct>::applyEpilogue(dst, &adapter);
+  }
+  else
+  {
+    dst.setZero();
+    generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct>::scaleAndAddTo(dst, lhs, rhs, Scalar(1), &adapter);
+  }
+}
+
+template<typename Lhs, typename Rhs, typename Dest, typename Epilogue>
+void product_with_epilogue(const Lhs& lhs, const Rhs& rhs, Dest& dst, const Epilogue& epilogue, false_type)
+{
+  typename Dest::PlainObject tmp(lhs.rows(), rhs.cols());
+  product_with_epilogue(lhs, rhs, tmp, epilogue, true_type());
+  dst = tmp;
+}
+
+} // end namespace internal
+
+/** \ingroup Core_Module
+  *
+  * Computes \a dst \c = \a epilogue(\a lhs \c * \a rhs), where the epilogue is applied to each block of the result
+  * as soon as the matrix product kernel has written its final value, while the block is still in cache. This fuses
+  * the bias additions, activations and scalings following a product, which would otherwise read and write the
+  * whole result again. \a dst is resized as needed, and must not alias \a lhs or \a rhs.
+  *
+  * The epilogue is a functor with a call operator of the form:
+  * \code
+  * template<typename Block> void operator()(Block& block, Index row, Index col) const;
+  * \endcode
+  * where \c block is a writable dense expression of a block of \a dst, and \a row and \a col are the offsets of
+  * this block in \a dst. Every coefficient of \a dst belongs to exactly one block. The blocks may be processed
+  * concurrently by the threads of the product, so the call operator must not modify shared state.
+  *
+  * For instance, a fully connected layer with a rectified linear activation:
+  * \code
+  * struct BiasRelu {
+  *   const VectorXf* bias;
+  *   template<typename Block> void operator()(Block& block, Index row, Index) const {
+  *     block = (block.colwise() + bias->segment(row, block.rows())).cwiseMax(0.f);
+  *   }
+  * };
+  * BiasRelu epilogue = { &b };
+  * productWithEpilogue(W, X, Y, epilogue);
+  * \endcode
+  *
+  * \sa MatrixBase::operator*()
+  */
+template<typename Lhs, typename Rhs, typename Dest, typename Epilogue>
+void productWithEpilogue(const MatrixBase<Lhs>& lhs, const MatrixBase<Rhs>& rhs, MatrixBase<Dest>& dst, const Epilogue& epilogue)
+{
+  EIGEN_STATIC_ASSERT((internal::is_same<typename Lhs::Scalar,typename Rhs::Scalar>::value
+                    && internal::is_same<typename Lhs::Scalar,typename Dest::Scalar>::value),
+                      YOU_MIXED_DIFFERENT_NUMERIC_TYPES__YOU_NEED_TO_USE_THE_CAST_METHOD_OF_MATRIXBASE_TO_CAST_NUMERIC_TYPES_EXPLICITLY)
+  enum {
+    // the blocks of the kernel are contiguous along the inner dimension of the destination
+    DirectEval = (int(Dest::Flags)&DirectAccessBit) && int(Dest::InnerStrideAtCompileTime)==1
+  };
+  eigen_assert(lhs.cols()==rhs.rows() && "invalid matrix product");
+  dst.derived().resize(lhs.rows(), rhs.cols());
+  internal::product_with_epilogue(lhs.derived(), rhs.derived(), dst.derived(), epilogue,
+                                  typename internal::conditional<DirectEval,internal::true_type,internal::false_type>::type());
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_PRODUCTEPILOGUE_H
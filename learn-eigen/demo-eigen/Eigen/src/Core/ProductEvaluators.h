@@ -382,6 +382,7 @@ struct generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemvProduct>
     }
     LhsNested actual_lhs(lhs);
     RhsNested actual_rhs(rhs);
+    EIGEN_INSTRUMENT_KERNEL(InstrumentGemv, 2.0*double(lhs.rows())*double(lhs.cols())*double(rhs.cols()));
     internal::gemv_dense_selector<Side,
                             (int(MatrixType::Flags)&RowMajorBit) ? RowMajor : ColMajor,
                             bool(internal::blas_traits<MatrixType>::HasUsableDirectAccess)
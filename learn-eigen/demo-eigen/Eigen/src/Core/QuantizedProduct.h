@@ -0,0 +1,149 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_QUANTIZEDPRODUCT_H
+#define EIGEN_QUANTIZEDPRODUCT_H
+
+namespace Eigen {
+
+namespace internal {
+
+template<typename Lhs, typename Rhs, typename Dest>
+void quantized_product_to(const Lhs& lhs, const Rhs& rhs, Dest& dst, true_type /*direct access to dst*/)
+{
+  enum {
+    LhsStorageOrder = (int(Lhs::Flags)&RowMajorBit) ? RowMajor : ColMajor,
+    RhsStorageOrder = (int(Rhs::Flags)&RowMajorBit) ? RowMajor : ColMajor
+  };
+  typedef Ref<const Matrix<numext::int8_t,Dynamic,Dynamic,LhsStorageOrder>, 0, OuterStride<> > LhsRef;
+  typedef Ref<const Matrix<numext::uint8_t,Dynamic,Dynamic,RhsStorageOrder>, 0, OuterStride<> > RhsRef;
+
+  dst.setZero();
+  if(dst.rows()==0 || dst.cols()==0 || lhs.cols()==0)
+    return;
+  LhsRef actualLhs(lhs);
+  RhsRef actualRhs(rhs);
+  quantized_matrix_matrix_product<Index,LhsStorageOrder,RhsStorageOrder>::run(
+    lhs.rows(), rhs.cols(), lhs.cols(),
+    actualLhs.data(), actualLhs.outerStride(),
+    actualRhs.data(), actualRhs.outerStride(),
+    dst.data(), (int(Dest::Flags)&RowMajorBit) ? 1 : dst.outerStride());
+}
+
+template<typename Lhs, typename Rhs, typename Dest>
+void quantized_product_to(const Lhs& lhs, const Rhs& rhs, Dest& dst, false_type)
+{
+  Matrix<numext::int32_t,Dynamic,Dynamic,ColMajor> tmp(lhs.rows(), rhs.cols());
+  quantized_product_to(lhs, rhs, tmp, true_type());
+  dst = tmp;
+}
+
+template<typename Lhs, typename Rhs, typename Dest>
+void quantized_product_to(const Lhs& lhs, const Rhs& rhs, Dest& dst)
+{
+  enum {
+    // the kernels write to a column-major destination with unit inner stride
+    DirectEval = (int(Dest::Flags)&DirectAccessBit) && int(Dest::InnerStrideAtCompileTime)==1
+              && (!(int(Dest::Flags)&RowMajorBit) || int(Dest::RowsAtCompileTime)==1)
+  };
+  quantized_product_to(lhs, rhs, dst, typename conditional<DirectEval,true_type,false_type>::type());
+}
+
+} // end namespace internal
+
+/** \ingroup Core_Module
+  *
+  * Computes the product \a dst \c = \a lhs \c * \a rhs of an \c int8_t matrix by an \c uint8_t matrix,
+  * accumulated and stored in \c int32_t. \a dst is resized as needed.
+  *
+  * The products of 4 consecutive coefficients along the inner dimension are accumulated at once by the
+  * \c vpdpbusd instruction when Eigen is compiled with AVX512-VNNI support, and by widening to 16 bits
+  * otherwise (AVX2 and SSE4.1), so that the result is always exact.
+  *
+  * \sa quantizedProduct(const MatrixBase<Lhs>&, const MatrixBase<Rhs>&, const MatrixBase<LhsZeroPoints>&, const MatrixBase<RhsZeroPoints>&, MatrixBase<Dest>&),
+  *     requantize()
+  */
+template<typename Lhs, typename Rhs, typename Dest>
+void quantizedProduct(const MatrixBase<Lhs>& lhs, const MatrixBase<Rhs>& rhs, MatrixBase<Dest>& dst)
+{
+  EIGEN_STATIC_ASSERT((internal::is_same<typename Lhs::Scalar,numext::int8_t>::value
+                    && internal::is_same<typename Rhs::Scalar,numext::uint8_t>::value
+                    && internal::is_same<typename Dest::Scalar,numext::int32_t>::value),
+                      YOU_MIXED_DIFFERENT_NUMERIC_TYPES__YOU_NEED_TO_USE_THE_CAST_METHOD_OF_MATRIXBASE_TO_CAST_NUMERIC_TYPES_EXPLICITLY)
+  eigen_assert(lhs.cols()==rhs.rows() && "invalid matrix product");
+  dst.derived().resize(lhs.rows(), rhs.cols());
+  internal::quantized_product_to(lhs.derived(), rhs.derived(), dst.derived());
+}
+
+/** \ingroup Core_Module
+  *
+  * Computes the product of two affine-quantized matrices:
+  * \f$ dst_{ij} = \sum_k (lhs_{ik} - lhsZeroPoints_i)(rhs_{kj} - rhsZeroPoints_j) \f$,
+  * where \a lhsZeroPoints holds one zero point per row of \a lhs, and \a rhsZeroPoints one zero point per
+  * column of \a rhs. Per-tensor zero points are passed as constant vectors, e.g., \c VectorXi::Constant(rows,z).
+  *
+  * The zero points are not subtracted from the operands: the product is computed on the raw 8-bit values
+  * and corrected by rank-one updates involving the row sums of \a lhs and the column sums of \a rhs.
+  */
+template<typename Lhs, typename Rhs, typename LhsZeroPoints, typename RhsZeroPoints, typename Dest>
+void quantizedProduct(const MatrixBase<Lhs>& lhs, const MatrixBase<Rhs>& rhs,
+                      const MatrixBase<LhsZeroPoints>& lhsZeroPoints, const MatrixBase<RhsZeroPoints>& rhsZeroPoints,
+                      MatrixBase<Dest>& dst)
+{
+  typedef numext::int32_t Int;
+  typedef Matrix<Int,Dynamic,1> IntVector;
+  typedef Matrix<Int,1,Dynamic> IntRowVector;
+  EIGEN_STATIC_ASSERT_VECTOR_ONLY(LhsZeroPoints)
+  EIGEN_STATIC_ASSERT_VECTOR_ONLY(RhsZeroPoints)
+  eigen_assert(lhsZeroPoints.size()==lhs.rows() && rhsZeroPoints.size()==rhs.cols());
+
+  quantizedProduct(lhs, rhs, dst);
+
+  const IntVector lhsZero = lhsZeroPoints.template cast<Int>();
+  const IntRowVector rhsZero = rhsZeroPoints.template cast<Int>();
+  const IntVector lhsSums = lhs.template cast<Int>().rowwise().sum();
+  const IntRowVector rhsSums = rhs.template cast<Int>().colwise().sum();
+  // sum_k (a_ik - za_i)(b_kj - zb_j) = sum_k a_ik b_kj - (sum_k a_ik - depth za_i) zb_j - za_i sum_k b_kj
+  dst.derived() -= (lhsSums - Int(lhs.cols()) * lhsZero) * rhsZero + lhsZero * rhsSums;
+}
+
+/** \ingroup Core_Module
+  *
+  * Scales the \c int32_t accumulators \a acc of a quantized product back to 8 bits:
+  * \f$ dst_{ij} = \mathrm{saturate}(\mathrm{rint}(acc_{ij} \, rowScales_i \, colScales_j) + zeroPoint) \f$,
+  * the rounding being done to nearest even, and the saturation to the range of the scalar type of \a dst,
+  * e.g., \c int8_t or \c uint8_t. \a dst is resized as needed.
+  *
+  * \a rowScales holds one scale per row of \a acc, e.g., the per-channel scales of a weight matrix, and
+  * \a colScales one scale per column. Either can be a constant vector for a per-tensor scale.
+  *
+  * \sa quantizedProduct()
+  */
+template<typename Acc, typename RowScales, typename ColScales, typename Dest>
+void requantize(const MatrixBase<Acc>& acc, const MatrixBase<RowScales>& rowScales, const MatrixBase<ColScales>& colScales,
+                numext::int32_t zeroPoint, MatrixBase<Dest>& dst)
+{
+  typedef typename RowScales::Scalar RealScalar;
+  typedef typename Dest::Scalar DstScalar;
+  typedef Array<RealScalar,Dynamic,1> ScaleVector;
+  typedef Array<RealScalar,1,Dynamic> ScaleRowVector;
+  EIGEN_STATIC_ASSERT_VECTOR_ONLY(RowScales)
+  EIGEN_STATIC_ASSERT_VECTOR_ONLY(ColScales)
+  eigen_assert(rowScales.size()==acc.rows() && colScales.size()==acc.cols());
+
+  const ScaleVector rs = rowScales;
+  const ScaleRowVector cs = colScales.template cast<RealScalar>();
+  const RealScalar lowest = RealScalar(NumTraits<DstScalar>::lowest());
+  const RealScalar highest = RealScalar(NumTraits<DstScalar>::highest());
+  dst.derived().resize(acc.rows(), acc.cols());
+  dst.derived() = (((acc.template cast<RealScalar>().array().colwise() * rs).rowwise() * cs).rint() + RealScalar(zeroPoint))
+                  .cwiseMax(lowest).cwiseMin(highest).template cast<DstScalar>().matrix();
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_QUANTIZEDPRODUCT_H
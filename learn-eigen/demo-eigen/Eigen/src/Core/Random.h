@@ -10,21 +10,270 @@
 #ifndef EIGEN_RANDOM_H
 #define EIGEN_RANDOM_H
 
+#if EIGEN_HAS_CXX11_ATOMIC
+#include <atomic>
+#endif
+
 namespace Eigen { 
 
 namespace internal {
 
-template<typename Scalar> struct scalar_random_op {
-  EIGEN_EMPTY_STRUCT_CTOR(scalar_random_op)
-  inline const Scalar operator() () const { return random<Scalar>(); }
+/** \internal Sets the seed of the random matrices and restarts their streams (SetAction), or gets the seed
+  * and reserves the next stream (GetAction). Until a seed is set, each random matrix gets a seed drawn from
+  * std::rand(), so that std::srand() keeps controlling them. */
+inline void manage_random_streams(Action action, numext::uint64_t* seed, numext::uint64_t* stream)
+{
+#if EIGEN_HAS_CXX11_ATOMIC
+  static std::atomic<numext::uint64_t> m_seed(0), m_stream(0);
+  static std::atomic<bool> m_seeded(false);
+#else
+  static numext::uint64_t m_seed = 0, m_stream = 0;
+  static bool m_seeded = false;
+#endif
+
+  if(action==SetAction)
+  {
+    eigen_internal_assert(seed!=0);
+    m_seed = *seed;
+    m_stream = 0;
+    m_seeded = true;
+  }
+  else if(action==GetAction)
+  {
+    eigen_internal_assert(seed!=0 && stream!=0);
+    if(!m_seeded)
+    {
+      // RAND_MAX may be as small as 2^15-1: accumulate enough calls to fill the 64 bits of the seed
+      numext::uint64_t s = 0;
+      for(int k=0; k<5; ++k)
+        s = (s << 15) ^ numext::uint64_t(std::rand());
+      *seed = s;
+      *stream = 0;
+      return;
+    }
+    *seed = m_seed;
+#if EIGEN_HAS_CXX11_ATOMIC
+    *stream = m_stream.fetch_add(1);
+#else
+    *stream = m_stream++;
+#endif
+  }
+  else
+  {
+    eigen_internal_assert(false);
+  }
+}
+
+/** \internal Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as
+  * 1, 2, 3", SC'11): maps the 128-bit counters c[.][b] and the 64-bit key (k0,k1) to 128 random bits, in
+  * place. The N blocks are processed together so that the rounds can be vectorized. */
+template<int N>
+EIGEN_STRONG_INLINE void philox4x32(numext::uint32_t (&c)[4][N], numext::uint32_t k0, numext::uint32_t k1)
+{
+  for(int round=0; round<10; ++round)
+  {
+    for(int b=0; b<N; ++b)
+    {
+      const numext::uint64_t p0 = numext::uint64_t(0xD2511F53u) * c[0][b];
+      const numext::uint64_t p1 = numext::uint64_t(0xCD9E8D57u) * c[2][b];
+      const numext::uint32_t c1 = c[1][b], c3 = c[3][b];
+      c[0][b] = numext::uint32_t(p1 >> 32) ^ c1 ^ k0;
+      c[1][b] = numext::uint32_t(p1);
+      c[2][b] = numext::uint32_t(p0 >> 32) ^ c3 ^ k1;
+      c[3][b] = numext::uint32_t(p0);
+    }
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+}
+
+/** \internal Conversion of Words random 32-bit words to a Scalar, with the ranges of internal::random<Scalar>():
+  * [-1:1) for floating point types (53 random bits), through double for the other ones than float */
+template<typename Scalar, bool IsComplex = NumTraits<Scalar>::IsComplex, bool IsInteger = NumTraits<Scalar>::IsInteger>
+struct random_from_bits
+{
+  enum { Words = 2 };
+  static EIGEN_STRONG_INLINE Scalar run(const numext::uint32_t* w)
+  {
+    const double u = double((numext::uint64_t(w[0]) << 21) ^ (w[1] >> 11)) * (1. / 9007199254740992.);
+    return Scalar(NumTraits<Scalar>::IsSigned ? 2.*u - 1. : u);
+  }
+};
+
+template<>
+struct random_from_bits<float, false, false>
+{
+  enum { Words = 1 };
+  static EIGEN_STRONG_INLINE float run(const numext::uint32_t* w)
+  {
+    return float(w[0] >> 8) * (2.f / 16777216.f) - 1.f;
+  }
+};
+
+// same number of random bits and offset as the std::rand() based random<Scalar>()
+template<typename Scalar>
+struct random_from_bits<Scalar, false, true>
+{
+  enum { Words = 1,
+         rand_bits = meta_floor_log2<(unsigned int)(RAND_MAX)+1>::value,
+         scalar_bits = sizeof(Scalar) * CHAR_BIT,
+         bits = EIGEN_PLAIN_ENUM_MIN(rand_bits, scalar_bits),
+         offset = NumTraits<Scalar>::IsSigned ? (1 << (bits-1)) : 0
+  };
+  static EIGEN_STRONG_INLINE Scalar run(const numext::uint32_t* w)
+  {
+    return Scalar(int(w[0] >> (32 - bits)) - offset);
+  }
+};
+
+template<>
+struct random_from_bits<bool, false, true>
+{
+  enum { Words = 1 };
+  static EIGEN_STRONG_INLINE bool run(const numext::uint32_t* w) { return (w[0] >> 31) != 0; }
+};
+
+template<typename Scalar>
+struct random_from_bits<Scalar, true, false>
+{
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+  typedef random_from_bits<RealScalar> RealBits;
+  enum { Words = 2 * RealBits::Words };
+  static EIGEN_STRONG_INLINE Scalar run(const numext::uint32_t* w)
+  {
+    return Scalar(RealBits::run(w), RealBits::run(w + RealBits::Words));
+  }
+};
+
+// whether the coefficients of DenseBase::Random() come from the counter-based generator: the other scalar types,
+// e.g., multi-precision ones, keep the generator of their internal::random()
+template<typename Scalar> struct random_is_counter_based { enum { value = is_arithmetic<Scalar>::value }; };
+template<typename RealScalar> struct random_is_counter_based<std::complex<RealScalar> > : random_is_counter_based<RealScalar> {};
+
+/** \internal
+  * \brief Functor generating the coefficients of DenseBase::Random()
+  *
+  * The coefficient of index k in the storage order is made of the words k*Words to (k+1)*Words-1 of the
+  * Philox4x32-10 stream of the functor, whose block b is generated from the counter (b, stream) and the seed.
+  * The coefficients only depend on the seed, the stream and their coordinates, so that they can be generated
+  * in any order, by any number of threads.
+  */
+template<typename Scalar, bool CounterBased = random_is_counter_based<Scalar>::value> struct random_generator {
+  typedef random_from_bits<Scalar> Bits;
+  enum { Words = Bits::Words };
+
+  random_generator(Index rows, Index cols, bool rowMajor)
+    : m_rowStride(rowMajor ? cols : 1), m_colStride(rowMajor ? 1 : rows)
+  {
+    EIGEN_STATIC_ASSERT(4%int(Words)==0, EIGEN_INTERNAL_ERROR_PLEASE_FILE_A_BUG_REPORT)
+    manage_random_streams(GetAction, &m_seed, &m_stream);
+  }
+
+  // counters of the blocks [block, block+N)
+  template<int N>
+  EIGEN_STRONG_INLINE void blocks(numext::uint32_t (&c)[4][N], numext::uint64_t block) const
+  {
+    for(int b=0; b<N; ++b)
+    {
+      c[0][b] = numext::uint32_t(block + b);
+      c[1][b] = numext::uint32_t((block + b) >> 32);
+      c[2][b] = numext::uint32_t(m_stream);
+      c[3][b] = numext::uint32_t(m_stream >> 32);
+    }
+    philox4x32(c, numext::uint32_t(m_seed), numext::uint32_t(m_seed >> 32));
+  }
+
+  inline const Scalar operator() (Index index) const
+  {
+    const numext::uint64_t word = numext::uint64_t(index) * Words;
+    numext::uint32_t c[4][1];
+    blocks(c, word / 4);
+    const numext::uint32_t w[4] = { c[0][0], c[1][0], c[2][0], c[3][0] };
+    return Bits::run(w + word % 4);
+  }
+
+  inline const Scalar operator() (Index i, Index j) const
+  {
+    return (*this)(i * m_rowStride + j * m_colStride);
+  }
+
+  // the coefficients [index, index+PacketSize) from the N blocks starting at the one of their first word
+  template<typename Packet, int N>
+  EIGEN_STRONG_INLINE const Packet packet_from_blocks(numext::uint64_t word) const
+  {
+    enum { PacketSize = unpacket_traits<Packet>::size };
+    numext::uint32_t c[4][N];
+    blocks(c, word / 4);
+    numext::uint32_t w[4*N];
+    for(int b=0; b<N; ++b)
+      for(int k=0; k<4; ++k)
+        w[4*b+k] = c[k][b];
+    Scalar values[PacketSize];
+    for(int k=0; k<PacketSize; ++k)
+      values[k] = Bits::run(w + word % 4 + k*Words);
+    return ploadu<Packet>(values);
+  }
+
+  template<typename Packet>
+  EIGEN_STRONG_INLINE const Packet packetOp(Index index) const
+  {
+    enum { Blocks = (unpacket_traits<Packet>::size * Words + 3) / 4 };
+    const numext::uint64_t word = numext::uint64_t(index) * Words;
+    // the words of the packets starting at a block boundary, as the aligned ones, span exactly Blocks blocks
+    if((unpacket_traits<Packet>::size * Words) % 4 == 0 && word % 4 == 0)
+      return packet_from_blocks<Packet, Blocks>(word);
+    return packet_from_blocks<Packet, Blocks+1>(word);
+  }
+
+  // the packets run along the inner dimension, i.e., they are made of consecutive coefficients
+  template<typename Packet>
+  EIGEN_STRONG_INLINE const Packet packetOp(Index i, Index j) const
+  {
+    return packetOp<Packet>(i * m_rowStride + j * m_colStride);
+  }
+
+  numext::uint64_t m_seed, m_stream;
+  Index m_rowStride, m_colStride;
+};
+
+// the coefficients are drawn one after the other by internal::random()
+template<typename Scalar> struct random_generator<Scalar, false> {
+  random_generator(Index, Index, bool) {}
+  inline const Scalar operator() (Index) const { return random<Scalar>(); }
+  inline const Scalar operator() (Index, Index) const { return random<Scalar>(); }
+};
+
+template<typename Scalar> struct scalar_random_op : random_generator<Scalar> {
+  scalar_random_op(Index rows, Index cols, bool rowMajor) : random_generator<Scalar>(rows, cols, rowMajor) {}
 };
 
 template<typename Scalar>
 struct functor_traits<scalar_random_op<Scalar> >
-{ enum { Cost = 5 * NumTraits<Scalar>::MulCost, PacketAccess = false, IsRepeatable = false }; };
+{ enum { Cost = 5 * NumTraits<Scalar>::MulCost,
+         PacketAccess = packet_traits<Scalar>::Vectorizable && random_is_counter_based<Scalar>::value,
+         IsRepeatable = false }; };
+
+// the linear index of the coefficients is the one of the storage order
+template<typename Scalar>
+struct functor_has_linear_access<scalar_random_op<Scalar> > { enum { ret = 1 }; };
 
 } // end namespace internal
 
+/** Sets the seed of the random matrices and vectors generated by DenseBase::Random() and DenseBase::setRandom(),
+  * and restarts their sequence: each random expression gets the next stream of the seed, so that a program creating
+  * its random expressions in the same order generates the same coefficients, whatever the number of threads.
+  *
+  * Until this function is called, each random expression draws its seed from std::rand(), so that std::srand()
+  * still controls the random matrices. Once it is called, they no longer depend on std::rand() and std::srand(),
+  * except for the scalar types generated by internal::random<Scalar>(), see DenseBase::Random(Index,Index).
+  *
+  * \sa DenseBase::Random(Index,Index)
+  */
+inline void setRandomSeed(numext::uint64_t seed)
+{
+  internal::manage_random_streams(SetAction, &seed, 0);
+}
+
 /** \returns a random matrix expression
   *
   * Numbers are uniformly spread through their whole definition range for integer types,
@@ -33,8 +282,6 @@ struct functor_traits<scalar_random_op<Scalar> >
   * The parameters \a rows and \a cols are the number of rows and of columns of
   * the returned matrix. Must be compatible with this MatrixBase type.
   *
-  * \not_reentrant
-  * 
   * This variant is meant to be used for dynamic-size matrix types. For fixed-size types,
   * it is redundant to pass \a rows and \a cols as arguments, so Random() should be used
   * instead.
@@ -46,6 +293,20 @@ struct functor_traits<scalar_random_op<Scalar> >
   * This expression has the "evaluate before nesting" flag so that it will be evaluated into
   * a temporary matrix whenever it is nested in a larger expression. This prevents unexpected
   * behavior with expressions involving random matrices.
+  *
+  * For the builtin arithmetic types, their complex counterparts, half and bfloat16, the coefficients are
+  * generated by the counter-based Philox4x32-10 generator from the seed set by setRandomSeed(), or one drawn
+  * from std::rand() if it was never called, and a stream reserved by each call to Random(). A coefficient only
+  * depends on the seed, the stream and its position, so that the expression can be evaluated by several
+  * threads, e.g., through DenseBase::device(), or block by block, and still give the same matrix:
+  * \code
+  * const MatrixXf::RandomReturnType R = MatrixXf::Random(n, n);
+  * #pragma omp parallel for
+  * for(int j = 0; j < n; ++j)
+  *   A.col(j) = R.col(j);   // same as A = R, whatever the number of threads
+  * \endcode
+  * The coefficients of the other scalar types are drawn one after the other by internal::random<Scalar>(), which
+  * such types may specialize.
   * 
   * See DenseBase::NullaryExpr(Index, const CustomNullaryOp&) for an example using C++11 random generators.
   *
@@ -55,7 +316,7 @@ template<typename Derived>
 inline const typename DenseBase<Derived>::RandomReturnType
 DenseBase<Derived>::Random(Index rows, Index cols)
 {
-  return NullaryExpr(rows, cols, internal::scalar_random_op<Scalar>());
+  return NullaryExpr(rows, cols, internal::scalar_random_op<Scalar>(rows, cols, IsRowMajor));
 }
 
 /** \returns a random vector expression
@@ -67,8 +328,6 @@ DenseBase<Derived>::Random(Index rows, Index cols)
   * Must be compatible with this MatrixBase type.
   *
   * \only_for_vectors
-  * \not_reentrant
-  *
   * This variant is meant to be used for dynamic-size vector types. For fixed-size types,
   * it is redundant to pass \a size as argument, so Random() should be used
   * instead.
@@ -86,7 +345,7 @@ template<typename Derived>
 inline const typename DenseBase<Derived>::RandomReturnType
 DenseBase<Derived>::Random(Index size)
 {
-  return NullaryExpr(size, internal::scalar_random_op<Scalar>());
+  return NullaryExpr(size, internal::scalar_random_op<Scalar>(RowsAtCompileTime==1 ? 1 : size, ColsAtCompileTime==1 ? 1 : size, IsRowMajor));
 }
 
 /** \returns a fixed-size random matrix or vector expression
@@ -104,15 +363,13 @@ DenseBase<Derived>::Random(Index size)
   * a temporary matrix whenever it is nested in a larger expression. This prevents unexpected
   * behavior with expressions involving random matrices.
   * 
-  * \not_reentrant
-  *
   * \sa DenseBase::setRandom(), DenseBase::Random(Index,Index), DenseBase::Random(Index)
   */
 template<typename Derived>
 inline const typename DenseBase<Derived>::RandomReturnType
 DenseBase<Derived>::Random()
 {
-  return NullaryExpr(RowsAtCompileTime, ColsAtCompileTime, internal::scalar_random_op<Scalar>());
+  return NullaryExpr(RowsAtCompileTime, ColsAtCompileTime, internal::scalar_random_op<Scalar>(RowsAtCompileTime, ColsAtCompileTime, IsRowMajor));
 }
 
 /** Sets all coefficients in this expression to random values.
@@ -120,8 +377,6 @@ DenseBase<Derived>::Random()
   * Numbers are uniformly spread through their whole definition range for integer types,
   * and in the [-1:1] range for floating point scalar types.
   * 
-  * \not_reentrant
-  * 
   * Example: \include MatrixBase_setRandom.cpp
   * Output: \verbinclude MatrixBase_setRandom.out
   *
@@ -139,8 +394,6 @@ EIGEN_DEVICE_FUNC inline Derived& DenseBase<Derived>::setRandom()
   * and in the [-1:1] range for floating point scalar types.
   * 
   * \only_for_vectors
-  * \not_reentrant
-  *
   * Example: \include Matrix_setRandom_int.cpp
   * Output: \verbinclude Matrix_setRandom_int.out
   *
@@ -159,8 +412,6 @@ PlainObjectBase<Derived>::setRandom(Index newSize)
   * Numbers are uniformly spread through their whole definition range for integer types,
   * and in the [-1:1] range for floating point scalar types.
   *
-  * \not_reentrant
-  * 
   * \param rows the new number of rows
   * \param cols the new number of columns
   *
@@ -184,8 +435,6 @@ PlainObjectBase<Derived>::setRandom(Index rows, Index cols)
   * Numbers are uniformly spread through their whole definition range for integer types,
   * and in the [-1:1] range for floating point scalar types.
   *
-  * \not_reentrant
-  *
   * \sa DenseBase::setRandom(), setRandom(Index), setRandom(Index, NoChange_t), class CwiseNullaryOp, DenseBase::Random()
   */
 template<typename Derived>
@@ -202,8 +451,6 @@ PlainObjectBase<Derived>::setRandom(NoChange_t, Index cols)
   * Numbers are uniformly spread through their whole definition range for integer types,
   * and in the [-1:1] range for floating point scalar types.
   *
-  * \not_reentrant
-  *
   * \sa DenseBase::setRandom(), setRandom(Index), setRandom(NoChange_t, Index), class CwiseNullaryOp, DenseBase::Random()
   */
 template<typename Derived>
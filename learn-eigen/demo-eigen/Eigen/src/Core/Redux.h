@@ -352,6 +352,9 @@ struct redux_impl<Func, Evaluator, LinearVectorizedTraversal, CompleteUnrolling>
   }
 };
 
+// full reduction split over threads, see ParallelRedux.h
+template<typename Func, typename Derived, bool IsDynamic = int(Derived::SizeAtCompileTime)==Dynamic> struct parallel_redux;
+
 // evaluator adaptor
 template<typename _XprType>
 class redux_evaluator : public internal::evaluator<_XprType>
@@ -410,6 +413,12 @@ DenseBase<Derived>::redux(const Func& func) const
 {
   eigen_assert(this->rows()>0 && this->cols()>0 && "you are using an empty matrix");
 
+#ifndef EIGEN_GPU_COMPILE_PHASE
+  Scalar res = Scalar();
+  if(internal::parallel_redux<Func,Derived>::run(derived(), func, res))
+    return res;
+#endif
+
   typedef typename internal::redux_evaluator<Derived> ThisEvaluator;
   ThisEvaluator thisEval(derived());
 
@@ -460,6 +469,13 @@ DenseBase<Derived>::sum() const
 {
   if(SizeAtCompileTime==0 || (SizeAtCompileTime==Dynamic && size()==0))
     return Scalar(0);
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+  // the reductions split over threads take precedence over the single-threaded dispatched kernels
+  Scalar res(0);
+  if(internal::parallel_redux<internal::scalar_sum_op<Scalar,Scalar>,Derived>::run(derived(), internal::scalar_sum_op<Scalar,Scalar>(), res)
+     || internal::dispatched_sum<Derived>::run(derived(), res))
+    return res;
+#endif
   return derived().redux(Eigen::internal::scalar_sum_op<Scalar,Scalar>());
 }
 
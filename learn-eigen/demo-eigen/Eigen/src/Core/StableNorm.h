@@ -77,6 +77,9 @@ void stable_norm_impl_inner_step(const VectorType &vec, RealScalar& ssq, RealSca
     internal::stable_norm_kernel(SegmentWrapper(copy.segment(bi,numext::mini(blockSize, n - bi))), ssq, scale, invScale);
 }
 
+// stableNorm() split over threads, see ParallelRedux.h
+template<typename MatrixType, bool IsDynamic = int(MatrixType::SizeAtCompileTime)==Dynamic> struct parallel_stable_norm;
+
 template<typename VectorType>
 typename VectorType::RealScalar
 stable_norm_impl(const VectorType &vec, typename enable_if<VectorType::IsVectorAtCompileTime>::type* = 0 )
@@ -212,6 +215,9 @@ template<typename Derived>
 inline typename NumTraits<typename internal::traits<Derived>::Scalar>::Real
 MatrixBase<Derived>::stableNorm() const
 {
+  RealScalar res(0);
+  if(internal::parallel_stable_norm<Derived>::run(derived(), res))
+    return res;
   return internal::stable_norm_impl(derived());
 }
 
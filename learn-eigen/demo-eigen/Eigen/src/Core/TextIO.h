@@ -0,0 +1,515 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_TEXTIO_H
+#define EIGEN_TEXTIO_H
+
+// std::to_chars and std::from_chars of floating point values (C++17, e.g., libstdc++ 11)
+#ifndef EIGEN_HAS_TO_CHARS
+  #if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars>=201611L
+    #define EIGEN_HAS_TO_CHARS 1
+  #else
+    #define EIGEN_HAS_TO_CHARS 0
+  #endif
+#endif
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal Appends the decimal representation of \a value to \a out */
+template<typename Integer>
+void text_append_integer(std::string& out, Integer value)
+{
+  char digits[3*sizeof(Integer)+1];
+  char* end = digits + sizeof(digits);
+  char* it = end;
+  // the magnitude of the lowest value of a signed type does not fit in it, but does in its unsigned version
+  const bool negative = value<Integer(0);
+  unsigned long long magnitude = negative ? 0ull-static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+  do {
+    *--it = char('0' + magnitude%10);
+    magnitude /= 10;
+  } while(magnitude);
+  if(negative)
+    *--it = '-';
+  out.append(it, end);
+}
+
+/** \internal Appends \a value to \a out as printf's %.<precision>g does */
+template<typename Real>
+void text_append_real(std::string& out, Real value, int precision)
+{
+  char buffer[64];
+#if EIGEN_HAS_TO_CHARS
+  const std::to_chars_result result = std::to_chars(buffer, buffer+sizeof(buffer), value, std::chars_format::general, precision);
+  out.append(buffer, result.ptr);
+#else
+  const int length = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, double(value));
+  out.append(buffer, std::size_t((std::min)(length, int(sizeof(buffer))-1)));
+#endif
+}
+
+#if !EIGEN_HAS_TO_CHARS
+template<>
+inline void text_append_real(std::string& out, long double value, int precision)
+{
+  char buffer[64];
+  const int length = std::snprintf(buffer, sizeof(buffer), "%.*Lg", precision, value);
+  out.append(buffer, std::size_t((std::min)(length, int(sizeof(buffer))-1)));
+}
+#endif
+
+// Appends a coefficient as operator<< prints it with the default flags of a stream: integers (including char
+// types) in decimal, floating point values in %g style, complex values as (real,imag). Other scalar types go
+// through a stringstream.
+template<typename Scalar,
+         int Kind = NumTraits<Scalar>::IsComplex ? 2
+                  : NumTraits<Scalar>::IsInteger ? 0
+                  : (is_same<Scalar,float>::value || is_same<Scalar,double>::value || is_same<Scalar,long double>::value
+                     || is_same<Scalar,half>::value || is_same<Scalar,bfloat16>::value) ? 1 : 3>
+struct text_coeff
+{
+  static void append(std::string& out, const Scalar& value, int) { text_append_integer(out, value); }
+};
+
+template<> struct text_coeff<bool,0>
+{
+  static void append(std::string& out, bool value, int) { out += value ? '1' : '0'; }
+};
+
+template<typename Scalar> struct text_coeff<Scalar,1>
+{
+  // half and bfloat16 are printed through float
+  typedef typename conditional<is_same<Scalar,half>::value || is_same<Scalar,bfloat16>::value, float, Scalar>::type Real;
+  static void append(std::string& out, const Scalar& value, int precision) { text_append_real(out, Real(value), precision); }
+};
+
+template<typename Scalar> struct text_coeff<Scalar,2>
+{
+  typedef typename NumTraits<Scalar>::Real Real;
+  static void append(std::string& out, const Scalar& value, int precision)
+  {
+    out += '(';
+    text_coeff<Real>::append(out, numext::real(value), precision);
+    out += ',';
+    text_coeff<Real>::append(out, numext::imag(value), precision);
+    out += ')';
+  }
+};
+
+template<typename Scalar> struct text_coeff<Scalar,3>
+{
+  static void append(std::string& out, const Scalar& value, int precision)
+  {
+    std::ostringstream stream;
+    stream.precision(precision);
+    stream << value;
+    out += stream.str();
+  }
+};
+
+// Formats the rows of a matrix as print_matrix does, with a fixed precision in place of the one of a stream
+template<typename Derived>
+class text_writer
+{
+    typedef typename Derived::Scalar Scalar;
+  public:
+    text_writer(const Derived& m, const IOFormat& fmt)
+      : m_matrix(m), m_format(fmt), m_width(0)
+    {
+      // the default precision of a stream is 6
+      m_precision = fmt.precision==StreamPrecision ? 6
+                  : fmt.precision==FullPrecision ? (NumTraits<Scalar>::IsInteger ? 6 : significant_decimals_impl<Scalar>::run())
+                  : fmt.precision;
+      if(!(fmt.flags & DontAlignCols))
+      {
+        std::string coeff;
+        for(Index j = 0; j < m.cols(); ++j)
+          for(Index i = 0; i < m.rows(); ++i)
+          {
+            coeff.clear();
+            text_coeff<Scalar>::append(coeff, m.coeff(i,j), m_precision);
+            m_width = (std::max)(m_width, coeff.size());
+          }
+      }
+    }
+
+    /** \internal Appends the rows [begin,end) to \a out, with the matrix prefix and suffix when they are the first and last rows */
+    void appendRows(std::string& out, Index begin, Index end) const
+    {
+      if(m_matrix.size()==0)
+      {
+        out += m_format.matPrefix;
+        out += m_format.matSuffix;
+        return;
+      }
+      if(begin==0)
+        out += m_format.matPrefix;
+      for(Index i = begin; i < end; ++i)
+      {
+        if(i)
+          out += m_format.rowSpacer;
+        out += m_format.rowPrefix;
+        for(Index j = 0; j < m_matrix.cols(); ++j)
+        {
+          if(j)
+            out += m_format.coeffSeparator;
+          const std::size_t start = out.size();
+          text_coeff<Scalar>::append(out, m_matrix.coeff(i,j), m_precision);
+          // the stream pads on the left
+          if(out.size()-start < m_width)
+            out.insert(start, m_width-(out.size()-start), m_format.fill);
+        }
+        out += m_format.rowSuffix;
+        if(i < m_matrix.rows()-1)
+          out += m_format.rowSeparator;
+      }
+      if(end==m_matrix.rows())
+        out += m_format.matSuffix;
+    }
+
+  protected:
+    const Derived& m_matrix;
+    const IOFormat& m_format;
+    std::size_t m_width;
+    int m_precision;
+};
+
+// Parses one coefficient from the characters [begin,end) of a single token
+template<typename Scalar,
+         int Kind = NumTraits<Scalar>::IsInteger ? 0
+                  : (is_same<Scalar,float>::value || is_same<Scalar,double>::value || is_same<Scalar,long double>::value) ? 1 : 2>
+struct text_parse_coeff
+{
+  static bool run(const char* begin, const char* end, Scalar& value)
+  {
+    if(begin<end && *begin=='+')
+      ++begin;
+    const bool isSigned = NumTraits<Scalar>::IsSigned;
+#if EIGEN_HAS_TO_CHARS
+    typedef typename conditional<NumTraits<Scalar>::IsSigned, long long, unsigned long long>::type Integer;
+    Integer parsed = 0;
+    const std::from_chars_result result = std::from_chars(begin, end, parsed);
+    if(result.ptr!=end || result.ec!=std::errc())
+      return false;
+#else
+    char token[64];
+    if(begin==end || end-begin>=Index(sizeof(token)) || (!isSigned && *begin=='-'))
+      return false;
+    std::memcpy(token, begin, std::size_t(end-begin));
+    token[end-begin] = '\0';
+    char* parsedEnd;
+  #ifdef EIGEN_HAS_ERRNO
+    errno = 0;
+  #endif
+    const long long parsed = isSigned ? std::strtoll(token, &parsedEnd, 10) : (long long)std::strtoull(token, &parsedEnd, 10);
+    if(parsedEnd!=token+(end-begin))
+      return false;
+  #ifdef EIGEN_HAS_ERRNO
+    if(errno!=0)
+      return false;
+  #endif
+#endif
+    // bool is parsed as an integer, anything but 0 being true
+    if(!is_same<Scalar,bool>::value)
+    {
+      if(isSigned ? (static_cast<long long>(parsed)<static_cast<long long>(NumTraits<Scalar>::lowest())
+                     || static_cast<long long>(parsed)>static_cast<long long>(NumTraits<Scalar>::highest()))
+                  : static_cast<unsigned long long>(parsed)>static_cast<unsigned long long>(NumTraits<Scalar>::highest()))
+        return false;
+    }
+    value = static_cast<Scalar>(parsed);
+    return true;
+  }
+};
+
+template<typename Scalar>
+struct text_parse_coeff<Scalar,1>
+{
+  static bool run(const char* begin, const char* end, Scalar& value)
+  {
+    if(begin<end && *begin=='+')
+      ++begin;
+#if EIGEN_HAS_TO_CHARS
+    const std::from_chars_result result = std::from_chars(begin, end, value);
+    if(result.ptr!=end || result.ec!=std::errc::result_out_of_range)
+      return result.ptr==end && result.ec==std::errc();
+    // from_chars leaves value unchanged on out of range values, which strtod parses as infinities or zeros
+#endif
+    char token[128];
+    if(begin==end || end-begin>=Index(sizeof(token)))
+      return false;
+    std::memcpy(token, begin, std::size_t(end-begin));
+    token[end-begin] = '\0';
+    char* parsedEnd;
+    value = is_same<Scalar,float>::value ? Scalar(std::strtof(token, &parsedEnd))
+          : is_same<Scalar,double>::value ? Scalar(std::strtod(token, &parsedEnd))
+          : Scalar(std::strtold(token, &parsedEnd));
+    return parsedEnd==token+(end-begin);
+  }
+};
+
+// other real scalar types, such as half, are parsed through double
+template<typename Scalar>
+struct text_parse_coeff<Scalar,2>
+{
+  static bool run(const char* begin, const char* end, Scalar& value)
+  {
+    EIGEN_STATIC_ASSERT(!NumTraits<Scalar>::IsComplex, THIS_TYPE_IS_NOT_SUPPORTED)
+    double parsed;
+    if(!text_parse_coeff<double>::run(begin, end, parsed))
+      return false;
+    value = static_cast<Scalar>(parsed);
+    return true;
+  }
+};
+
+inline bool text_is_blank(char c) { return c==' ' || c=='\t' || c=='\r'; }
+
+/** \internal \returns the end of the token starting at \a it, which ends at a blank, at a newline or at \a separator */
+inline const char* text_token_end(const char* it, const char* end, char separator)
+{
+  while(it<end && *it!=separator && *it!='\n' && !text_is_blank(*it))
+    ++it;
+  return it;
+}
+
+/** \internal Moves \a it past the blanks and the separator preceding the next token of the line, there being
+  * none before the first one. \returns 1 if a token follows, 0 at the end of the line, and -1 if a field is empty */
+inline int text_next_token(const char*& it, const char* end, char separator, bool first)
+{
+  bool sawSeparator = false;
+  for(; it<end && (text_is_blank(*it) || *it==separator); ++it)
+  {
+    if(*it==separator && (sawSeparator || first))
+      return -1;
+    sawSeparator = sawSeparator || *it==separator;
+  }
+  if(it==end || *it=='\n')
+    return sawSeparator ? -1 : 0;
+  return 1;
+}
+
+} // end namespace internal
+
+/** \relates DenseBase
+  *
+  * Appends the text representation of \a m to \a buffer, as it would be printed to a stream through
+  * m.format(fmt), but without the overhead of the stream: integers are formatted by hand and floating point
+  * values by std::to_chars (by snprintf before C++17). The precision of the stream, used by operator<< with
+  * the default \c StreamPrecision, is replaced by the default precision of streams, 6 digits.
+  *
+  * For instance, a CSV file is written by:
+  * \code
+  * std::string text;
+  * appendText(text, A, IOFormat(FullPrecision, DontAlignCols, ", ", "\n"));
+  * \endcode
+  *
+  * \sa writeText(), parseText(), class IOFormat
+  */
+template<typename Derived>
+void appendText(std::string& buffer, const DenseBase<Derived>& m, const IOFormat& fmt = EIGEN_DEFAULT_IO_FORMAT)
+{
+  typedef typename internal::remove_all<typename Derived::EvalReturnType>::type PlainObject;
+  const typename Derived::EvalReturnType plain = m.eval();
+  internal::text_writer<PlainObject>(plain, fmt).appendRows(buffer, 0, plain.rows());
+}
+
+/** \relates DenseBase
+  *
+  * Writes the text representation of \a m, as appendText() formats it, to \a file. The text is formatted in
+  * a buffer of about one megabyte, written by a single call to fwrite each time it fills up.
+  *
+  * \returns false if the file cannot be written
+  *
+  * \sa appendText(), saveText()
+  */
+template<typename Derived>
+bool writeText(std::FILE* file, const DenseBase<Derived>& m, const IOFormat& fmt = EIGEN_DEFAULT_IO_FORMAT)
+{
+  typedef typename internal::remove_all<typename Derived::EvalReturnType>::type PlainObject;
+  const typename Derived::EvalReturnType plain = m.eval();
+  const internal::text_writer<PlainObject> writer(plain, fmt);
+  const std::size_t chunk = std::size_t(1) << 20;
+  std::string buffer;
+  buffer.reserve(chunk + chunk/4);
+  bool ok = true;
+  Index row = 0;
+  do {
+    // an empty matrix is a prefix and a suffix
+    const Index next = plain.size()==0 ? plain.rows() : row+1;
+    writer.appendRows(buffer, row, next);
+    row = next;
+    if(buffer.size()>=chunk || row>=plain.rows())
+    {
+      ok = ok && std::fwrite(buffer.data(), 1, buffer.size(), file)==buffer.size();
+      buffer.clear();
+    }
+  } while(row<plain.rows());
+  return ok;
+}
+
+/** \relates DenseBase
+  *
+  * Writes the text representation of \a m, as appendText() formats it, to the file \a filename.
+  *
+  * \returns false if the file cannot be written
+  *
+  * \sa writeText(), loadText()
+  */
+template<typename Derived>
+bool saveText(const char* filename, const DenseBase<Derived>& m, const IOFormat& fmt = EIGEN_DEFAULT_IO_FORMAT)
+{
+  std::FILE* file = std::fopen(filename, "wb");
+  if(file==0)
+    return false;
+  const bool ok = writeText(file, m, fmt);
+  return std::fclose(file)==0 && ok;
+}
+
+/** \relates PlainObjectBase
+  *
+  * Parses the text [\a begin, \a end) into \a m in a single pass, each non-empty line being a row whose
+  * coefficients are separated by blanks (spaces or tabs) and/or by the character \a separator. This reads
+  * CSV files as well as the text written by appendText() or operator<< with the default IOFormat. Lines
+  * starting with \c # are ignored. The matrix is resized beforehand from the number of the other lines and
+  * the number of coefficients of the first row, and the coefficients are parsed straight into it, by
+  * std::from_chars (by strtod and strtoll before C++17). When \a m is a vector at compile time, a single row
+  * or column is read into it whatever its orientation. Floating point values out of the range of the scalar
+  * type are read as infinities or zeros, as strtod reads them, whereas such integers are rejected.
+  *
+  * Complex scalar types are not supported.
+  *
+  * \returns false, leaving \a m in an unspecified state, if a coefficient cannot be parsed, if the rows have
+  * different numbers of coefficients, or if the shape of the text is not one \a m can have.
+  *
+  * \sa loadText(), appendText()
+  */
+template<typename Derived>
+bool parseText(const char* begin, const char* end, PlainObjectBase<Derived>& m, char separator = ',')
+{
+  typedef typename Derived::Scalar Scalar;
+  using internal::text_token_end;
+
+  // the number of rows, i.e., of lines which are neither empty nor comments
+  Index lines = 0;
+  for(const char* it = begin; it<end;)
+  {
+    while(it<end && internal::text_is_blank(*it))
+      ++it;
+    if(it<end && *it!='\n' && *it!='#')
+      ++lines;
+    const char* newline = static_cast<const char*>(std::memchr(it, '\n', std::size_t(end-it)));
+    it = newline ? newline+1 : end;
+  }
+
+  Index rows = 0, cols = -1, count = 0;
+  bool asVector = false;
+  const char* it = begin;
+  while(it<end)
+  {
+    int next = internal::text_next_token(it, end, separator, true);
+    if(next<0)
+      return false;
+    if(next==0 || *it=='#')
+    {
+      // empty or comment line
+      const char* newline = static_cast<const char*>(std::memchr(it, '\n', std::size_t(end-it)));
+      it = newline ? newline+1 : end;
+      continue;
+    }
+    if(cols<0)
+    {
+      // the first row gives the number of columns
+      cols = 0;
+      for(const char* probe = it; next>0; ++cols)
+      {
+        probe = text_token_end(probe, end, separator);
+        next = internal::text_next_token(probe, end, separator, false);
+      }
+      if(next<0)
+        return false;
+      asVector = Derived::IsVectorAtCompileTime && (lines==1 || cols==1);
+      if(asVector)
+      {
+        const Index size = lines*cols;
+        if((Derived::SizeAtCompileTime!=Dynamic && Derived::SizeAtCompileTime!=size)
+           || (Derived::MaxSizeAtCompileTime!=Dynamic && Derived::MaxSizeAtCompileTime<size))
+          return false;
+        m.resize(Derived::RowsAtCompileTime==1 ? 1 : size, Derived::RowsAtCompileTime==1 ? size : 1);
+      }
+      else
+      {
+        if((Derived::RowsAtCompileTime!=Dynamic && Derived::RowsAtCompileTime!=lines)
+           || (Derived::ColsAtCompileTime!=Dynamic && Derived::ColsAtCompileTime!=cols)
+           || (Derived::MaxRowsAtCompileTime!=Dynamic && Derived::MaxRowsAtCompileTime<lines)
+           || (Derived::MaxColsAtCompileTime!=Dynamic && Derived::MaxColsAtCompileTime<cols))
+          return false;
+        m.resize(lines, cols);
+      }
+      next = 1;
+    }
+    Index col = 0;
+    for(; next>0; ++col, ++count)
+    {
+      const char* tokenEnd = text_token_end(it, end, separator);
+      Scalar value(0);
+      if(col==cols || !internal::text_parse_coeff<Scalar>::run(it, tokenEnd, value))
+        return false;
+      if(asVector)
+        m.coeffRef(count) = value;
+      else
+        m.coeffRef(rows, col) = value;
+      it = tokenEnd;
+      next = internal::text_next_token(it, end, separator, false);
+    }
+    if(next<0 || col!=cols)
+      return false;
+    it = it<end ? it+1 : end;
+    ++rows;
+  }
+
+  if(cols<0)
+  {
+    m.resize(Derived::RowsAtCompileTime==Dynamic ? 0 : Index(Derived::RowsAtCompileTime),
+             Derived::ColsAtCompileTime==Dynamic ? 0 : Index(Derived::ColsAtCompileTime));
+    return m.size()==0;
+  }
+  eigen_internal_assert(rows==lines && (!asVector || count==m.size()));
+  return true;
+}
+
+/** \relates PlainObjectBase
+  *
+  * Reads the whole file \a filename by a single call to fread and parses it into \a m as parseText() does.
+  *
+  * \returns false if the file cannot be read or parsed
+  *
+  * \sa parseText(), saveText()
+  */
+template<typename Derived>
+bool loadText(const char* filename, PlainObjectBase<Derived>& m, char separator = ',')
+{
+  std::FILE* file = std::fopen(filename, "rb");
+  if(file==0)
+    return false;
+  std::vector<char> text;
+  long size = -1;
+  bool ok = std::fseek(file, 0, SEEK_END)==0 && (size = std::ftell(file))>=0 && std::fseek(file, 0, SEEK_SET)==0;
+  if(ok && size>0)
+  {
+    text.resize(std::size_t(size));
+    ok = std::fread(&text[0], 1, text.size(), file)==text.size();
+  }
+  std::fclose(file);
+  return ok && parseText(text.empty() ? 0 : &text[0], text.empty() ? 0 : &text[0]+text.size(), m, separator);
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_TEXTIO_H
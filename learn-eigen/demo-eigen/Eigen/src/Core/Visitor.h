@@ -14,7 +14,7 @@ namespace Eigen {
 
 namespace internal {
 
-template<typename Visitor, typename Derived, int UnrollCount>
+template<typename Visitor, typename Derived, int UnrollCount, bool Vectorize = false>
 struct visitor_impl
 {
   enum {
@@ -63,6 +63,137 @@ struct visitor_impl<Visitor, Derived, Dynamic>
   }
 };
 
+/* Vectorized visit by the visitors retaining a single coefficient with its coordinates, i.e., the ones
+ * deriving from coeff_visitor and providing packet_mask().
+ *
+ * The coefficients are visited as column-major vectors: the whole object when it has linear access, and
+ * its columns otherwise. Each lane of the packets retains the coefficient the visitor would retain among
+ * the ones it sees, with the number of the packet it comes from, and the coefficients left out of whole
+ * packets are visited by another instance of the visitor. These coefficients are a partition of the ones
+ * of the object, and visiting the coefficients retained for each part in the order of their coordinates
+ * retains the one the scalar visit does: the first of the minimal coefficients, the last NaN with
+ * PropagateNaN, etc.
+ *
+ * The packets are numbered by Scalar counters, so that they are only exact for up to 2^digits packets:
+ * larger objects are split into segments, of consecutive coefficients with linear access and of whole
+ * columns otherwise, visited one after the other.
+ */
+template<typename Visitor, typename Derived>
+struct visitor_impl<Visitor, Derived, Dynamic, true>
+{
+  typedef typename Derived::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum {
+    PacketSize = unpacket_traits<Packet>::size,
+    Linear = bool(int(Derived::Flags)&LinearAccessBit)
+  };
+
+  // a coefficient retained by a lane, or by the visit of the remaining coefficients, with its column-major index
+  struct candidate
+  {
+    Scalar value;
+    Index index;
+  };
+
+  static EIGEN_STRONG_INLINE Packet load(const Derived& mat, Index outer, Index inner)
+  {
+    return Linear ? mat.template packet<Packet>(inner) : mat.template packet<Packet>(inner, outer);
+  }
+
+  // fills cand with the coefficients retained among the ones of the columns [outerStart,outerEnd), or among
+  // the innerSize coefficients starting at offset with linear access, and returns their number
+  static Index run_segment(const Derived& mat, candidate* cand, Index offset, Index innerSize, Index outerStart, Index outerEnd)
+  {
+    const Index rows = mat.rows();
+    const Index packetsPerOuter = innerSize / PacketSize;
+    const Index packetEnd = packetsPerOuter * PacketSize;
+
+    const Packet one = pset1<Packet>(Scalar(1));
+    Packet best = load(mat, outerStart, offset);
+    Packet bestId = pzero(best);
+    Packet id = pzero(best);
+    for(Index outer = outerStart; outer < outerEnd; ++outer)
+    {
+      for(Index inner = (outer==outerStart ? Index(PacketSize) : Index(0)); inner < packetEnd; inner += PacketSize)
+      {
+        id = padd(id, one);
+        const Packet value = load(mat, outer, offset + inner);
+        const Packet mask = Visitor::packet_mask(best, value);
+        best = pselect(mask, value, best);
+        bestId = pselect(mask, id, bestId);
+      }
+    }
+
+    Scalar values[PacketSize], ids[PacketSize];
+    pstoreu(values, best);
+    pstoreu(ids, bestId);
+    for(Index lane = 0; lane < PacketSize; ++lane)
+    {
+      const Index packet = internal::cast<Scalar,Index>(ids[lane]);
+      cand[lane].value = values[lane];
+      cand[lane].index = (Linear ? offset : (outerStart + packet / packetsPerOuter) * rows) + (packet % packetsPerOuter) * PacketSize + lane;
+    }
+    if(packetEnd == innerSize)
+      return PacketSize;
+
+    Visitor tail;
+    for(Index outer = outerStart; outer < outerEnd; ++outer)
+    {
+      for(Index inner = packetEnd; inner < innerSize; ++inner)
+      {
+        const Index index = (Linear ? offset : outer*rows) + inner;
+        if(outer==outerStart && inner==packetEnd)
+          tail.init(mat.coeff(index % rows, index / rows), index % rows, index / rows);
+        else
+          tail(mat.coeff(index % rows, index / rows), index % rows, index / rows);
+      }
+    }
+    cand[PacketSize].value = tail.res;
+    cand[PacketSize].index = tail.col * rows + tail.row;
+    return PacketSize + 1;
+  }
+
+  static void run(const Derived& mat, Visitor& visitor)
+  {
+    const Index rows = mat.rows();
+    const Index size = mat.size();
+    const Index maxPackets = Index(1) << numext::mini(NumTraits<Scalar>::digits(), 30);
+    const Index packetsPerOuter = Linear ? (size / PacketSize) : (rows / PacketSize);
+    if(packetsPerOuter == 0 || (!Linear && packetsPerOuter > maxPackets))
+      return visitor_impl<Visitor, Derived, Dynamic>::run(mat, visitor);
+
+    // segments of maxPackets whole packets with linear access, the last one holding the remaining coefficients,
+    // and of whole columns otherwise
+    const Index segmentSize = Linear ? maxPackets * PacketSize : numext::maxi(Index(1), maxPackets / packetsPerOuter);
+    const Index segmentEnd = Linear ? size : mat.cols();
+    for(Index start = 0; start < segmentEnd; start += segmentSize)
+    {
+      if(Linear && size-start < PacketSize)
+      {
+        // the last coefficients do not fill a packet
+        for(Index index = start; index < size; ++index)
+          visitor(mat.coeff(index % rows, index / rows), index % rows, index / rows);
+        break;
+      }
+      candidate cand[PacketSize+1];
+      const Index count = Linear ? run_segment(mat, cand, start, numext::mini(segmentSize, size-start), 0, 1)
+                                 : run_segment(mat, cand, 0, rows, start, numext::mini(segmentEnd, start+segmentSize));
+
+      // the candidates are visited in the order of their coordinates
+      for(Index k = 1; k < count; ++k)
+        for(Index l = k; l > 0 && cand[l].index < cand[l-1].index; --l)
+          std::swap(cand[l], cand[l-1]);
+      for(Index k = 0; k < count; ++k)
+      {
+        if(start==0 && k==0)
+          visitor.init(cand[k].value, cand[k].index % rows, cand[k].index / rows);
+        else
+          visitor(cand[k].value, cand[k].index % rows, cand[k].index / rows);
+      }
+    }
+  }
+};
+
 // evaluator adaptor
 template<typename XprType>
 class visitor_evaluator
@@ -76,6 +207,8 @@ public:
 
   enum {
     RowsAtCompileTime = XprType::RowsAtCompileTime,
+    IsRowMajor = XprType::IsRowMajor,
+    Flags = internal::evaluator<XprType>::Flags,
     CoeffReadCost = internal::evaluator<XprType>::CoeffReadCost
   };
 
@@ -86,6 +219,14 @@ public:
   EIGEN_DEVICE_FUNC CoeffReturnType coeff(Index row, Index col) const
   { return m_evaluator.coeff(row, col); }
 
+  template<typename Packet>
+  EIGEN_STRONG_INLINE Packet packet(Index row, Index col) const
+  { return m_evaluator.template packet<Unaligned,Packet>(row, col); }
+
+  template<typename Packet>
+  EIGEN_STRONG_INLINE Packet packet(Index index) const
+  { return m_evaluator.template packet<Unaligned,Packet>(index); }
+
 protected:
   internal::evaluator<XprType> m_evaluator;
   const XprType &m_xpr;
@@ -124,9 +265,18 @@ void DenseBase<Derived>::visit(Visitor& visitor) const
 
   enum {
     unroll =  SizeAtCompileTime != Dynamic
-           && SizeAtCompileTime * int(ThisEvaluator::CoeffReadCost) + (SizeAtCompileTime-1) * int(internal::functor_traits<Visitor>::Cost) <= EIGEN_UNROLLING_LIMIT
+           && SizeAtCompileTime * int(ThisEvaluator::CoeffReadCost) + (SizeAtCompileTime-1) * int(internal::functor_traits<Visitor>::Cost) <= EIGEN_UNROLLING_LIMIT,
+    // the vectorized visit follows the column-major order of the scalar one
+    vectorize = !unroll
+             && bool(internal::functor_traits<Visitor>::PacketAccess)
+             && bool(int(ThisEvaluator::Flags)&PacketAccessBit)
+             && (!ThisEvaluator::IsRowMajor || (RowsAtCompileTime==1 && bool(int(ThisEvaluator::Flags)&LinearAccessBit)))
   };
+#ifndef EIGEN_GPU_COMPILE_PHASE
+  return internal::visitor_impl<Visitor, ThisEvaluator, unroll ? int(SizeAtCompileTime) : Dynamic, vectorize>::run(thisEval, visitor);
+#else
   return internal::visitor_impl<Visitor, ThisEvaluator, unroll ? int(SizeAtCompileTime) : Dynamic>::run(thisEval, visitor);
+#endif
 }
 
 namespace internal {
@@ -171,6 +321,11 @@ struct min_coeff_visitor : coeff_visitor<Derived>
       this->col = j;
     }
   }
+
+  // \returns the mask of the lanes of \a value replacing the ones of \a res, as operator() does
+  template<typename Packet>
+  static EIGEN_STRONG_INLINE Packet packet_mask(const Packet& res, const Packet& value)
+  { return pcmp_lt(value, res); }
 };
 
 template <typename Derived>
@@ -187,6 +342,11 @@ struct min_coeff_visitor<Derived, PropagateNumbers> : coeff_visitor<Derived>
       this->col = j;
     }
   }
+
+  // the comparison is false when value is NaN
+  template<typename Packet>
+  static EIGEN_STRONG_INLINE Packet packet_mask(const Packet& res, const Packet& value)
+  { return por(pandnot(ptrue(res), pcmp_eq(res, res)), pcmp_lt(value, res)); }
 };
 
 template <typename Derived>
@@ -203,12 +363,17 @@ struct min_coeff_visitor<Derived, PropagateNaN> : coeff_visitor<Derived>
       this->col = j;
     }
   }
+
+  template<typename Packet>
+  static EIGEN_STRONG_INLINE Packet packet_mask(const Packet& res, const Packet& value)
+  { return por(pandnot(ptrue(value), pcmp_eq(value, value)), pcmp_lt(value, res)); }
 };
 
-template<typename Scalar, int NaNPropagation>
-    struct functor_traits<min_coeff_visitor<Scalar, NaNPropagation> > {
+template<typename Derived, int NaNPropagation>
+    struct functor_traits<min_coeff_visitor<Derived, NaNPropagation> > {
   enum {
-    Cost = NumTraits<Scalar>::AddCost
+    Cost = NumTraits<Derived>::AddCost,
+    PacketAccess = packet_traits<typename Derived::Scalar>::HasCmp
   };
 };
 
@@ -231,6 +396,11 @@ struct max_coeff_visitor : coeff_visitor<Derived>
       this->col = j;
     }
   }
+
+  // \returns the mask of the lanes of \a value replacing the ones of \a res, as operator() does
+  template<typename Packet>
+  static EIGEN_STRONG_INLINE Packet packet_mask(const Packet& res, const Packet& value)
+  { return pcmp_lt(res, value); }
 };
 
 template <typename Derived>
@@ -247,6 +417,11 @@ struct max_coeff_visitor<Derived, PropagateNumbers> : coeff_visitor<Derived>
       this->col = j;
     }
   }
+
+  // the comparison is false when value is NaN
+  template<typename Packet>
+  static EIGEN_STRONG_INLINE Packet packet_mask(const Packet& res, const Packet& value)
+  { return por(pandnot(ptrue(res), pcmp_eq(res, res)), pcmp_lt(res, value)); }
 };
 
 template <typename Derived>
@@ -263,12 +438,17 @@ struct max_coeff_visitor<Derived, PropagateNaN> : coeff_visitor<Derived>
       this->col = j;
     }
   }
+
+  template<typename Packet>
+  static EIGEN_STRONG_INLINE Packet packet_mask(const Packet& res, const Packet& value)
+  { return por(pandnot(ptrue(value), pcmp_eq(value, value)), pcmp_lt(res, value)); }
 };
 
-template<typename Scalar, int NaNPropagation>
-struct functor_traits<max_coeff_visitor<Scalar, NaNPropagation> > {
+template<typename Derived, int NaNPropagation>
+struct functor_traits<max_coeff_visitor<Derived, NaNPropagation> > {
   enum {
-    Cost = NumTraits<Scalar>::AddCost
+    Cost = NumTraits<Derived>::AddCost,
+    PacketAccess = packet_traits<typename Derived::Scalar>::HasCmp
   };
 };
 
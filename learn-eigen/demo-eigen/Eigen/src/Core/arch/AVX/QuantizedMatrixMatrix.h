@@ -0,0 +1,85 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_QUANTIZED_MATRIX_MATRIX_AVX_H
+#define EIGEN_QUANTIZED_MATRIX_MATRIX_AVX_H
+
+namespace Eigen {
+namespace internal {
+
+// AVX2 kernel without VNNI. vpmaddubsw would saturate the sum of two u8*s8 products to int16, so the
+// bytes are widened to int16 and multiplied with vpmaddwd, which is exact: each int32 lane then holds
+// the sum of 2 of the 4 products of a group. The lhs packet of 8 rows is split into 2 halves of 4 rows,
+// with their own accumulators, and the pairs are only summed once at the end of the depth loop.
+// The 8 x 4 block uses 8 accumulators.
+template<typename Index>
+struct qgemm_kernel<numext::int8_t,numext::uint8_t,Index>
+{
+  typedef numext::int32_t ResScalar;
+  enum { mr = 8, nr = 4 };
+
+  static void run(const numext::int8_t* blA, const numext::uint8_t* blB, Index kg, ResScalar* res, Index resStride, Index rows, Index cols)
+  {
+    // CJ_lo (resp. CJ_hi) holds pair sums of rows 0-3 (resp. 4-7) of column J:
+    // [r0 r0 r1 r1 | r2 r2 r3 r3]
+    __m256i C0_lo = _mm256_setzero_si256(), C0_hi = C0_lo, C1_lo = C0_lo, C1_hi = C0_lo,
+            C2_lo = C0_lo, C2_hi = C0_lo, C3_lo = C0_lo, C3_hi = C0_lo;
+
+#define EIGEN_QGEMM_AVX2_MADD(J)                                                          \
+    B = _mm256_cvtepu8_epi16(_mm_set1_epi32(qgemm_load_group(blB + 4*J)));                \
+    C##J##_lo = _mm256_add_epi32(C##J##_lo, _mm256_madd_epi16(A_lo, B));                  \
+    C##J##_hi = _mm256_add_epi32(C##J##_hi, _mm256_madd_epi16(A_hi, B))
+
+    for(Index g=0; g<kg; ++g)
+    {
+      EIGEN_ASM_COMMENT("begin qgemm micro kernel 8x4");
+      const __m256i A = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blA));
+      const __m256i A_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(A));
+      const __m256i A_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(A, 1));
+      __m256i B;
+      EIGEN_QGEMM_AVX2_MADD(0);
+      EIGEN_QGEMM_AVX2_MADD(1);
+      EIGEN_QGEMM_AVX2_MADD(2);
+      EIGEN_QGEMM_AVX2_MADD(3);
+      blA += 4*mr;
+      blB += 4*nr;
+      EIGEN_ASM_COMMENT("end qgemm micro kernel 8x4");
+    }
+#undef EIGEN_QGEMM_AVX2_MADD
+
+    // hadd gives [r0 r1 r4 r5 | r2 r3 r6 r7], which is reordered by 64-bit pairs
+    __m256i C[nr];
+    C[0] = _mm256_permute4x64_epi64(_mm256_hadd_epi32(C0_lo, C0_hi), _MM_SHUFFLE(3,1,2,0));
+    C[1] = _mm256_permute4x64_epi64(_mm256_hadd_epi32(C1_lo, C1_hi), _MM_SHUFFLE(3,1,2,0));
+    C[2] = _mm256_permute4x64_epi64(_mm256_hadd_epi32(C2_lo, C2_hi), _MM_SHUFFLE(3,1,2,0));
+    C[3] = _mm256_permute4x64_epi64(_mm256_hadd_epi32(C3_lo, C3_hi), _MM_SHUFFLE(3,1,2,0));
+
+    if(rows==mr)
+    {
+      for(Index j=0; j<cols; ++j)
+      {
+        __m256i* r = reinterpret_cast<__m256i*>(res + j*resStride);
+        _mm256_storeu_si256(r, _mm256_add_epi32(_mm256_loadu_si256(r), C[j]));
+      }
+    }
+    else
+    {
+      EIGEN_ALIGN32 ResScalar acc[mr];
+      for(Index j=0; j<cols; ++j)
+      {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc), C[j]);
+        for(Index i=0; i<rows; ++i)
+          res[i+j*resStride] += acc[i];
+      }
+    }
+  }
+};
+
+}  // namespace internal
+}  // namespace Eigen
+
+#endif // EIGEN_QUANTIZED_MATRIX_MATRIX_AVX_H
@@ -0,0 +1,172 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_GENERAL_BLOCK_PANEL_AVX512_H
+#define EIGEN_GENERAL_BLOCK_PANEL_AVX512_H
+
+namespace Eigen {
+namespace internal {
+
+// The generic gebp kernel works on 3*LhsProgress x 4 register blocks, i.e., 12 accumulators,
+// which is the best we can do with 16 registers. AVX512 provides 32 zmm registers, enough
+// to hold a 3*LhsProgress x 8 block: 24 accumulators, 3 lhs packets and the broadcasted rhs
+// coefficient. This halves the number of lhs loads per FMA. The 8 columns are read from two
+// consecutive panels of the usual nr==4 packed rhs, so that packing is left unchanged.
+template<typename Scalar, typename Packet, typename Index, typename DataMapper>
+struct gebp_avx512_kernel_3pX8
+{
+  enum {
+    Enabled = 1,
+    LhsProgress = unpacket_traits<Packet>::size,
+    // One lhs packet is exactly one cache line: prefetch the lhs this many steps ahead.
+    PrefetchSteps = 8,
+    pk = 8
+  };
+  typedef Scalar ResScalar;
+  typedef typename DataMapper::LinearMapper LinearMapper;
+
+  EIGEN_STRONG_INLINE void operator()(const DataMapper& res, const Scalar* blockA, const Scalar* blockB, Index i1, Index i2, Index cols8,
+                                      Index depth, Scalar alpha, Index strideA, Index strideB, Index offsetA, Index offsetB) const
+  {
+    const Index peeled_kc = depth & ~Index(pk-1);
+    const Packet alphav = pset1<Packet>(alpha);
+
+    for(Index j2=0; j2<cols8; j2+=8)
+    {
+      for(Index i=i1; i<i2; i+=3*LhsProgress)
+      {
+        const Scalar* blA = &blockA[i*strideA+offsetA*(3*LhsProgress)];
+        const Scalar* blB0 = &blockB[j2*strideB+offsetB*4];
+        const Scalar* blB1 = &blockB[(j2+4)*strideB+offsetB*4];
+        prefetch(&blA[0]);
+        prefetch(&blB0[0]);
+        prefetch(&blB1[0]);
+
+        LinearMapper r0 = res.getLinearMapper(i, j2 + 0);
+        LinearMapper r1 = res.getLinearMapper(i, j2 + 1);
+        LinearMapper r2 = res.getLinearMapper(i, j2 + 2);
+        LinearMapper r3 = res.getLinearMapper(i, j2 + 3);
+        LinearMapper r4 = res.getLinearMapper(i, j2 + 4);
+        LinearMapper r5 = res.getLinearMapper(i, j2 + 5);
+        LinearMapper r6 = res.getLinearMapper(i, j2 + 6);
+        LinearMapper r7 = res.getLinearMapper(i, j2 + 7);
+
+#define EIGEN_GEBP_AVX512_PREFETCH_RES(R) R.prefetch(0); R.prefetch(LhsProgress); R.prefetch(2*LhsProgress)
+        EIGEN_GEBP_AVX512_PREFETCH_RES(r0); EIGEN_GEBP_AVX512_PREFETCH_RES(r1);
+        EIGEN_GEBP_AVX512_PREFETCH_RES(r2); EIGEN_GEBP_AVX512_PREFETCH_RES(r3);
+        EIGEN_GEBP_AVX512_PREFETCH_RES(r4); EIGEN_GEBP_AVX512_PREFETCH_RES(r5);
+        EIGEN_GEBP_AVX512_PREFETCH_RES(r6); EIGEN_GEBP_AVX512_PREFETCH_RES(r7);
+#undef EIGEN_GEBP_AVX512_PREFETCH_RES
+
+        // Cj_p holds the p-th packet of the j-th column of the res block
+        Packet C0_0 = pzero(alphav), C0_1 = pzero(alphav), C0_2 = pzero(alphav),
+               C1_0 = pzero(alphav), C1_1 = pzero(alphav), C1_2 = pzero(alphav),
+               C2_0 = pzero(alphav), C2_1 = pzero(alphav), C2_2 = pzero(alphav),
+               C3_0 = pzero(alphav), C3_1 = pzero(alphav), C3_2 = pzero(alphav),
+               C4_0 = pzero(alphav), C4_1 = pzero(alphav), C4_2 = pzero(alphav),
+               C5_0 = pzero(alphav), C5_1 = pzero(alphav), C5_2 = pzero(alphav),
+               C6_0 = pzero(alphav), C6_1 = pzero(alphav), C6_2 = pzero(alphav),
+               C7_0 = pzero(alphav), C7_1 = pzero(alphav), C7_2 = pzero(alphav);
+        Packet A0, A1, A2, B;
+
+#define EIGEN_GEBP_AVX512_MADD(J, BL, L)                                   \
+        B = pset1<Packet>(BL[L]);                                          \
+        C##J##_0 = pmadd(A0, B, C##J##_0);                                 \
+        C##J##_1 = pmadd(A1, B, C##J##_1);                                 \
+        C##J##_2 = pmadd(A2, B, C##J##_2)
+
+#define EIGEN_GEBP_AVX512_ONESTEP(K)                                       \
+        do {                                                               \
+          EIGEN_ASM_COMMENT("begin step of gebp micro kernel 3pX8");       \
+          internal::prefetch(blA + (3*(K+PrefetchSteps) + 0)*LhsProgress); \
+          internal::prefetch(blA + (3*(K+PrefetchSteps) + 1)*LhsProgress); \
+          internal::prefetch(blA + (3*(K+PrefetchSteps) + 2)*LhsProgress); \
+          A0 = pload<Packet>(blA + (0 + 3*K)*LhsProgress);                 \
+          A1 = pload<Packet>(blA + (1 + 3*K)*LhsProgress);                 \
+          A2 = pload<Packet>(blA + (2 + 3*K)*LhsProgress);                 \
+          EIGEN_GEBP_AVX512_MADD(0, blB0, 4*K + 0);                        \
+          EIGEN_GEBP_AVX512_MADD(1, blB0, 4*K + 1);                        \
+          EIGEN_GEBP_AVX512_MADD(2, blB0, 4*K + 2);                        \
+          EIGEN_GEBP_AVX512_MADD(3, blB0, 4*K + 3);                        \
+          EIGEN_GEBP_AVX512_MADD(4, blB1, 4*K + 0);                        \
+          EIGEN_GEBP_AVX512_MADD(5, blB1, 4*K + 1);                        \
+          EIGEN_GEBP_AVX512_MADD(6, blB1, 4*K + 2);                        \
+          EIGEN_GEBP_AVX512_MADD(7, blB1, 4*K + 3);                        \
+          EIGEN_ASM_COMMENT("end step of gebp micro kernel 3pX8");         \
+        } while(false)
+
+        for(Index k=0; k<peeled_kc; k+=pk)
+        {
+          EIGEN_ASM_COMMENT("begin gebp micro kernel 3pX8");
+          internal::prefetch(blB0 + 4*pk);
+          internal::prefetch(blB1 + 4*pk);
+          EIGEN_GEBP_AVX512_ONESTEP(0);
+          EIGEN_GEBP_AVX512_ONESTEP(1);
+          EIGEN_GEBP_AVX512_ONESTEP(2);
+          EIGEN_GEBP_AVX512_ONESTEP(3);
+          EIGEN_GEBP_AVX512_ONESTEP(4);
+          EIGEN_GEBP_AVX512_ONESTEP(5);
+          EIGEN_GEBP_AVX512_ONESTEP(6);
+          EIGEN_GEBP_AVX512_ONESTEP(7);
+
+          blA += pk*3*LhsProgress;
+          blB0 += pk*4;
+          blB1 += pk*4;
+          EIGEN_ASM_COMMENT("end gebp micro kernel 3pX8");
+        }
+        // process remaining peeled loop
+        for(Index k=peeled_kc; k<depth; k++)
+        {
+          EIGEN_GEBP_AVX512_ONESTEP(0);
+          blA += 3*LhsProgress;
+          blB0 += 4;
+          blB1 += 4;
+        }
+
+#undef EIGEN_GEBP_AVX512_ONESTEP
+#undef EIGEN_GEBP_AVX512_MADD
+
+        Packet R0, R1, R2;
+#define EIGEN_GEBP_AVX512_STORE(J)                                         \
+        R0 = r##J.template loadPacket<Packet>(0 * LhsProgress);            \
+        R1 = r##J.template loadPacket<Packet>(1 * LhsProgress);            \
+        R2 = r##J.template loadPacket<Packet>(2 * LhsProgress);            \
+        R0 = pmadd(C##J##_0, alphav, R0);                                  \
+        R1 = pmadd(C##J##_1, alphav, R1);                                  \
+        R2 = pmadd(C##J##_2, alphav, R2);                                  \
+        r##J.storePacket(0 * LhsProgress, R0);                             \
+        r##J.storePacket(1 * LhsProgress, R1);                             \
+        r##J.storePacket(2 * LhsProgress, R2)
+
+        EIGEN_GEBP_AVX512_STORE(0);
+        EIGEN_GEBP_AVX512_STORE(1);
+        EIGEN_GEBP_AVX512_STORE(2);
+        EIGEN_GEBP_AVX512_STORE(3);
+        EIGEN_GEBP_AVX512_STORE(4);
+        EIGEN_GEBP_AVX512_STORE(5);
+        EIGEN_GEBP_AVX512_STORE(6);
+        EIGEN_GEBP_AVX512_STORE(7);
+#undef EIGEN_GEBP_AVX512_STORE
+      }
+    }
+  }
+};
+
+template<typename Index, typename DataMapper, bool ConjugateLhs, bool ConjugateRhs>
+struct gebp_micro_kernel_3pX8<float,float,Index,DataMapper,ConjugateLhs,ConjugateRhs>
+  : gebp_avx512_kernel_3pX8<float,Packet16f,Index,DataMapper>
+{};
+
+template<typename Index, typename DataMapper, bool ConjugateLhs, bool ConjugateRhs>
+struct gebp_micro_kernel_3pX8<double,double,Index,DataMapper,ConjugateLhs,ConjugateRhs>
+  : gebp_avx512_kernel_3pX8<double,Packet8d,Index,DataMapper>
+{};
+
+}  // namespace internal
+}  // namespace Eigen
+
+#endif // EIGEN_GENERAL_BLOCK_PANEL_AVX512_H
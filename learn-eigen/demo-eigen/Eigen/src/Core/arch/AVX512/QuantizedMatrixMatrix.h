@@ -0,0 +1,98 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_QUANTIZED_MATRIX_MATRIX_AVX512_H
+#define EIGEN_QUANTIZED_MATRIX_MATRIX_AVX512_H
+
+namespace Eigen {
+namespace internal {
+
+// VNNI kernel: vpdpbusd multiplies the 4 uint8 of each int32 lane of its first operand by the
+// corresponding 4 int8 of the second one and adds the 4 products to the int32 lane of the accumulator.
+// A 4-byte group of the rhs is broadcasted to all lanes, while each lane of a lhs packet holds the
+// 4-byte group of one row, so that a packet computes 16 rows of one column of the result.
+// The 32 x 8 block uses 16 accumulators.
+template<typename Index>
+struct qgemm_kernel<numext::int8_t,numext::uint8_t,Index>
+{
+  typedef numext::int32_t ResScalar;
+  enum { mr = 32, nr = 8 };
+
+  static void run(const numext::int8_t* blA, const numext::uint8_t* blB, Index kg, ResScalar* res, Index resStride, Index rows, Index cols)
+  {
+    __m512i C0_0 = _mm512_setzero_si512(), C0_1 = C0_0, C1_0 = C0_0, C1_1 = C0_0,
+            C2_0 = C0_0, C2_1 = C0_0, C3_0 = C0_0, C3_1 = C0_0,
+            C4_0 = C0_0, C4_1 = C0_0, C5_0 = C0_0, C5_1 = C0_0,
+            C6_0 = C0_0, C6_1 = C0_0, C7_0 = C0_0, C7_1 = C0_0;
+
+#define EIGEN_QGEMM_AVX512_MADD(J)                                            \
+    B = _mm512_set1_epi32(qgemm_load_group(blB + 4*J));                       \
+    C##J##_0 = _mm512_dpbusd_epi32(C##J##_0, B, A0);                          \
+    C##J##_1 = _mm512_dpbusd_epi32(C##J##_1, B, A1)
+
+    for(Index g=0; g<kg; ++g)
+    {
+      EIGEN_ASM_COMMENT("begin qgemm micro kernel 32x8");
+      internal::prefetch(blA + 8*4*mr);
+      const __m512i A0 = _mm512_loadu_si512(reinterpret_cast<const void*>(blA));
+      const __m512i A1 = _mm512_loadu_si512(reinterpret_cast<const void*>(blA + 64));
+      __m512i B;
+      EIGEN_QGEMM_AVX512_MADD(0);
+      EIGEN_QGEMM_AVX512_MADD(1);
+      EIGEN_QGEMM_AVX512_MADD(2);
+      EIGEN_QGEMM_AVX512_MADD(3);
+      EIGEN_QGEMM_AVX512_MADD(4);
+      EIGEN_QGEMM_AVX512_MADD(5);
+      EIGEN_QGEMM_AVX512_MADD(6);
+      EIGEN_QGEMM_AVX512_MADD(7);
+      blA += 4*mr;
+      blB += 4*nr;
+      EIGEN_ASM_COMMENT("end qgemm micro kernel 32x8");
+    }
+#undef EIGEN_QGEMM_AVX512_MADD
+
+    if(rows==mr && cols==nr)
+    {
+#define EIGEN_QGEMM_AVX512_STORE(J)                                                                             \
+      _mm512_storeu_si512(res + J*resStride,      _mm512_add_epi32(_mm512_loadu_si512(res + J*resStride), C##J##_0));      \
+      _mm512_storeu_si512(res + J*resStride + 16, _mm512_add_epi32(_mm512_loadu_si512(res + J*resStride + 16), C##J##_1))
+      EIGEN_QGEMM_AVX512_STORE(0);
+      EIGEN_QGEMM_AVX512_STORE(1);
+      EIGEN_QGEMM_AVX512_STORE(2);
+      EIGEN_QGEMM_AVX512_STORE(3);
+      EIGEN_QGEMM_AVX512_STORE(4);
+      EIGEN_QGEMM_AVX512_STORE(5);
+      EIGEN_QGEMM_AVX512_STORE(6);
+      EIGEN_QGEMM_AVX512_STORE(7);
+#undef EIGEN_QGEMM_AVX512_STORE
+    }
+    else
+    {
+      EIGEN_ALIGN64 ResScalar acc[mr*nr];
+#define EIGEN_QGEMM_AVX512_STORE(J)                                          \
+      _mm512_store_si512(acc + J*mr,      C##J##_0);                         \
+      _mm512_store_si512(acc + J*mr + 16, C##J##_1)
+      EIGEN_QGEMM_AVX512_STORE(0);
+      EIGEN_QGEMM_AVX512_STORE(1);
+      EIGEN_QGEMM_AVX512_STORE(2);
+      EIGEN_QGEMM_AVX512_STORE(3);
+      EIGEN_QGEMM_AVX512_STORE(4);
+      EIGEN_QGEMM_AVX512_STORE(5);
+      EIGEN_QGEMM_AVX512_STORE(6);
+      EIGEN_QGEMM_AVX512_STORE(7);
+#undef EIGEN_QGEMM_AVX512_STORE
+      for(Index j=0; j<cols; ++j)
+        for(Index i=0; i<rows; ++i)
+          res[i+j*resStride] += acc[i+j*mr];
+    }
+  }
+};
+
+}  // namespace internal
+}  // namespace Eigen
+
+#endif // EIGEN_QUANTIZED_MATRIX_MATRIX_AVX512_H
@@ -0,0 +1,80 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_QUANTIZED_MATRIX_MATRIX_SSE_H
+#define EIGEN_QUANTIZED_MATRIX_MATRIX_SSE_H
+
+namespace Eigen {
+namespace internal {
+
+// SSE4.1 kernel, see the AVX2 one: the bytes are widened to int16 and multiplied with pmaddwd, the
+// lhs packet of 4 rows being split into 2 halves of 2 rows. The 4 x 4 block uses 8 accumulators.
+template<typename Index>
+struct qgemm_kernel<numext::int8_t,numext::uint8_t,Index>
+{
+  typedef numext::int32_t ResScalar;
+  enum { mr = 4, nr = 4 };
+
+  static void run(const numext::int8_t* blA, const numext::uint8_t* blB, Index kg, ResScalar* res, Index resStride, Index rows, Index cols)
+  {
+    // CJ_lo (resp. CJ_hi) holds pair sums of rows 0-1 (resp. 2-3) of column J: [r0 r0 r1 r1]
+    __m128i C0_lo = _mm_setzero_si128(), C0_hi = C0_lo, C1_lo = C0_lo, C1_hi = C0_lo,
+            C2_lo = C0_lo, C2_hi = C0_lo, C3_lo = C0_lo, C3_hi = C0_lo;
+
+#define EIGEN_QGEMM_SSE_MADD(J)                                                           \
+    B = _mm_cvtepu8_epi16(_mm_set1_epi32(qgemm_load_group(blB + 4*J)));                   \
+    C##J##_lo = _mm_add_epi32(C##J##_lo, _mm_madd_epi16(A_lo, B));                        \
+    C##J##_hi = _mm_add_epi32(C##J##_hi, _mm_madd_epi16(A_hi, B))
+
+    for(Index g=0; g<kg; ++g)
+    {
+      EIGEN_ASM_COMMENT("begin qgemm micro kernel 4x4");
+      const __m128i A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blA));
+      const __m128i A_lo = _mm_cvtepi8_epi16(A);
+      const __m128i A_hi = _mm_cvtepi8_epi16(_mm_srli_si128(A, 8));
+      __m128i B;
+      EIGEN_QGEMM_SSE_MADD(0);
+      EIGEN_QGEMM_SSE_MADD(1);
+      EIGEN_QGEMM_SSE_MADD(2);
+      EIGEN_QGEMM_SSE_MADD(3);
+      blA += 4*mr;
+      blB += 4*nr;
+      EIGEN_ASM_COMMENT("end qgemm micro kernel 4x4");
+    }
+#undef EIGEN_QGEMM_SSE_MADD
+
+    __m128i C[nr];
+    C[0] = _mm_hadd_epi32(C0_lo, C0_hi);
+    C[1] = _mm_hadd_epi32(C1_lo, C1_hi);
+    C[2] = _mm_hadd_epi32(C2_lo, C2_hi);
+    C[3] = _mm_hadd_epi32(C3_lo, C3_hi);
+
+    if(rows==mr)
+    {
+      for(Index j=0; j<cols; ++j)
+      {
+        __m128i* r = reinterpret_cast<__m128i*>(res + j*resStride);
+        _mm_storeu_si128(r, _mm_add_epi32(_mm_loadu_si128(r), C[j]));
+      }
+    }
+    else
+    {
+      EIGEN_ALIGN16 ResScalar acc[mr];
+      for(Index j=0; j<cols; ++j)
+      {
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc), C[j]);
+        for(Index i=0; i<rows; ++i)
+          res[i+j*resStride] += acc[i];
+      }
+    }
+  }
+};
+
+}  // namespace internal
+}  // namespace Eigen
+
+#endif // EIGEN_QUANTIZED_MATRIX_MATRIX_SSE_H
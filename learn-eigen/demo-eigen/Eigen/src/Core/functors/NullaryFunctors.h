@@ -175,11 +175,11 @@ template<typename Scalar,typename IndexType>
 struct has_binary_operator<linspaced_op<Scalar>,IndexType> { enum { value = 0}; };
 
 template<typename Scalar,typename IndexType>
-struct has_nullary_operator<scalar_random_op<Scalar>,IndexType> { enum { value = 1}; };
+struct has_nullary_operator<scalar_random_op<Scalar>,IndexType> { enum { value = 0}; };
 template<typename Scalar,typename IndexType>
-struct has_unary_operator<scalar_random_op<Scalar>,IndexType> { enum { value = 0}; };
+struct has_unary_operator<scalar_random_op<Scalar>,IndexType> { enum { value = 1}; };
 template<typename Scalar,typename IndexType>
-struct has_binary_operator<scalar_random_op<Scalar>,IndexType> { enum { value = 0}; };
+struct has_binary_operator<scalar_random_op<Scalar>,IndexType> { enum { value = 1}; };
 #endif
 
 } // end namespace internal
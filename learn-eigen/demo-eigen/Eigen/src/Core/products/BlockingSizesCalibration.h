@@ -0,0 +1,142 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_BLOCKING_SIZES_CALIBRATION_H
+#define EIGEN_BLOCKING_SIZES_CALIBRATION_H
+
+namespace Eigen {
+
+namespace internal {
+
+// blocking with prescribed sizes, the packing buffers being allocated by the product itself
+template<typename LhsScalar, typename RhsScalar>
+class prescribed_level3_blocking : public level3_blocking<LhsScalar,RhsScalar>
+{
+  public:
+    prescribed_level3_blocking(Index kc, Index mc, Index nc)
+    {
+      this->m_kc = kc;
+      this->m_mc = mc;
+      this->m_nc = nc;
+    }
+};
+
+/* Search of the fastest blocking sizes of the products of Scalar matrices, for one size per bucket of
+ * blocking_sizes_table.
+ *
+ * For each shape, the search starts from the sizes given by the heuristic and tries to double or halve
+ * kc, mc and nc in turn, keeping a change when it makes the product at least 2% faster, until no change
+ * helps. Only the shapes for which the result beats the heuristic by at least 5% make it to the table,
+ * which keeps it compact: the heuristic is usually right for large square-ish products, and wrong for
+ * skinny ones.
+ */
+template<typename Scalar>
+struct blocking_sizes_calibration
+{
+  typedef general_matrix_matrix_product<Index,Scalar,ColMajor,false,Scalar,ColMajor,false,ColMajor,1> Gemm;
+  typedef gebp_traits<Scalar,Scalar> Traits;
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  enum { Id = blocking_sizes_scalar_id<Scalar>::value };
+
+  // best time, in seconds, of res += lhs * rhs computed with the given blocking sizes
+  static double time(const MatrixType& lhs, const MatrixType& rhs, MatrixType& res, const Index blocking[3])
+  {
+    prescribed_level3_blocking<Scalar,Scalar> actualBlocking(blocking[0], blocking[1], blocking[2]);
+    // repeat small products so that each measure lasts long enough for the clock
+    const double flops = 2. * double(lhs.rows()) * double(lhs.cols()) * double(rhs.cols());
+    const int repeat = int((std::max)(1., 2e7 / flops));
+    double best = (std::numeric_limits<double>::max)();
+    for(int tries=0; tries<3; ++tries)
+    {
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for(int r=0; r<repeat; ++r)
+        Gemm::run(lhs.rows(), rhs.cols(), lhs.cols(), lhs.data(), lhs.outerStride(), rhs.data(), rhs.outerStride(),
+                  res.data(), 1, res.outerStride(), Scalar(1), actualBlocking, 0);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      best = (std::min)(best, elapsed.count() / repeat);
+    }
+    return best;
+  }
+
+  static void run(blocking_sizes_table& table, int minBucket, int maxBucket, double maxFlops)
+  {
+    for(int kb=minBucket; kb<=maxBucket; ++kb)
+    for(int mb=minBucket; mb<=maxBucket; ++mb)
+    for(int nb=minBucket; nb<=maxBucket; ++nb)
+    {
+      const Index size[3] = { Index(1)<<kb, Index(1)<<mb, Index(1)<<nb };
+      if(2. * double(size[0]) * double(size[1]) * double(size[2]) > maxFlops)
+        continue;
+      const MatrixType lhs = MatrixType::Random(size[1], size[0]);
+      const MatrixType rhs = MatrixType::Random(size[0], size[2]);
+      MatrixType res = MatrixType::Zero(size[1], size[2]);
+
+      Index blocking[3] = { size[0], size[1], size[2] };
+      evaluateProductBlockingSizesHeuristic<Scalar,Scalar,1>(blocking[0], blocking[1], blocking[2], Index(1));
+      const double heuristic = time(lhs, rhs, res, blocking);
+      double best = heuristic;
+
+      // kc, mc and nc stay multiples of the register blocking sizes, unless they span the whole dimension
+      const Index step[3] = { 8, Traits::mr, Traits::nr };
+      bool improved = true;
+      while(improved)
+      {
+        improved = false;
+        for(int p=0; p<3; ++p)
+        for(int grow=0; grow<2; ++grow)
+        {
+          Index candidate[3] = { blocking[0], blocking[1], blocking[2] };
+          const Index v = grow ? blocking[p]*2 : blocking[p]/2;
+          candidate[p] = v>=size[p] ? size[p] : (std::max)(step[p], v / step[p] * step[p]);
+          if(candidate[p]==blocking[p])
+            continue;
+          const double t = time(lhs, rhs, res, candidate);
+          if(t < 0.98*best)
+          {
+            best = t;
+            std::copy(candidate, candidate+3, blocking);
+            improved = true;
+          }
+        }
+      }
+
+      if(best < 0.95*heuristic)
+        table.insert(Id, Id, kb, mb, nb, blocking[0], blocking[1], blocking[2]);
+    }
+  }
+};
+
+} // end namespace internal
+
+/** Benchmarks the products of \c float and \c double matrices on the host to find their fastest blocking
+  * sizes, writes them to the file \a filename, and makes them the table of tuned blocking sizes used by
+  * the products from then on.
+  *
+  * One shape is measured per combination of buckets of depth, rows and columns: the sizes 2^b for b in
+  * [\a minBucket, \a maxBucket], skipping the products of more than \a maxFlops floating point operations.
+  * This takes a few minutes with the default parameters, and is meant to be run once per host, e.g., by a
+  * dedicated program. Other programs then load the table with loadBlockingSizesTable(), or by setting the
+  * environment variable \c EIGEN_BLOCKING_SIZES_TABLE to \a filename.
+  *
+  * This function must not be called while a matrix product is running.
+  *
+  * \returns false if the file cannot be written
+  *
+  * \sa loadBlockingSizesTable() */
+inline bool calibrateBlockingSizes(const char* filename, int minBucket = 4, int maxBucket = 11, double maxFlops = 5e8)
+{
+  eigen_assert(minBucket>=0 && maxBucket<=internal::blocking_sizes_table::MaxBucket && minBucket<=maxBucket);
+  internal::blocking_sizes_table table;
+  internal::blocking_sizes_calibration<float>::run(table, minBucket, maxBucket, maxFlops);
+  internal::blocking_sizes_calibration<double>::run(table, minBucket, maxBucket, maxFlops);
+  internal::tuned_blocking_sizes() = table;
+  return table.save(filename);
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_BLOCKING_SIZES_CALIBRATION_H
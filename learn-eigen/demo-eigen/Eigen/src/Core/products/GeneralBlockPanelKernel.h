@@ -67,14 +67,20 @@ const std::ptrdiff_t defaultL3CacheSize = EIGEN_SET_DEFAULT_L3_CACHE_SIZE(512*10
 #undef EIGEN_SET_DEFAULT_L2_CACHE_SIZE
 #undef EIGEN_SET_DEFAULT_L3_CACHE_SIZE
 
+/** \internal \returns the topology of the caches of the host, queried once */
+inline const CacheTopology& cache_topology()
+{
+  static const CacheTopology m_topology = queryCacheTopology();
+  return m_topology;
+}
+
 /** \internal */
 struct CacheSizes {
   CacheSizes(): m_l1(-1),m_l2(-1),m_l3(-1) {
-    int l1CacheSize, l2CacheSize, l3CacheSize;
-    queryCacheSizes(l1CacheSize, l2CacheSize, l3CacheSize);
-    m_l1 = manage_caching_sizes_helper(l1CacheSize, defaultL1CacheSize);
-    m_l2 = manage_caching_sizes_helper(l2CacheSize, defaultL2CacheSize);
-    m_l3 = manage_caching_sizes_helper(l3CacheSize, defaultL3CacheSize);
+    const CacheTopology& topology = cache_topology();
+    m_l1 = manage_caching_sizes_helper(topology.size[1], defaultL1CacheSize);
+    m_l2 = manage_caching_sizes_helper(topology.size[2], defaultL2CacheSize);
+    m_l3 = manage_caching_sizes_helper(topology.size[3], defaultL3CacheSize);
   }
 
   std::ptrdiff_t m_l1;
@@ -108,6 +114,21 @@ inline void manage_caching_sizes(Action action, std::ptrdiff_t* l1, std::ptrdiff
   }
 }
 
+/** \internal Computes how many of \a num_threads threads running a product share one instance of the L2 cache
+  * and of the L3 cache, assuming that the threads are spread evenly over the instances.
+  * When the sharing is unknown, the L2 cache is considered private to each thread and the L3 cache shared by all. */
+template<typename Index>
+inline void cache_sharing(Index num_threads, Index& l2_threads, Index& l3_threads)
+{
+  const CacheTopology& topology = cache_topology();
+  l2_threads = 1;
+  l3_threads = num_threads;
+  if(topology.cpus>0 && topology.shared[2]>0)
+    l2_threads = numext::div_ceil(num_threads, numext::mini<Index>(num_threads, numext::maxi(1, topology.cpus/topology.shared[2])));
+  if(topology.cpus>0 && topology.shared[3]>0)
+    l3_threads = numext::div_ceil(num_threads, numext::mini<Index>(num_threads, numext::maxi(1, topology.cpus/topology.shared[3])));
+}
+
 /* Helper for computeProductBlockingSizes.
  *
  * Given a m x k times k x n matrix product of scalar types \c LhsScalar and \c RhsScalar,
@@ -163,6 +184,12 @@ void evaluateProductBlockingSizesHeuristic(Index& k, Index& m, Index& n, Index n
       eigen_internal_assert(k > 0);
     }
 
+    // the threads running on the same core (SMT) or on the same cluster of cores share their L2 cache,
+    // and the threads running on the same socket or core complex share their L3 cache
+    Index l2_threads, l3_threads;
+    cache_sharing(num_threads, l2_threads, l3_threads);
+    l2 = numext::maxi<std::ptrdiff_t>(l2 / l2_threads, 2*l1);
+
     const Index n_cache = (l2-l1) / (nr * sizeof(RhsScalar) * k);
     const Index n_per_thread = numext::div_ceil(n, num_threads);
     if (n_cache <= n_per_thread) {
@@ -175,8 +202,9 @@ void evaluateProductBlockingSizesHeuristic(Index& k, Index& m, Index& n, Index n
     }
 
     if (l3 > l2) {
-      // l3 is shared between all cores, so we'll give each thread its own chunk of l3.
-      const Index m_cache = (l3-l2) / (sizeof(LhsScalar) * k * num_threads);
+      // the packed lhs block is shared between all the threads, which are spread over the instances of l3:
+      // we'll give each thread its own chunk of the instance it runs on.
+      const Index m_cache = (l3-l2) / (sizeof(LhsScalar) * k * l3_threads);
       const Index m_per_thread = numext::div_ceil(m, num_threads);
       if(m_cache < m_per_thread && m_cache >= static_cast<Index>(mr)) {
         m = m_cache - (m_cache % mr);
@@ -319,6 +347,163 @@ inline bool useSpecificBlockingSizes(Index& k, Index& m, Index& n)
   return false;
 }
 
+/** \internal Identifies a scalar type in a table of tuned blocking sizes, 0 for the types which are not tuned. */
+template<typename Scalar> struct blocking_sizes_scalar_id { enum { value = 0 }; };
+template<> struct blocking_sizes_scalar_id<float> { enum { value = 'f' }; };
+template<> struct blocking_sizes_scalar_id<double> { enum { value = 'd' }; };
+template<> struct blocking_sizes_scalar_id<std::complex<float> > { enum { value = 'c' }; };
+template<> struct blocking_sizes_scalar_id<std::complex<double> > { enum { value = 'z' }; };
+
+/** \internal Table of blocking sizes tuned for the host, see calibrateBlockingSizes().
+  *
+  * An entry holds the fastest kc, mc and nc measured for the products of two given scalar types whose
+  * depth, rows and columns respectively fall into given buckets of sizes. The bucket b holds the sizes
+  * [2^b,2^(b+1)). The table is stored as a text file holding one entry per line:
+  * \code
+  * <lhs scalar id><rhs scalar id> <depth bucket> <rows bucket> <cols bucket> <kc> <mc> <nc>
+  * \endcode
+  * e.g., "ff 4 11 11 16 96 2048". Lines starting with '#' are comments.
+  */
+class blocking_sizes_table
+{
+  public:
+    enum { MaxBucket = 31 };
+
+    explicit blocking_sizes_table(const char* filename = 0)
+    {
+      if(filename!=0)
+        load(filename);
+    }
+
+    static int bucket(Index size)
+    {
+      int b = 0;
+      while(b<MaxBucket && (Index(2)<<b)<=size)
+        ++b;
+      return b;
+    }
+
+    bool empty() const { return m_entries.empty(); }
+
+    void clear() { m_entries.clear(); }
+
+    void insert(int lhsId, int rhsId, int depthBucket, int rowsBucket, int colsBucket, Index kc, Index mc, Index nc)
+    {
+      Entry entry;
+      entry.key = key(lhsId, rhsId, depthBucket, rowsBucket, colsBucket);
+      entry.kc = kc;
+      entry.mc = mc;
+      entry.nc = nc;
+      std::vector<Entry>::iterator it = std::lower_bound(m_entries.begin(), m_entries.end(), entry);
+      if(it!=m_entries.end() && it->key==entry.key)
+        *it = entry;
+      else
+        m_entries.insert(it, entry);
+    }
+
+    bool find(int lhsId, int rhsId, Index depth, Index rows, Index cols, Index& kc, Index& mc, Index& nc) const
+    {
+      Entry entry;
+      entry.key = key(lhsId, rhsId, bucket(depth), bucket(rows), bucket(cols));
+      std::vector<Entry>::const_iterator it = std::lower_bound(m_entries.begin(), m_entries.end(), entry);
+      if(it==m_entries.end() || it->key!=entry.key)
+        return false;
+      kc = it->kc;
+      mc = it->mc;
+      nc = it->nc;
+      return true;
+    }
+
+    /** Replaces the content of the table by the one of the file \a filename.
+      * \returns false, leaving the table empty, if the file cannot be read or is malformed */
+    bool load(const char* filename)
+    {
+      clear();
+      std::FILE* file = std::fopen(filename, "r");
+      if(file==0)
+        return false;
+      bool ok = true;
+      char line[256];
+      while(ok && std::fgets(line, sizeof(line), file)!=0)
+      {
+        if(line[0]=='#' || line[0]=='\n')
+          continue;
+        char lhsId, rhsId;
+        int depthBucket, rowsBucket, colsBucket;
+        long kc, mc, nc;
+        ok = std::sscanf(line, " %c%c %d %d %d %ld %ld %ld", &lhsId, &rhsId, &depthBucket, &rowsBucket, &colsBucket, &kc, &mc, &nc)==8
+          && depthBucket>=0 && depthBucket<=MaxBucket && rowsBucket>=0 && rowsBucket<=MaxBucket && colsBucket>=0 && colsBucket<=MaxBucket
+          && kc>0 && mc>0 && nc>0;
+        if(ok)
+          insert(lhsId, rhsId, depthBucket, rowsBucket, colsBucket, kc, mc, nc);
+      }
+      std::fclose(file);
+      if(!ok)
+        clear();
+      return ok;
+    }
+
+    /** Writes the table to the file \a filename. \returns false if the file cannot be written */
+    bool save(const char* filename) const
+    {
+      std::FILE* file = std::fopen(filename, "w");
+      if(file==0)
+        return false;
+      bool ok = std::fprintf(file, "# Eigen blocking sizes: lhs/rhs scalars, depth/rows/cols log2 buckets, kc mc nc\n")>0;
+      for(std::size_t i=0; ok && i<m_entries.size(); ++i)
+      {
+        const Entry& e = m_entries[i];
+        ok = std::fprintf(file, "%c%c %u %u %u %ld %ld %ld\n", char((e.key>>22)&0x7f), char((e.key>>15)&0x7f),
+                          (e.key>>10)&0x1f, (e.key>>5)&0x1f, e.key&0x1f, long(e.kc), long(e.mc), long(e.nc))>0;
+      }
+      return std::fclose(file)==0 && ok;
+    }
+
+  private:
+    struct Entry
+    {
+      unsigned int key;
+      Index kc, mc, nc;
+      bool operator<(const Entry& other) const { return key<other.key; }
+    };
+
+    static unsigned int key(int lhsId, int rhsId, int depthBucket, int rowsBucket, int colsBucket)
+    {
+      return (unsigned(lhsId&0x7f)<<22) | (unsigned(rhsId&0x7f)<<15)
+           | (unsigned(depthBucket)<<10) | (unsigned(rowsBucket)<<5) | unsigned(colsBucket);
+    }
+
+    std::vector<Entry> m_entries;
+};
+
+/** \internal \returns the table of tuned blocking sizes. It is initially loaded from the file named by the
+  * environment variable \c EIGEN_BLOCKING_SIZES_TABLE, if any, and empty otherwise. */
+inline blocking_sizes_table& tuned_blocking_sizes()
+{
+  static blocking_sizes_table m_table(std::getenv("EIGEN_BLOCKING_SIZES_TABLE"));
+  return m_table;
+}
+
+template<typename LhsScalar, typename RhsScalar, int KcFactor, typename Index>
+inline bool useTunedBlockingSizes(Index& k, Index& m, Index& n, Index num_threads)
+{
+  enum {
+    LhsId = blocking_sizes_scalar_id<LhsScalar>::value,
+    RhsId = blocking_sizes_scalar_id<RhsScalar>::value
+  };
+  // the sizes are tuned for the serial products using the default depth blocking
+  if(LhsId==0 || RhsId==0 || KcFactor!=1 || num_threads!=1)
+    return false;
+  const blocking_sizes_table& table = tuned_blocking_sizes();
+  Index kc, mc, nc;
+  if(table.empty() || !table.find(LhsId, RhsId, k, m, n, kc, mc, nc))
+    return false;
+  k = numext::mini<Index>(k, kc);
+  m = numext::mini<Index>(m, mc);
+  n = numext::mini<Index>(n, nc);
+  return true;
+}
+
 /** \brief Computes the blocking parameters for a m x k times k x n matrix product
   *
   * \param[in,out] k Input: the third dimension of the product. Output: the blocking size along the same dimension.
@@ -331,6 +516,7 @@ inline bool useSpecificBlockingSizes(Index& k, Index& m, Index& n)
   *
   * The blocking size parameters may be evaluated:
   *   - either by a heuristic based on cache sizes;
+  *   - or from the table of sizes tuned for the host, when it has an entry for the product (see calibrateBlockingSizes());
   *   - or using fixed prescribed values (for testing purposes).
   *
   * \sa setCpuCacheSizes */
@@ -338,7 +524,7 @@ inline bool useSpecificBlockingSizes(Index& k, Index& m, Index& n)
 template<typename LhsScalar, typename RhsScalar, int KcFactor, typename Index>
 void computeProductBlockingSizes(Index& k, Index& m, Index& n, Index num_threads = 1)
 {
-  if (!useSpecificBlockingSizes(k, m, n)) {
+  if (!useSpecificBlockingSizes(k, m, n) && !useTunedBlockingSizes<LhsScalar, RhsScalar, KcFactor>(k, m, n, num_threads)) {
     evaluateProductBlockingSizesHeuristic<LhsScalar, RhsScalar, KcFactor, Index>(k, m, n, num_threads);
   }
 }
@@ -1186,6 +1372,23 @@ struct last_row_process_16_packets<LhsScalar, RhsScalar, Index, DataMapper,  mr,
   }
 };
 
+/* Optional architecture specific micro kernel processing 3*LhsProgress x 8 register blocks of res.
+ * It consumes two consecutive nr==4 panels of the packed rhs at once, so that targets with 32 vector
+ * registers can keep 24 accumulators alive without changing the packing format. Specializations set
+ * Enabled to 1 and process the rows [i1,i2) and the columns [0,cols8) of res, cols8 being a multiple of 8,
+ * see arch/AVX512/GeneralBlockPanelKernel.h.
+ */
+template<typename LhsScalar, typename RhsScalar, typename Index, typename DataMapper, bool ConjugateLhs, bool ConjugateRhs>
+struct gebp_micro_kernel_3pX8
+{
+  enum { Enabled = 0 };
+  typedef typename ScalarBinaryOpTraits<LhsScalar, RhsScalar>::ReturnType ResScalar;
+
+  EIGEN_STRONG_INLINE void operator()(const DataMapper&, const LhsScalar*, const RhsScalar*, Index /*i1*/, Index /*i2*/, Index /*cols8*/,
+                                      Index /*depth*/, ResScalar /*alpha*/, Index /*strideA*/, Index /*strideB*/, Index /*offsetA*/, Index /*offsetB*/) const
+  {}
+};
+
 template<int nr, Index LhsProgress, Index RhsProgress, typename LhsScalar, typename RhsScalar, typename ResScalar, typename AccPacket, typename LhsPacket, typename RhsPacket, typename ResPacket, typename GEBPTraits, typename LinearMapper, typename DataMapper>
 struct lhs_process_one_packet
 {
@@ -1441,7 +1644,15 @@ void gebp_kernel<LhsScalar,RhsScalar,Index,DataMapper,mr,nr,ConjugateLhs,Conjuga
       for(Index i1=0; i1<peeled_mc3; i1+=actual_panel_rows)
       {
         const Index actual_panel_end = (std::min)(i1+actual_panel_rows, peeled_mc3);
-        for(Index j2=0; j2<packet_cols4; j2+=nr)
+        Index packet_cols8 = 0;
+        if(gebp_micro_kernel_3pX8<LhsScalar,RhsScalar,Index,DataMapper,ConjugateLhs,ConjugateRhs>::Enabled && nr==4)
+        {
+          // Let the architecture specific kernel process as many blocks of 8 columns as possible.
+          packet_cols8 = (packet_cols4/8)*8;
+          gebp_micro_kernel_3pX8<LhsScalar,RhsScalar,Index,DataMapper,ConjugateLhs,ConjugateRhs>()
+            (res, blockA, blockB, i1, actual_panel_end, packet_cols8, depth, alpha, strideA, strideB, offsetA, offsetB);
+        }
+        for(Index j2=packet_cols8; j2<packet_cols4; j2+=nr)
         {
           for(Index i=i1; i<actual_panel_end; i+=3*LhsProgress)
           {
@@ -2640,6 +2851,21 @@ inline void setCpuCacheSizes(std::ptrdiff_t l1, std::ptrdiff_t l2, std::ptrdiff_
   internal::manage_caching_sizes(SetAction, &l1, &l2, &l3);
 }
 
+/** Replaces the table of blocking sizes tuned for the host by the one stored in the file \a filename,
+  * as written by calibrateBlockingSizes(). The products of matrices whose sizes have no entry in the table
+  * keep using the blocking sizes computed from the cache sizes.
+  *
+  * At startup, the table is loaded from the file named by the environment variable \c EIGEN_BLOCKING_SIZES_TABLE, if any.
+  * This function must not be called while a matrix product is running.
+  *
+  * \returns false, leaving the table empty, if the file cannot be read or is malformed
+  *
+  * \sa calibrateBlockingSizes(), computeProductBlockingSizes */
+inline bool loadBlockingSizesTable(const char* filename)
+{
+  return internal::tuned_blocking_sizes().load(filename);
+}
+
 } // end namespace Eigen
 
 #endif // EIGEN_GENERAL_BLOCK_PANEL_H
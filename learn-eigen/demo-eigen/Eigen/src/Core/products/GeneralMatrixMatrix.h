@@ -16,6 +16,16 @@ namespace internal {
 
 template<typename _LhsScalar, typename _RhsScalar> class level3_blocking;
 
+/** \internal Epilogue of a general matrix product, called on each block of the result right after the block-panel
+  * kernel has written its final value, while it is still in cache. The block is given in the coordinates of the
+  * column-major product actually computed, i.e., transposed for a row-major result. */
+template<typename ResScalar, typename Index>
+struct gemm_epilogue
+{
+  virtual ~gemm_epilogue() {}
+  virtual void operator()(ResScalar* block, Index rows, Index cols, Index stride) const = 0;
+};
+
 /* Specialization for a row-major destination matrix => simple transposition of the product */
 template<
   typename Index,
@@ -34,14 +44,15 @@ struct general_matrix_matrix_product<Index,LhsScalar,LhsStorageOrder,ConjugateLh
     ResScalar* res, Index resIncr, Index resStride,
     ResScalar alpha,
     level3_blocking<RhsScalar,LhsScalar>& blocking,
-    GemmParallelInfo<Index>* info = 0)
+    GemmParallelInfo<Index>* info = 0,
+    const gemm_epilogue<ResScalar,Index>* epilogue = 0)
   {
     // transpose the product such that the result is column major
     general_matrix_matrix_product<Index,
       RhsScalar, RhsStorageOrder==RowMajor ? ColMajor : RowMajor, ConjugateRhs,
       LhsScalar, LhsStorageOrder==RowMajor ? ColMajor : RowMajor, ConjugateLhs,
       ColMajor,ResInnerStride>
-    ::run(cols,rows,depth,rhs,rhsStride,lhs,lhsStride,res,resIncr,resStride,alpha,blocking,info);
+    ::run(cols,rows,depth,rhs,rhsStride,lhs,lhsStride,res,resIncr,resStride,alpha,blocking,info,epilogue);
   }
 };
 
@@ -64,7 +75,8 @@ static void run(Index rows, Index cols, Index depth,
   ResScalar* _res, Index resIncr, Index resStride,
   ResScalar alpha,
   level3_blocking<LhsScalar,RhsScalar>& blocking,
-  GemmParallelInfo<Index>* info = 0)
+  GemmParallelInfo<Index>* info = 0,
+  const gemm_epilogue<ResScalar,Index>* epilogue = 0)
 {
   typedef const_blas_data_mapper<LhsScalar, Index, LhsStorageOrder> LhsMapper;
   typedef const_blas_data_mapper<RhsScalar, Index, RhsStorageOrder> RhsMapper;
@@ -72,6 +84,7 @@ static void run(Index rows, Index cols, Index depth,
   LhsMapper lhs(_lhs, lhsStride);
   RhsMapper rhs(_rhs, rhsStride);
   ResMapper res(_res, resStride, resIncr);
+  eigen_assert(epilogue==0 || resIncr==1);
 
   Index kc = blocking.kc();                   // cache block size along the K direction
   Index mc = (std::min)(rows,blocking.mc());  // cache block size along the M direction
@@ -81,12 +94,13 @@ static void run(Index rows, Index cols, Index depth,
   gemm_pack_rhs<RhsScalar, Index, RhsMapper, Traits::nr, RhsStorageOrder> pack_rhs;
   gebp_kernel<LhsScalar, RhsScalar, Index, ResMapper, Traits::mr, Traits::nr, ConjugateLhs, ConjugateRhs> gebp;
 
-#ifdef EIGEN_HAS_OPENMP
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
   if(info)
   {
     // this is the parallel version!
-    int tid = omp_get_thread_num();
-    int threads = omp_get_num_threads();
+    Index tid = info->logical_thread_id;
+    Index threads = info->num_threads;
+    GemmParallelTaskInfo<Index>* task_info = info->task_info;
 
     LhsScalar* blockA = blocking.blockA();
     eigen_internal_assert(blockA!=0);
@@ -101,7 +115,10 @@ static void run(Index rows, Index cols, Index depth,
 
       // In order to reduce the chance that a thread has to wait for the other,
       // let's start by packing B'.
-      pack_rhs(blockB, rhs.getSubMapper(k,0), actual_kc, nc);
+      {
+        EIGEN_INSTRUMENT_KERNEL(InstrumentGemmPackRhs, 0);
+        pack_rhs(blockB, rhs.getSubMapper(k,0), actual_kc, nc);
+      }
 
       // Pack A_k to A' in a parallel fashion:
       // each thread packs the sub block A_k,i to A'_i where i is the thread id.
@@ -109,28 +126,37 @@ static void run(Index rows, Index cols, Index depth,
       // However, before copying to A'_i, we have to make sure that no other thread is still using it,
       // i.e., we test that info[tid].users equals 0.
       // Then, we set info[tid].users to the number of threads to mark that all other threads are going to use it.
-      while(info[tid].users!=0) {}
-      info[tid].users = threads;
+      while(task_info[tid].users!=0) {}
+      task_info[tid].users = int(threads);
 
-      pack_lhs(blockA+info[tid].lhs_start*actual_kc, lhs.getSubMapper(info[tid].lhs_start,k), actual_kc, info[tid].lhs_length);
+      {
+        EIGEN_INSTRUMENT_KERNEL(InstrumentGemmPackLhs, 0);
+        pack_lhs(blockA+task_info[tid].lhs_start*actual_kc, lhs.getSubMapper(task_info[tid].lhs_start,k), actual_kc, task_info[tid].lhs_length);
+      }
 
       // Notify the other threads that the part A'_i is ready to go.
-      info[tid].sync = k;
+      task_info[tid].sync = k;
 
       // Computes C_i += A' * B' per A'_i
-      for(int shift=0; shift<threads; ++shift)
+      for(Index shift=0; shift<threads; ++shift)
       {
-        int i = (tid+shift)%threads;
+        Index i = (tid+shift)%threads;
 
         // At this point we have to make sure that A'_i has been updated by the thread i,
         // we use testAndSetOrdered to mimic a volatile access.
         // However, no need to wait for the B' part which has been updated by the current thread!
         if (shift>0) {
-          while(info[i].sync!=k) {
+          while(task_info[i].sync!=k) {
           }
         }
 
-        gebp(res.getSubMapper(info[i].lhs_start, 0), blockA+info[i].lhs_start*actual_kc, blockB, info[i].lhs_length, actual_kc, nc, alpha);
+        {
+          EIGEN_INSTRUMENT_KERNEL(InstrumentGebp, 2.0*double(task_info[i].lhs_length)*double(actual_kc)*double(nc));
+          gebp(res.getSubMapper(task_info[i].lhs_start, 0), blockA+task_info[i].lhs_start*actual_kc, blockB, task_info[i].lhs_length, actual_kc, nc, alpha);
+        }
+
+        if(epilogue && k+actual_kc==depth)
+          (*epilogue)(_res+task_info[i].lhs_start, task_info[i].lhs_length, nc, resStride);
       }
 
       // Then keep going as usual with the remaining B'
@@ -139,10 +165,19 @@ static void run(Index rows, Index cols, Index depth,
         const Index actual_nc = (std::min)(j+nc,cols)-j;
 
         // pack B_k,j to B'
-        pack_rhs(blockB, rhs.getSubMapper(k,j), actual_kc, actual_nc);
+        {
+          EIGEN_INSTRUMENT_KERNEL(InstrumentGemmPackRhs, 0);
+          pack_rhs(blockB, rhs.getSubMapper(k,j), actual_kc, actual_nc);
+        }
 
         // C_j += A' * B'
-        gebp(res.getSubMapper(0, j), blockA, blockB, rows, actual_kc, actual_nc, alpha);
+        {
+          EIGEN_INSTRUMENT_KERNEL(InstrumentGebp, 2.0*double(rows)*double(actual_kc)*double(actual_nc));
+          gebp(res.getSubMapper(0, j), blockA, blockB, rows, actual_kc, actual_nc, alpha);
+        }
+
+        if(epilogue && k+actual_kc==depth)
+          (*epilogue)(_res+j*resStride, rows, actual_nc, resStride);
       }
 
       // Release all the sub blocks A'_i of A' for the current thread,
@@ -151,11 +186,11 @@ static void run(Index rows, Index cols, Index depth,
 #if !EIGEN_HAS_CXX11_ATOMIC
         #pragma omp atomic
 #endif
-        info[i].users -= 1;
+        task_info[i].users -= 1;
     }
   }
   else
-#endif // EIGEN_HAS_OPENMP
+#endif // EIGEN_HAS_OPENMP || EIGEN_HAS_GEMM_THREADPOOL
   {
     EIGEN_UNUSED_VARIABLE(info);
 
@@ -181,7 +216,10 @@ static void run(Index rows, Index cols, Index depth,
         // => Pack lhs's panel into a sequential chunk of memory (L2/L3 caching)
         // Note that this panel will be read as many times as the number of blocks in the rhs's
         // horizontal panel which is, in practice, a very low number.
-        pack_lhs(blockA, lhs.getSubMapper(i2,k2), actual_kc, actual_mc);
+        {
+          EIGEN_INSTRUMENT_KERNEL(InstrumentGemmPackLhs, 0);
+          pack_lhs(blockA, lhs.getSubMapper(i2,k2), actual_kc, actual_mc);
+        }
 
         // For each kc x nc block of the rhs's horizontal panel...
         for(Index j2=0; j2<cols; j2+=nc)
@@ -192,10 +230,20 @@ static void run(Index rows, Index cols, Index depth,
           // Note that this block will be read a very high number of times, which is equal to the number of
           // micro horizontal panel of the large rhs's panel (e.g., rows/12 times).
           if((!pack_rhs_once) || i2==0)
+          {
+            EIGEN_INSTRUMENT_KERNEL(InstrumentGemmPackRhs, 0);
             pack_rhs(blockB, rhs.getSubMapper(k2,j2), actual_kc, actual_nc);
+          }
 
           // Everything is packed, we can now call the panel * block kernel:
-          gebp(res.getSubMapper(i2, j2), blockA, blockB, actual_mc, actual_kc, actual_nc, alpha);
+          {
+            EIGEN_INSTRUMENT_KERNEL(InstrumentGebp, 2.0*double(actual_mc)*double(actual_kc)*double(actual_nc));
+            gebp(res.getSubMapper(i2, j2), blockA, blockB, actual_mc, actual_kc, actual_nc, alpha);
+          }
+
+          // the block of the result is final after the last panel of the depth: hand it to the epilogue
+          if(epilogue && k2+actual_kc==depth)
+            (*epilogue)(_res+i2+j2*resStride, actual_mc, actual_nc, resStride);
         }
       }
     }
@@ -212,8 +260,9 @@ static void run(Index rows, Index cols, Index depth,
 template<typename Scalar, typename Index, typename Gemm, typename Lhs, typename Rhs, typename Dest, typename BlockingType>
 struct gemm_functor
 {
-  gemm_functor(const Lhs& lhs, const Rhs& rhs, Dest& dest, const Scalar& actualAlpha, BlockingType& blocking)
-    : m_lhs(lhs), m_rhs(rhs), m_dest(dest), m_actualAlpha(actualAlpha), m_blocking(blocking)
+  gemm_functor(const Lhs& lhs, const Rhs& rhs, Dest& dest, const Scalar& actualAlpha, BlockingType& blocking,
+               const gemm_epilogue<Scalar,Index>* epilogue = 0)
+    : m_lhs(lhs), m_rhs(rhs), m_dest(dest), m_actualAlpha(actualAlpha), m_blocking(blocking), m_epilogue(epilogue)
   {}
 
   void initParallelSession(Index num_threads) const
@@ -231,7 +280,7 @@ struct gemm_functor
               &m_lhs.coeffRef(row,0), m_lhs.outerStride(),
               &m_rhs.coeffRef(0,col), m_rhs.outerStride(),
               (Scalar*)&(m_dest.coeffRef(row,col)), m_dest.innerStride(), m_dest.outerStride(),
-              m_actualAlpha, m_blocking, info);
+              m_actualAlpha, m_blocking, info, m_epilogue);
   }
 
   typedef typename Gemm::Traits Traits;
@@ -242,6 +291,7 @@ struct gemm_functor
     Dest& m_dest;
     Scalar m_actualAlpha;
     BlockingType& m_blocking;
+    const gemm_epilogue<Scalar,Index>* m_epilogue;
 };
 
 template<int StorageOrder, typename LhsScalar, typename RhsScalar, int MaxRows, int MaxCols, int MaxDepth, int KcFactor=1,
@@ -380,13 +430,13 @@ class gemm_blocking_space<StorageOrder,_LhsScalar,_RhsScalar,MaxRows, MaxCols, M
     void allocateA()
     {
       if(this->m_blockA==0)
-        this->m_blockA = aligned_new<LhsScalar>(m_sizeA);
+        this->m_blockA = scratch_new<LhsScalar>(m_sizeA);
     }
 
     void allocateB()
     {
       if(this->m_blockB==0)
-        this->m_blockB = aligned_new<RhsScalar>(m_sizeB);
+        this->m_blockB = scratch_new<RhsScalar>(m_sizeB);
     }
 
     void allocateAll()
@@ -397,8 +447,9 @@ class gemm_blocking_space<StorageOrder,_LhsScalar,_RhsScalar,MaxRows, MaxCols, M
 
     ~gemm_blocking_space()
     {
-      aligned_delete(this->m_blockA, m_sizeA);
-      aligned_delete(this->m_blockB, m_sizeB);
+      // in the reverse order of the allocations, for the scratch arena
+      scratch_delete(this->m_blockB, m_sizeB);
+      scratch_delete(this->m_blockA, m_sizeA);
     }
 };
 
@@ -406,6 +457,79 @@ class gemm_blocking_space<StorageOrder,_LhsScalar,_RhsScalar,MaxRows, MaxCols, M
 
 namespace internal {
 
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+/* Matrix * matrix product computed by the kernel selected at runtime (see RuntimeDispatch.h), the result
+ * being column-major. The kernel is serial: the columns of the result are split into one block per thread,
+ * each block being computed by its own call to the kernel. run() returns false when there is no such
+ * kernel for these scalar types.
+ */
+template<typename LhsScalar, typename RhsScalar, typename ResScalar, typename Index,
+         bool Supported = dispatch_traits<ResScalar>::Supported!=0 && is_same<LhsScalar,ResScalar>::value
+                       && is_same<RhsScalar,ResScalar>::value>
+struct dispatched_gemm
+{
+  template<typename L, typename R>
+  static bool run(Index, Index, Index, const L*, Index, bool, const R*, Index, bool, ResScalar*, Index, const ResScalar&)
+  { return false; }
+};
+
+template<typename LhsScalar, typename RhsScalar, typename Scalar, typename Index>
+struct dispatched_gemm<LhsScalar,RhsScalar,Scalar,Index,true>
+{
+  typedef typename dispatch_traits<Scalar>::Gemm Gemm;
+
+  // computes the t-th block of columns of the result
+  struct Task
+  {
+    Task(Gemm gemm, Index threads, Index blockCols, Index rows, Index cols, Index depth,
+         const Scalar* lhs, Index lhsStride, bool lhsRowMajor, const Scalar* rhs, Index rhsStride, bool rhsRowMajor,
+         Scalar* res, Index resStride, const Scalar& alpha)
+      : m_gemm(gemm), m_threads(threads), m_blockCols(blockCols), m_rows(rows), m_cols(cols), m_depth(depth),
+        m_lhs(lhs), m_lhsStride(lhsStride), m_lhsRowMajor(lhsRowMajor), m_rhs(rhs), m_rhsStride(rhsStride), m_rhsRowMajor(rhsRowMajor),
+        m_res(res), m_resStride(resStride), m_alpha(alpha)
+    {}
+
+    void operator()(Index t) const
+    {
+      const Index start = t*m_blockCols;
+      const Index length = (t+1==m_threads) ? m_cols-start : m_blockCols;
+      m_gemm(m_rows, length, m_depth, m_lhs, m_lhsStride, m_lhsRowMajor,
+             m_rhs + start*(m_rhsRowMajor ? Index(1) : m_rhsStride), m_rhsStride, m_rhsRowMajor,
+             m_res + start*m_resStride, m_resStride, m_alpha);
+    }
+
+    const Gemm m_gemm;
+    const Index m_threads, m_blockCols, m_rows, m_cols, m_depth;
+    const Scalar* m_lhs;
+    const Index m_lhsStride;
+    const bool m_lhsRowMajor;
+    const Scalar* m_rhs;
+    const Index m_rhsStride;
+    const bool m_rhsRowMajor;
+    Scalar* m_res;
+    const Index m_resStride;
+    const Scalar m_alpha;
+  };
+
+  static bool run(Index rows, Index cols, Index depth,
+                  const Scalar* lhs, Index lhsStride, bool lhsRowMajor,
+                  const Scalar* rhs, Index rhsStride, bool rhsRowMajor,
+                  Scalar* res, Index resStride, const Scalar& alpha)
+  {
+    const eigen_dispatch_kernels* kernels = dispatch_kernels();
+    if(kernels==0)
+      return false;
+    // same minimal amount of work per thread as parallelize_gemm, and at least 16 columns per block
+    const Index threads = parallel_product_threads(static_cast<double>(rows) * static_cast<double>(cols) * static_cast<double>(depth),
+                                                   cols/16, 50000.0);
+    const Index blockCols = (cols/threads) & ~Index(0x3);
+    parallel_product_run(threads, Task(dispatch_traits<Scalar>::gemm(*kernels), threads, blockCols, rows, cols, depth,
+                                       lhs, lhsStride, lhsRowMajor, rhs, rhsStride, rhsRowMajor, res, resStride, alpha));
+    return true;
+  }
+};
+#endif
+
 template<typename Lhs, typename Rhs>
 struct generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct>
   : generic_product_impl_base<Lhs,Rhs,generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct> >
@@ -464,26 +588,42 @@ struct generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct>
       scaleAndAddTo(dst, lhs, rhs, Scalar(-1));
   }
 
+  // Calls the epilogue of a product on the whole result, when it has not been computed by blocks
   template<typename Dest>
-  static void scaleAndAddTo(Dest& dst, const Lhs& a_lhs, const Rhs& a_rhs, const Scalar& alpha)
+  static void applyEpilogue(Dest& dst, const gemm_epilogue<Scalar,Index>* epilogue)
+  {
+    if(epilogue==0)
+      return;
+    if(Dest::Flags&RowMajorBit)
+      (*epilogue)(dst.data(), dst.cols(), dst.rows(), dst.outerStride());
+    else
+      (*epilogue)(dst.data(), dst.rows(), dst.cols(), dst.outerStride());
+  }
+
+  template<typename Dest>
+  static void scaleAndAddTo(Dest& dst, const Lhs& a_lhs, const Rhs& a_rhs, const Scalar& alpha,
+                            const gemm_epilogue<Scalar,Index>* epilogue = 0)
   {
     eigen_assert(dst.rows()==a_lhs.rows() && dst.cols()==a_rhs.cols());
+    eigen_assert(epilogue==0 || dst.innerStride()==1);
     if(a_lhs.cols()==0 || a_lhs.rows()==0 || a_rhs.cols()==0)
-      return;
+      return applyEpilogue(dst, epilogue);
 
     if (dst.cols() == 1)
     {
       // Fallback to GEMV if either the lhs or rhs is a runtime vector
       typename Dest::ColXpr dst_vec(dst.col(0));
-      return internal::generic_product_impl<Lhs,typename Rhs::ConstColXpr,DenseShape,DenseShape,GemvProduct>
+      internal::generic_product_impl<Lhs,typename Rhs::ConstColXpr,DenseShape,DenseShape,GemvProduct>
         ::scaleAndAddTo(dst_vec, a_lhs, a_rhs.col(0), alpha);
+      return applyEpilogue(dst, epilogue);
     }
     else if (dst.rows() == 1)
     {
       // Fallback to GEMV if either the lhs or rhs is a runtime vector
       typename Dest::RowXpr dst_vec(dst.row(0));
-      return internal::generic_product_impl<typename Lhs::ConstRowXpr,Rhs,DenseShape,DenseShape,GemvProduct>
+      internal::generic_product_impl<typename Lhs::ConstRowXpr,Rhs,DenseShape,DenseShape,GemvProduct>
         ::scaleAndAddTo(dst_vec, a_lhs.row(0), a_rhs, alpha);
+      return applyEpilogue(dst, epilogue);
     }
 
     typename internal::add_const_on_value_type<ActualLhsType>::type lhs = LhsBlasTraits::extract(a_lhs);
@@ -491,6 +631,24 @@ struct generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct>
 
     Scalar actualAlpha = combine_scalar_factors(alpha, a_lhs, a_rhs);
 
+    EIGEN_INSTRUMENT_KERNEL(InstrumentGemm, 2.0*double(dst.rows())*double(dst.cols())*double(a_lhs.cols()));
+
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+    {
+      typedef internal::dispatched_gemm<LhsScalar,RhsScalar,typename Dest::Scalar,Index> DispatchedGemm;
+      const bool lhsRowMajor = ActualLhsTypeCleaned::Flags&RowMajorBit;
+      const bool rhsRowMajor = ActualRhsTypeCleaned::Flags&RowMajorBit;
+      // a row-major result is computed as the column-major transposed product rhs^T * lhs^T
+      if(dst.innerStride()==1
+         && ((Dest::Flags&RowMajorBit)
+             ? DispatchedGemm::run(dst.cols(), dst.rows(), lhs.cols(), rhs.data(), rhs.outerStride(), !rhsRowMajor,
+                                   lhs.data(), lhs.outerStride(), !lhsRowMajor, dst.data(), dst.outerStride(), actualAlpha)
+             : DispatchedGemm::run(dst.rows(), dst.cols(), lhs.cols(), lhs.data(), lhs.outerStride(), lhsRowMajor,
+                                   rhs.data(), rhs.outerStride(), rhsRowMajor, dst.data(), dst.outerStride(), actualAlpha)))
+        return applyEpilogue(dst, epilogue);
+    }
+#endif
+
     typedef internal::gemm_blocking_space<(Dest::Flags&RowMajorBit) ? RowMajor : ColMajor,LhsScalar,RhsScalar,
             Dest::MaxRowsAtCompileTime,Dest::MaxColsAtCompileTime,MaxDepthAtCompileTime> BlockingType;
 
@@ -506,7 +664,7 @@ struct generic_product_impl<Lhs,Rhs,DenseShape,DenseShape,GemmProduct>
 
     BlockingType blocking(dst.rows(), dst.cols(), lhs.cols(), 1, true);
     internal::parallelize_gemm<(Dest::MaxRowsAtCompileTime>32 || Dest::MaxRowsAtCompileTime==Dynamic)>
-        (GemmFunctor(lhs, rhs, dst, actualAlpha, blocking), a_lhs.rows(), a_rhs.cols(), a_lhs.cols(), Dest::Flags&RowMajorBit);
+        (GemmFunctor(lhs, rhs, dst, actualAlpha, blocking, epilogue), a_lhs.rows(), a_rhs.cols(), a_lhs.cols(), Dest::Flags&RowMajorBit);
   }
 };
 
@@ -0,0 +1,121 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_GENERAL_MATRIX_MATRIX_BATCHED_H
+#define EIGEN_GENERAL_MATRIX_MATRIX_BATCHED_H
+
+namespace Eigen {
+
+namespace internal {
+
+/* Batched product of small matrices stored in the MatrixBatch layout.
+ *
+ * The batch is divided into groups of PacketSize matrices. Within a group, the PacketSize values of a
+ * given coefficient are contiguous, so that a packet holds one coefficient of PacketSize independent
+ * matrices, and the product is computed with exactly the scalar algorithm, one matrix per lane.
+ * A group of lhs (resp. rhs, res) matrices spans Rows*Depth (resp. Depth*Cols, Rows*Cols) packets
+ * stored in column-major order.
+ *
+ * The compile-time sizes are forwarded so that the loops are fully unrolled for fixed-size matrices.
+ */
+template<typename Scalar, typename Index, int Rows, int Cols, int Depth>
+struct batched_gemm_functor
+{
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum { PacketSize = packet_traits<Scalar>::size };
+
+  batched_gemm_functor(const Scalar* lhs, const Scalar* rhs, Scalar* res, Index rows, Index cols, Index depth)
+    : m_lhs(lhs), m_rhs(rhs), m_res(res), m_rows(rows), m_cols(cols), m_depth(depth)
+  {}
+
+  // computes the products of the group of matrices g
+  EIGEN_STRONG_INLINE void operator()(Index g) const
+  {
+    const Index rows = m_rows.value();
+    const Index cols = m_cols.value();
+    const Index depth = m_depth.value();
+    const Scalar* lhs = m_lhs + g*rows*depth*PacketSize;
+    const Scalar* rhs = m_rhs + g*depth*cols*PacketSize;
+    Scalar* res = m_res + g*rows*cols*PacketSize;
+
+    const Index peeled_rows = (rows/4)*4;
+    for(Index j=0; j<cols; ++j)
+    {
+      const Scalar* b = rhs + j*depth*PacketSize;
+      Scalar* r = res + j*rows*PacketSize;
+      // 4 independent accumulators hide the latency of the multiply-adds
+      for(Index i=0; i<peeled_rows; i+=4)
+      {
+        Packet c0 = pset1<Packet>(Scalar(0)), c1 = c0, c2 = c0, c3 = c0;
+        for(Index k=0; k<depth; ++k)
+        {
+          const Packet bk = pload<Packet>(b + k*PacketSize);
+          const Scalar* a = lhs + (k*rows+i)*PacketSize;
+          c0 = pmadd(pload<Packet>(a + 0*PacketSize), bk, c0);
+          c1 = pmadd(pload<Packet>(a + 1*PacketSize), bk, c1);
+          c2 = pmadd(pload<Packet>(a + 2*PacketSize), bk, c2);
+          c3 = pmadd(pload<Packet>(a + 3*PacketSize), bk, c3);
+        }
+        pstore(r + (i+0)*PacketSize, c0);
+        pstore(r + (i+1)*PacketSize, c1);
+        pstore(r + (i+2)*PacketSize, c2);
+        pstore(r + (i+3)*PacketSize, c3);
+      }
+      for(Index i=peeled_rows; i<rows; ++i)
+      {
+        Packet c0 = pset1<Packet>(Scalar(0));
+        for(Index k=0; k<depth; ++k)
+          c0 = pmadd(pload<Packet>(lhs + (k*rows+i)*PacketSize), pload<Packet>(b + k*PacketSize), c0);
+        pstore(r + i*PacketSize, c0);
+      }
+    }
+  }
+
+  const Scalar* m_lhs;
+  const Scalar* m_rhs;
+  Scalar* m_res;
+  const variable_if_dynamic<Index,Rows> m_rows;
+  const variable_if_dynamic<Index,Cols> m_cols;
+  const variable_if_dynamic<Index,Depth> m_depth;
+};
+
+template<typename Scalar, typename Index, int Rows, int Cols, int Depth>
+void batched_gemm(const Scalar* lhs, const Scalar* rhs, Scalar* res, Index rows, Index cols, Index depth, Index groups)
+{
+  typedef batched_gemm_functor<Scalar,Index,Rows,Cols,Depth> Functor;
+  Functor func(lhs, rhs, res, rows, cols, depth);
+
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
+  // do not spawn threads for less than about 50k multiply-adds per thread
+  const Index work = groups * rows * cols * depth * Index(Functor::PacketSize);
+  const Index threads = (std::min)(Index(nbThreads()), (std::max)(Index(1), work / Index(50000)));
+  if(threads>1)
+  {
+#if defined(EIGEN_HAS_GEMM_THREADPOOL)
+    parallel_for_dynamic(groups, threads, (groups+threads*4-1)/(threads*4), func);
+#else
+    EIGEN_INSTRUMENT_CAPTURE_SCOPE(scope);
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for(Index g=0; g<groups; ++g)
+    {
+      EIGEN_INSTRUMENT_ADOPT_SCOPE(scope);
+      func(g);
+    }
+#endif
+    return;
+  }
+#endif
+
+  for(Index g=0; g<groups; ++g)
+    func(g);
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_GENERAL_MATRIX_MATRIX_BATCHED_H
@@ -0,0 +1,199 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_GENERAL_MATRIX_MATRIX_PACKED_H
+#define EIGEN_GENERAL_MATRIX_MATRIX_PACKED_H
+
+namespace Eigen {
+
+namespace internal {
+
+/* Product of a matrix that has been packed once into the gebp panel layout with a plain matrix.
+ *
+ * The packed operand is stored as a sequence of depth blocks of kc rows (rhs) or kc columns (lhs).
+ * Each depth block holds the whole packed operand as gemm_pack_lhs/gemm_pack_rhs would produce it,
+ * and starts on an aligned boundary. Since the packing of the first i rows (resp. columns) does not
+ * depend on the remaining ones as long as i is a multiple of mr (resp. nr), a row (resp. column)
+ * range of the result can be computed by simply offsetting into a depth block.
+ */
+template<typename Scalar, typename Index, int Side> struct general_matrix_matrix_product_packed;
+
+template<typename Scalar, typename Index>
+struct general_matrix_matrix_product_packed_base
+{
+  typedef gebp_traits<Scalar,Scalar> Traits;
+  typedef blas_data_mapper<Scalar, Index, ColMajor> ResMapper;
+
+  // number of coefficients between two consecutive depth blocks of kc x size coefficients
+  static Index blockStride(Index kc, Index size)
+  {
+    const Index align = (std::max)(Index(1), Index(EIGEN_MAX_ALIGN_BYTES/sizeof(Scalar)));
+    return ((kc*size + align - 1) / align) * align;
+  }
+
+  static Index packedSize(Index depth, Index kc, Index size)
+  {
+    if(depth==0 || size==0)
+      return 0;
+    const Index full_blocks = (depth-1) / kc;
+    return full_blocks * blockStride(kc,size) + (depth - full_blocks*kc) * size;
+  }
+
+  // the depth block size chosen at packing time, see computeProductBlockingSizes
+  static Index blockingDepth(Index depth, Index size)
+  {
+    Index kc = depth, mc = size, nc = size;
+    computeProductBlockingSizes<Scalar,Scalar>(kc, mc, nc);
+    return (std::max)(Index(1), kc);
+  }
+};
+
+// the packed matrix is the lhs: res += alpha * A' * rhs
+template<typename Scalar, typename Index>
+struct general_matrix_matrix_product_packed<Scalar,Index,OnTheLeft>
+  : general_matrix_matrix_product_packed_base<Scalar,Index>
+{
+  typedef general_matrix_matrix_product_packed_base<Scalar,Index> Base;
+  typedef typename Base::Traits Traits;
+  typedef typename Base::ResMapper ResMapper;
+
+  template<int LhsStorageOrder>
+  static void pack(Scalar* packed, Index kc, const Scalar* _lhs, Index lhsStride, Index rows, Index depth)
+  {
+    typedef const_blas_data_mapper<Scalar, Index, LhsStorageOrder> LhsMapper;
+    LhsMapper lhs(_lhs, lhsStride);
+    gemm_pack_lhs<Scalar, Index, LhsMapper, Traits::mr, Traits::LhsProgress, typename Traits::LhsPacket4Packing, LhsStorageOrder> pack_lhs;
+
+    const Index stride = Base::blockStride(kc, rows);
+    for(Index k2=0; k2<depth; k2+=kc)
+    {
+      const Index actual_kc = (std::min)(k2+kc,depth)-k2;
+      pack_lhs(packed + (k2/kc)*stride, lhs.getSubMapper(0,k2), actual_kc, rows);
+    }
+  }
+
+  template<int RhsStorageOrder>
+  static void run(Index rows, Index cols, Index depth,
+                  const Scalar* packedA, Index kc,
+                  const Scalar* _rhs, Index rhsStride,
+                  Scalar* _res, Index resStride,
+                  Scalar alpha)
+  {
+    typedef const_blas_data_mapper<Scalar, Index, RhsStorageOrder> RhsMapper;
+    RhsMapper rhs(_rhs, rhsStride);
+    ResMapper res(_res, resStride);
+
+    Index kc_dummy = depth, mc = rows, nc = cols;
+    computeProductBlockingSizes<Scalar,Scalar>(kc_dummy, mc, nc);
+    // row blocks must start on a packed panel of A'
+    mc = (std::max)(Index(Traits::mr), mc - mc%Index(Traits::mr));
+    nc = (std::min)(cols, nc);
+
+    gemm_pack_rhs<Scalar, Index, RhsMapper, Traits::nr, RhsStorageOrder> pack_rhs;
+    gebp_kernel<Scalar, Scalar, Index, ResMapper, Traits::mr, Traits::nr, false, false> gebp;
+
+    std::size_t sizeB = kc*nc;
+    ei_declare_aligned_stack_constructed_variable(Scalar, blockB, sizeB, 0);
+
+    const Index stride = Base::blockStride(kc, rows);
+    for(Index k2=0; k2<depth; k2+=kc)
+    {
+      const Index actual_kc = (std::min)(k2+kc,depth)-k2;
+      const Scalar* blockA = packedA + (k2/kc)*stride;
+
+      for(Index j2=0; j2<cols; j2+=nc)
+      {
+        const Index actual_nc = (std::min)(j2+nc,cols)-j2;
+
+        // only the plain operand has to be packed, A' is read as is
+        pack_rhs(blockB, rhs.getSubMapper(k2,j2), actual_kc, actual_nc);
+
+        for(Index i2=0; i2<rows; i2+=mc)
+        {
+          const Index actual_mc = (std::min)(i2+mc,rows)-i2;
+          gebp(res.getSubMapper(i2, j2), blockA + i2*actual_kc, blockB, actual_mc, actual_kc, actual_nc, alpha);
+        }
+      }
+    }
+  }
+};
+
+// the packed matrix is the rhs: res += alpha * lhs * B'
+template<typename Scalar, typename Index>
+struct general_matrix_matrix_product_packed<Scalar,Index,OnTheRight>
+  : general_matrix_matrix_product_packed_base<Scalar,Index>
+{
+  typedef general_matrix_matrix_product_packed_base<Scalar,Index> Base;
+  typedef typename Base::Traits Traits;
+  typedef typename Base::ResMapper ResMapper;
+
+  template<int RhsStorageOrder>
+  static void pack(Scalar* packed, Index kc, const Scalar* _rhs, Index rhsStride, Index depth, Index cols)
+  {
+    typedef const_blas_data_mapper<Scalar, Index, RhsStorageOrder> RhsMapper;
+    RhsMapper rhs(_rhs, rhsStride);
+    gemm_pack_rhs<Scalar, Index, RhsMapper, Traits::nr, RhsStorageOrder> pack_rhs;
+
+    const Index stride = Base::blockStride(kc, cols);
+    for(Index k2=0; k2<depth; k2+=kc)
+    {
+      const Index actual_kc = (std::min)(k2+kc,depth)-k2;
+      pack_rhs(packed + (k2/kc)*stride, rhs.getSubMapper(k2,0), actual_kc, cols);
+    }
+  }
+
+  template<int LhsStorageOrder>
+  static void run(Index rows, Index cols, Index depth,
+                  const Scalar* _lhs, Index lhsStride,
+                  const Scalar* packedB, Index kc,
+                  Scalar* _res, Index resStride,
+                  Scalar alpha)
+  {
+    typedef const_blas_data_mapper<Scalar, Index, LhsStorageOrder> LhsMapper;
+    LhsMapper lhs(_lhs, lhsStride);
+    ResMapper res(_res, resStride);
+
+    Index kc_dummy = depth, mc = rows, nc = cols;
+    computeProductBlockingSizes<Scalar,Scalar>(kc_dummy, mc, nc);
+    mc = (std::min)(rows, mc);
+    // column blocks must start on a packed panel of B'
+    nc = (std::max)(Index(Traits::nr), nc - nc%Index(Traits::nr));
+
+    gemm_pack_lhs<Scalar, Index, LhsMapper, Traits::mr, Traits::LhsProgress, typename Traits::LhsPacket4Packing, LhsStorageOrder> pack_lhs;
+    gebp_kernel<Scalar, Scalar, Index, ResMapper, Traits::mr, Traits::nr, false, false> gebp;
+
+    std::size_t sizeA = kc*mc;
+    ei_declare_aligned_stack_constructed_variable(Scalar, blockA, sizeA, 0);
+
+    const Index stride = Base::blockStride(kc, cols);
+    for(Index i2=0; i2<rows; i2+=mc)
+    {
+      const Index actual_mc = (std::min)(i2+mc,rows)-i2;
+
+      for(Index k2=0; k2<depth; k2+=kc)
+      {
+        const Index actual_kc = (std::min)(k2+kc,depth)-k2;
+        const Scalar* blockB = packedB + (k2/kc)*stride;
+
+        // only the plain operand has to be packed, B' is read as is
+        pack_lhs(blockA, lhs.getSubMapper(i2,k2), actual_kc, actual_mc);
+
+        for(Index j2=0; j2<cols; j2+=nc)
+        {
+          const Index actual_nc = (std::min)(j2+nc,cols)-j2;
+          gebp(res.getSubMapper(i2, j2), blockA, blockB + j2*actual_kc, actual_mc, actual_kc, actual_nc, alpha);
+        }
+      }
+    }
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_GENERAL_MATRIX_MATRIX_PACKED_H
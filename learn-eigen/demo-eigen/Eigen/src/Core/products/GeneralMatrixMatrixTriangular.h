@@ -193,6 +193,101 @@ struct tribb_kernel
   }
 };
 
+/* Multi-threaded matrix-matrix product evaluating only one triangular half.
+ *
+ * The columns of the result are split into one block per thread. The block of columns [c0,c1) of the lower
+ * (resp. upper) half is made of its diagonal block, computed by general_matrix_matrix_triangular_product,
+ * and of the rectangular block below (resp. above) it, computed by general_matrix_matrix_product.
+ * As the amount of work per column decreases (resp. increases) linearly, the boundaries of the blocks are
+ * chosen such that each of them covers the same area of the triangular half.
+ */
+template <typename Index, typename LhsScalar, int LhsStorageOrder, bool ConjugateLhs,
+                          typename RhsScalar, int RhsStorageOrder, bool ConjugateRhs,
+                          int ResStorageOrder, int ResInnerStride, int UpLo>
+struct parallel_general_matrix_matrix_triangular_product
+{
+  typedef typename ScalarBinaryOpTraits<LhsScalar, RhsScalar>::ReturnType ResScalar;
+  typedef gebp_traits<LhsScalar,RhsScalar> Traits;
+  typedef gemm_blocking_space<ResStorageOrder,LhsScalar,RhsScalar,Dynamic,Dynamic,Dynamic> BlockingType;
+  typedef general_matrix_matrix_triangular_product<Index,LhsScalar,LhsStorageOrder,ConjugateLhs,RhsScalar,RhsStorageOrder,ConjugateRhs,
+                                                   ResStorageOrder,ResInnerStride,UpLo> TriangularProduct;
+  typedef general_matrix_matrix_product<Index,LhsScalar,LhsStorageOrder,ConjugateLhs,RhsScalar,RhsStorageOrder,ConjugateRhs,
+                                        ResStorageOrder,ResInnerStride> GeneralProduct;
+
+  // computes the t-th of threads blocks of columns
+  struct Task
+  {
+    Task(Index threads, Index size, Index depth, const LhsScalar* lhs, Index lhsStride, const RhsScalar* rhs, Index rhsStride,
+         ResScalar* res, Index resIncr, Index resStride, const ResScalar& alpha)
+      : m_threads(threads), m_size(size), m_depth(depth), m_lhs(lhs), m_lhsStride(lhsStride), m_rhs(rhs), m_rhsStride(rhsStride),
+        m_res(res), m_resIncr(resIncr), m_resStride(resStride), m_alpha(alpha)
+    {}
+
+    // first column of the t-th block, such that the columns [0,c) cover a fraction t/threads of the triangular half
+    Index boundary(Index t) const
+    {
+      if(t==m_threads)
+        return m_size;
+      const double f = static_cast<double>(t) / static_cast<double>(m_threads);
+      const double c = static_cast<double>(m_size) * (UpLo==Lower ? 1. - std::sqrt(1. - f) : std::sqrt(f));
+      return (std::min)(m_size, static_cast<Index>(c) / Traits::nr * Traits::nr);
+    }
+
+    void operator()(Index t) const
+    {
+      const Index c0 = boundary(t);
+      const Index c1 = boundary(t+1);
+      const Index cols = c1-c0;
+      if(cols<=0)
+        return;
+
+      BlockingType diagBlocking(cols, cols, m_depth, 1, false);
+      TriangularProduct::run(cols, m_depth, lhs(c0), m_lhsStride, rhs(c0), m_rhsStride, res(c0,c0), m_resIncr, m_resStride,
+                             m_alpha, diagBlocking);
+
+      const Index r0 = UpLo==Lower ? c1 : 0;
+      const Index rows = UpLo==Lower ? m_size-c1 : c0;
+      if(rows>0)
+      {
+        BlockingType blocking(rows, cols, m_depth, 1, false);
+        GeneralProduct::run(rows, cols, m_depth, lhs(r0), m_lhsStride, rhs(c0), m_rhsStride, res(r0,c0), m_resIncr, m_resStride,
+                            m_alpha, blocking, 0);
+      }
+    }
+
+    const LhsScalar* lhs(Index i) const { return m_lhs + (LhsStorageOrder==RowMajor ? i*m_lhsStride : i); }
+    const RhsScalar* rhs(Index j) const { return m_rhs + (RhsStorageOrder==RowMajor ? j : j*m_rhsStride); }
+    ResScalar* res(Index i, Index j) const
+    { return m_res + (ResStorageOrder==RowMajor ? i*m_resStride + j*m_resIncr : i*m_resIncr + j*m_resStride); }
+
+    const Index m_threads, m_size, m_depth;
+    const LhsScalar* m_lhs;
+    const Index m_lhsStride;
+    const RhsScalar* m_rhs;
+    const Index m_rhsStride;
+    ResScalar* m_res;
+    const Index m_resIncr, m_resStride;
+    const ResScalar& m_alpha;
+  };
+
+  static void run(Index size, Index depth, const LhsScalar* lhs, Index lhsStride, const RhsScalar* rhs, Index rhsStride,
+                  ResScalar* res, Index resIncr, Index resStride, const ResScalar& alpha,
+                  level3_blocking<typename conditional<ResStorageOrder==RowMajor,RhsScalar,LhsScalar>::type,
+                                  typename conditional<ResStorageOrder==RowMajor,LhsScalar,RhsScalar>::type>& blocking)
+  {
+    // as in parallelize_gemm, at least 50k multiply-adds per thread, and blocks of columns which are wide
+    // enough for the gebp kernel
+    const double work = 0.5 * static_cast<double>(size) * static_cast<double>(size) * static_cast<double>(depth);
+    const Index threads = parallel_product_threads(work, size / Index(4*Traits::nr), 50000.);
+    if(threads>1)
+    {
+      parallel_product_run(threads, Task(threads, size, depth, lhs, lhsStride, rhs, rhsStride, res, resIncr, resStride, alpha));
+      return;
+    }
+    TriangularProduct::run(size, depth, lhs, lhsStride, rhs, rhsStride, res, resIncr, resStride, alpha, blocking);
+  }
+};
+
 } // end namespace internal
 
 // high level API
@@ -288,7 +383,7 @@ struct general_product_to_triangular_selector<MatrixType,ProductType,UpLo,false>
 
     BlockingType blocking(size, size, depth, 1, false);
 
-    internal::general_matrix_matrix_triangular_product<Index,
+    internal::parallel_general_matrix_matrix_triangular_product<Index,
       typename Lhs::Scalar, LhsIsRowMajor ? RowMajor : ColMajor, LhsBlasTraits::NeedToConjugate,
       typename Rhs::Scalar, RhsIsRowMajor ? RowMajor : ColMajor, RhsBlasTraits::NeedToConjugate,
       IsRowMajor ? RowMajor : ColMajor, MatrixType::InnerStrideAtCompileTime, UpLo&(Lower|Upper)>
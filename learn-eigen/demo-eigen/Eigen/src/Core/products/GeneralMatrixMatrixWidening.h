@@ -0,0 +1,157 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_GENERAL_MATRIX_MATRIX_WIDENING_H
+#define EIGEN_GENERAL_MATRIX_MATRIX_WIDENING_H
+
+namespace Eigen {
+
+namespace internal {
+
+/* Matrix-matrix product of 16-bit floating point matrices (bfloat16, half).
+ *
+ * The arithmetic of these types is emulated through float, so running the gebp kernel on them would
+ * round the accumulators to 16 bits after every multiply-add. Instead, the blocks of the operands are
+ * widened to float right before being packed, the float gebp kernel accumulates the whole depth in
+ * float, and the result is rounded once when it is added to the destination. The operands are still
+ * read from memory at 16 bits.
+ *
+ * The shared blocking object of the generic path holds 16-bit buffers which are not used here: each
+ * call computes the given block of the result on its own, which keeps the parallel path of
+ * parallelize_gemm correct since its tasks write disjoint blocks of columns.
+ */
+template<typename Index, typename Scalar, int LhsStorageOrder, int RhsStorageOrder, int ResInnerStride>
+struct general_matrix_matrix_product_widening
+{
+  typedef float WideScalar;
+  typedef gebp_traits<WideScalar,WideScalar> Traits;
+  typedef Matrix<WideScalar,Dynamic,Dynamic,LhsStorageOrder> LhsBlock;
+  typedef Matrix<WideScalar,Dynamic,Dynamic,RhsStorageOrder> RhsBlock;
+  typedef Map<const Matrix<Scalar,Dynamic,Dynamic,LhsStorageOrder>, 0, OuterStride<> > LhsMap;
+  typedef Map<const Matrix<Scalar,Dynamic,Dynamic,RhsStorageOrder>, 0, OuterStride<> > RhsMap;
+  typedef Map<Matrix<Scalar,Dynamic,Dynamic>, 0, Stride<Dynamic,ResInnerStride> > ResMap;
+
+  // at most this number of columns of the result are accumulated in float at once
+  enum { MaxAccumulatedCols = 2048 };
+
+  static void run(Index rows, Index cols, Index depth,
+                  const Scalar* _lhs, Index lhsStride,
+                  const Scalar* _rhs, Index rhsStride,
+                  Scalar* _res, Index resIncr, Index resStride,
+                  Scalar alpha, const gemm_epilogue<Scalar,Index>* epilogue = 0)
+  {
+    typedef const_blas_data_mapper<WideScalar, Index, LhsStorageOrder> LhsMapper;
+    typedef const_blas_data_mapper<WideScalar, Index, RhsStorageOrder> RhsMapper;
+    typedef blas_data_mapper<WideScalar, Index, ColMajor> AccMapper;
+
+    if(rows==0 || cols==0 || depth==0)
+      return;
+    eigen_assert(epilogue==0 || resIncr==1);
+
+    const LhsMap lhs(_lhs, rows, depth, OuterStride<>(lhsStride));
+    const RhsMap rhs(_rhs, depth, cols, OuterStride<>(rhsStride));
+
+    Index kc = depth, mc = rows, nc = cols;
+    computeProductBlockingSizes<WideScalar,WideScalar>(kc, mc, nc);
+    mc = (std::min)(rows, mc);
+    nc = (std::min)(cols, nc);
+    // the float accumulators of the result span mc rows and a multiple of nc columns
+    const Index accCols = (std::min)(cols, (std::max)(nc, Index(MaxAccumulatedCols) / nc * nc));
+
+    gemm_pack_lhs<WideScalar, Index, LhsMapper, Traits::mr, Traits::LhsProgress, typename Traits::LhsPacket4Packing, LhsStorageOrder> pack_lhs;
+    gemm_pack_rhs<WideScalar, Index, RhsMapper, Traits::nr, RhsStorageOrder> pack_rhs;
+    gebp_kernel<WideScalar, WideScalar, Index, AccMapper, Traits::mr, Traits::nr, false, false> gebp;
+
+    std::size_t sizeA = kc*mc;
+    std::size_t sizeB = kc*nc;
+    std::size_t sizeAcc = mc*accCols;
+    ei_declare_aligned_stack_constructed_variable(WideScalar, blockA, sizeA, 0);
+    ei_declare_aligned_stack_constructed_variable(WideScalar, blockB, sizeB, 0);
+    ei_declare_aligned_stack_constructed_variable(WideScalar, acc, sizeAcc, 0);
+    // widened copies of the current blocks of the operands
+    ei_declare_aligned_stack_constructed_variable(WideScalar, lhsBlockData, sizeA, 0);
+    ei_declare_aligned_stack_constructed_variable(WideScalar, rhsBlockData, sizeB, 0);
+
+    for(Index j3=0; j3<cols; j3+=accCols)
+    {
+      const Index actual_accCols = (std::min)(j3+accCols,cols)-j3;
+      for(Index i2=0; i2<rows; i2+=mc)
+      {
+        const Index actual_mc = (std::min)(i2+mc,rows)-i2;
+        Map<Matrix<WideScalar,Dynamic,Dynamic> > accBlock(acc, actual_mc, actual_accCols);
+        accBlock.setZero();
+        AccMapper accMapper(acc, actual_mc);
+
+        for(Index k2=0; k2<depth; k2+=kc)
+        {
+          const Index actual_kc = (std::min)(k2+kc,depth)-k2;
+
+          Map<LhsBlock> lhsBlock(lhsBlockData, actual_mc, actual_kc);
+          lhsBlock = lhs.block(i2, k2, actual_mc, actual_kc).template cast<WideScalar>();
+          pack_lhs(blockA, LhsMapper(lhsBlock.data(), lhsBlock.outerStride()), actual_kc, actual_mc);
+
+          for(Index j2=0; j2<actual_accCols; j2+=nc)
+          {
+            const Index actual_nc = (std::min)(j2+nc,actual_accCols)-j2;
+
+            Map<RhsBlock> rhsBlock(rhsBlockData, actual_kc, actual_nc);
+            rhsBlock = rhs.block(k2, j3+j2, actual_kc, actual_nc).template cast<WideScalar>();
+            pack_rhs(blockB, RhsMapper(rhsBlock.data(), rhsBlock.outerStride()), actual_kc, actual_nc);
+
+            gebp(accMapper.getSubMapper(0, j2), blockA, blockB, actual_mc, actual_kc, actual_nc, WideScalar(alpha));
+          }
+        }
+
+        // round once to the destination precision
+        ResMap res(_res + i2*resIncr + j3*resStride, actual_mc, actual_accCols, Stride<Dynamic,ResInnerStride>(resStride, resIncr));
+        res = (res.template cast<WideScalar>() + accBlock).template cast<Scalar>();
+        if(epilogue)
+          (*epilogue)(res.data(), actual_mc, actual_accCols, resStride);
+      }
+    }
+  }
+};
+
+template<typename Index, int LhsStorageOrder, bool ConjugateLhs, int RhsStorageOrder, bool ConjugateRhs, int ResInnerStride>
+struct general_matrix_matrix_product<Index,bfloat16,LhsStorageOrder,ConjugateLhs,bfloat16,RhsStorageOrder,ConjugateRhs,ColMajor,ResInnerStride>
+{
+  typedef general_matrix_matrix_product_widening<Index,bfloat16,LhsStorageOrder,RhsStorageOrder,ResInnerStride> Impl;
+  typedef typename Impl::Traits Traits;
+  typedef bfloat16 ResScalar;
+  static void run(Index rows, Index cols, Index depth,
+                  const bfloat16* lhs, Index lhsStride, const bfloat16* rhs, Index rhsStride,
+                  ResScalar* res, Index resIncr, Index resStride, ResScalar alpha,
+                  level3_blocking<bfloat16,bfloat16>& /*blocking*/, GemmParallelInfo<Index>* /*info*/ = 0,
+                  const gemm_epilogue<ResScalar,Index>* epilogue = 0)
+  {
+    Impl::run(
+      rows, cols, depth, lhs, lhsStride, rhs, rhsStride, res, resIncr, resStride, alpha, epilogue);
+  }
+};
+
+template<typename Index, int LhsStorageOrder, bool ConjugateLhs, int RhsStorageOrder, bool ConjugateRhs, int ResInnerStride>
+struct general_matrix_matrix_product<Index,half,LhsStorageOrder,ConjugateLhs,half,RhsStorageOrder,ConjugateRhs,ColMajor,ResInnerStride>
+{
+  typedef general_matrix_matrix_product_widening<Index,half,LhsStorageOrder,RhsStorageOrder,ResInnerStride> Impl;
+  typedef typename Impl::Traits Traits;
+  typedef half ResScalar;
+  static void run(Index rows, Index cols, Index depth,
+                  const half* lhs, Index lhsStride, const half* rhs, Index rhsStride,
+                  ResScalar* res, Index resIncr, Index resStride, ResScalar alpha,
+                  level3_blocking<half,half>& /*blocking*/, GemmParallelInfo<Index>* /*info*/ = 0,
+                  const gemm_epilogue<ResScalar,Index>* epilogue = 0)
+  {
+    Impl::run(
+      rows, cols, depth, lhs, lhsStride, rhs, rhsStride, res, resIncr, resStride, alpha, epilogue);
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_GENERAL_MATRIX_MATRIX_WIDENING_H
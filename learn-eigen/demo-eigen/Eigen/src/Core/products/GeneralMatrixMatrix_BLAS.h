@@ -61,7 +61,8 @@ static void run(Index rows, Index cols, Index depth, \
   EIGTYPE* res, Index resIncr, Index resStride, \
   EIGTYPE alpha, \
   level3_blocking<EIGTYPE, EIGTYPE>& /*blocking*/, \
-  GemmParallelInfo<Index>* /*info = 0*/) \
+  GemmParallelInfo<Index>* /*info = 0*/, \
+  const gemm_epilogue<EIGTYPE,Index>* epilogue = 0) \
 { \
   using std::conj; \
 \
@@ -103,6 +104,7 @@ static void run(Index rows, Index cols, Index depth, \
   } else b = _rhs; \
 \
   BLASFUNC(&transa, &transb, &m, &n, &k, (const BLASTYPE*)&numext::real_ref(alpha), (const BLASTYPE*)a, &lda, (const BLASTYPE*)b, &ldb, (const BLASTYPE*)&numext::real_ref(beta), (BLASTYPE*)res, &ldc); \
+  if(epilogue) (*epilogue)(res, rows, cols, resStride); \
 }};
 
 #ifdef EIGEN_USE_MKL
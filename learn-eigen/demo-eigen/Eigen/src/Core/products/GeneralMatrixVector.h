@@ -511,6 +511,151 @@ EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE void general_matrix_vector_product<Index,Lhs
   }
 }
 
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+/* Matrix * vector product computed by the kernel selected at runtime (see RuntimeDispatch.h).
+ * run() returns false when there is no such kernel for these scalar types.
+ */
+template<typename LhsScalar, typename RhsScalar, typename ResScalar, typename AlphaType,
+         bool Supported = dispatch_traits<ResScalar>::Supported!=0 && is_same<LhsScalar,ResScalar>::value
+                       && is_same<RhsScalar,ResScalar>::value && is_same<AlphaType,ResScalar>::value>
+struct dispatched_gemv
+{
+  template<typename Index>
+  static bool run(Index, Index, const LhsScalar*, Index, bool, const RhsScalar*, Index, ResScalar*, Index, const AlphaType&)
+  { return false; }
+};
+
+template<typename LhsScalar, typename RhsScalar, typename ResScalar, typename AlphaType>
+struct dispatched_gemv<LhsScalar,RhsScalar,ResScalar,AlphaType,true>
+{
+  template<typename Index>
+  static bool run(Index rows, Index cols, const LhsScalar* lhs, Index lhsStride, bool lhsRowMajor,
+                  const RhsScalar* rhs, Index rhsIncr, ResScalar* res, Index resIncr, const AlphaType& alpha)
+  {
+    const eigen_dispatch_kernels* kernels = dispatch_kernels();
+    if(kernels==0)
+      return false;
+    dispatch_traits<ResScalar>::gemv(*kernels)(rows, cols, lhs, lhsStride, lhsRowMajor, rhs, rhsIncr, res, resIncr, alpha);
+    return true;
+  }
+};
+#endif
+
+/* Multi-threaded matrix * vector product.
+ *
+ * A large matrix * vector product is bound by the bandwidth of reading the matrix once, which a single
+ * core cannot saturate. When nbThreads() allows it and the matrix holds at least MinTaskSize coefficients
+ * per thread, the product is thus split into independent tasks:
+ *  - by blocks of rows when there are enough of them, each task updating its own segment of res,
+ *    which is the natural split of a tall column-major matrix,
+ *  - by blocks of columns otherwise, e.g., for a wide row-major matrix, each task accumulating its share
+ *    of the product into a private vector. These partial results are then added to res in a fixed order.
+ * Small products, and products run from a thread which is already part of a parallel region,
+ * directly call general_matrix_vector_product.
+ */
+template<typename Index, typename LhsScalar, typename LhsMapper, int LhsStorageOrder, bool ConjugateLhs, typename RhsScalar, typename RhsMapper, bool ConjugateRhs>
+struct parallel_general_matrix_vector_product
+{
+  typedef general_matrix_vector_product<Index,LhsScalar,LhsMapper,LhsStorageOrder,ConjugateLhs,RhsScalar,RhsMapper,ConjugateRhs> Kernel;
+  // not taken from Kernel, which is specialized on top of BLAS when EIGEN_USE_BLAS is defined
+  typedef gemv_traits<LhsScalar,RhsScalar> Traits;
+  typedef typename ScalarBinaryOpTraits<LhsScalar, RhsScalar>::ReturnType ResScalar;
+  enum {
+    ResPacketSize = Traits::ResPacketSize,
+    // minimal number of coefficients of the matrix processed by each thread
+    MinTaskSize = 128*1024,
+    // a column-major block of rows should span full packets and be long enough to amortize the
+    // loads of the rhs coefficients
+    RowAlignment = LhsStorageOrder==ColMajor ? 4*ResPacketSize : 1,
+    MinRowsPerThread = LhsStorageOrder==ColMajor ? 8*ResPacketSize : 8,
+    // a row-major block of columns should span full packets
+    ColAlignment = LhsStorageOrder==RowMajor ? 4*ResPacketSize : 1
+  };
+
+  // computes the share of the product of the t-th of threads tasks
+  template<typename AlphaType>
+  struct Task
+  {
+    Task(Index threads, bool splitRows, Index blockSize, Index rows, Index cols, const LhsMapper& lhs, const RhsMapper& rhs,
+         ResScalar* res, Index resIncr, const AlphaType& alpha, ResScalar* partial)
+      : m_threads(threads), m_splitRows(splitRows), m_blockSize(blockSize), m_rows(rows), m_cols(cols), m_lhs(lhs), m_rhs(rhs),
+        m_res(res), m_resIncr(resIncr), m_alpha(alpha), m_partial(partial)
+    {}
+
+    void operator()(Index t) const
+    {
+      const Index size = m_splitRows ? m_rows : m_cols;
+      const Index start = (std::min)(t*m_blockSize, size);
+      const Index length = (t+1==m_threads) ? size-start : (std::min)(m_blockSize, size-start);
+      if(m_splitRows)
+      {
+        if(length>0)
+          kernel(length, m_cols, m_lhs.getSubMapper(start,0), m_rhs, m_res + start*m_resIncr, m_resIncr, m_alpha);
+      }
+      else
+      {
+        ResScalar* partial = m_partial + t*m_rows;
+        std::fill(partial, partial+m_rows, ResScalar(0));
+        if(length>0)
+          kernel(m_rows, length, m_lhs.getSubMapper(0,start), m_rhs.getSubMapper(start,0), partial, 1, m_alpha);
+      }
+    }
+
+    const Index m_threads;
+    const bool m_splitRows;
+    const Index m_blockSize, m_rows, m_cols;
+    const LhsMapper& m_lhs;
+    const RhsMapper& m_rhs;
+    ResScalar* m_res;
+    const Index m_resIncr;
+    const AlphaType& m_alpha;
+    ResScalar* m_partial;
+  };
+
+  // calls the kernel selected at runtime when there is one, and the compiled-in one otherwise
+  template<typename AlphaType>
+  static void kernel(Index rows, Index cols, const LhsMapper& lhs, const RhsMapper& rhs,
+                     ResScalar* res, Index resIncr, const AlphaType& alpha)
+  {
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+    const Index lhsStride = LhsStorageOrder==RowMajor ? Index(&lhs(1,0)-&lhs(0,0)) : Index(&lhs(0,1)-&lhs(0,0));
+    const Index rhsIncr = Index(&rhs(1,0)-&rhs(0,0));
+    if(dispatched_gemv<LhsScalar,RhsScalar,ResScalar,AlphaType>::run(rows, cols, &lhs(0,0), lhsStride, LhsStorageOrder==RowMajor,
+                                                                     &rhs(0,0), rhsIncr, res, resIncr, alpha))
+      return;
+#endif
+    Kernel::run(rows, cols, lhs, rhs, res, resIncr, alpha);
+  }
+
+  template<typename AlphaType>
+  static void run(Index rows, Index cols, const LhsMapper& lhs, const RhsMapper& rhs,
+                  ResScalar* res, Index resIncr, const AlphaType& alpha)
+  {
+    const Index threads = parallel_product_threads(static_cast<double>(rows) * static_cast<double>(cols),
+                                                   (std::max)(rows, cols), double(MinTaskSize));
+    if(threads>1)
+    {
+      const bool splitRows = rows >= threads*Index(MinRowsPerThread);
+      const Index blockSize = splitRows ? (rows/threads) / RowAlignment * RowAlignment
+                                        : (std::max)(Index(1), (cols/threads) / ColAlignment * ColAlignment);
+      // one partial result per thread when splitting the columns
+      const Index partialSize = splitRows ? 0 : threads*rows;
+      ei_declare_aligned_stack_constructed_variable(ResScalar, partial, partialSize, 0);
+
+      parallel_product_run(threads, Task<AlphaType>(threads, splitRows, blockSize, rows, cols, lhs, rhs, res, resIncr, alpha, partial));
+
+      if(!splitRows)
+      {
+        Map<Matrix<ResScalar,Dynamic,1>, 0, InnerStride<> > actualRes(res, rows, InnerStride<>(resIncr));
+        for(Index t=0; t<threads; ++t)
+          actualRes += Map<const Matrix<ResScalar,Dynamic,1> >(partial + t*rows, rows);
+      }
+      return;
+    }
+    kernel(rows, cols, lhs, rhs, res, resIncr, alpha);
+  }
+};
+
 } // end namespace internal
 
 } // end namespace Eigen
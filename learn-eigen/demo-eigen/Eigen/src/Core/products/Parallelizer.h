@@ -18,8 +18,31 @@ namespace Eigen {
 
 namespace internal {
 
+#ifdef EIGEN_HAS_GEMM_THREADPOOL
 /** \internal */
-inline void manage_multi_threading(Action action, int* v)
+inline void manage_gemm_threadpool(Action action, ThreadPoolInterface** pool)
+{
+  static std::atomic<ThreadPoolInterface*> m_pool(0);
+
+  if(action==SetAction)
+  {
+    eigen_internal_assert(pool!=0);
+    *pool = m_pool.exchange(*pool, std::memory_order_acq_rel);
+  }
+  else if(action==GetAction)
+  {
+    eigen_internal_assert(pool!=0);
+    *pool = m_pool.load(std::memory_order_acquire);
+  }
+  else
+  {
+    eigen_internal_assert(false);
+  }
+}
+#endif
+
+/** \internal On GetAction, \a isExplicit is set to whether the number of threads was given by setNbThreads() */
+inline void manage_multi_threading(Action action, int* v, bool* isExplicit = 0)
 {
   static int m_maxThreads = -1;
   EIGEN_UNUSED_VARIABLE(m_maxThreads)
@@ -32,11 +55,22 @@ inline void manage_multi_threading(Action action, int* v)
   else if(action==GetAction)
   {
     eigen_internal_assert(v!=0);
+    if(isExplicit)
+      *isExplicit = m_maxThreads>0;
     #ifdef EIGEN_HAS_OPENMP
     if(m_maxThreads>0)
       *v = m_maxThreads;
     else
       *v = omp_get_max_threads();
+    #elif defined(EIGEN_HAS_GEMM_THREADPOOL)
+    ThreadPoolInterface* pool = 0;
+    manage_gemm_threadpool(GetAction, &pool);
+    if(pool==0)
+      *v = 1;
+    else if(m_maxThreads>0)
+      *v = (std::min)(m_maxThreads, pool->NumThreads());
+    else
+      *v = pool->NumThreads();
     #else
     *v = 1;
     #endif
@@ -68,17 +102,51 @@ inline int nbThreads()
 }
 
 /** Sets the max number of threads reserved for Eigen
+  *
+  * Unless this function is called with a positive value, the general matrix-matrix products use at most
+  * one thread per physical core, since SMT siblings only compete for the floating point units and the caches
+  * the product kernel is tuned for. An explicit value is used as is.
+  *
   * \sa nbThreads */
 inline void setNbThreads(int v)
 {
   internal::manage_multi_threading(SetAction, &v);
 }
 
+#ifdef EIGEN_HAS_GEMM_THREADPOOL
+/** Registers \a pool as the thread pool running Eigen's multi-threaded kernels
+  * (general matrix-matrix products and row-major sparse * dense products),
+  * and returns the previously registered pool.
+  *
+  * This requires \c EIGEN_GEMM_THREADPOOL to be defined before including Eigen,
+  * in which case OpenMP is not used by Eigen. The pool is not owned by Eigen: it
+  * must outlive every product evaluated while it is registered, and must not be
+  * replaced while such a product is running. Passing a null pointer reverts to
+  * single-threaded execution. Unless \c setNbThreads has been called with a
+  * smaller value, all the threads of \a pool may be used.
+  *
+  * \sa getGemmThreadPool(), nbThreads() */
+inline ThreadPoolInterface* setGemmThreadPool(ThreadPoolInterface* pool)
+{
+  internal::manage_gemm_threadpool(SetAction, &pool);
+  return pool;
+}
+
+/** \returns the thread pool registered with setGemmThreadPool(), or a null pointer
+  * \sa setGemmThreadPool() */
+inline ThreadPoolInterface* getGemmThreadPool()
+{
+  ThreadPoolInterface* pool;
+  internal::manage_gemm_threadpool(GetAction, &pool);
+  return pool;
+}
+#endif
+
 namespace internal {
 
-template<typename Index> struct GemmParallelInfo
+template<typename Index> struct GemmParallelTaskInfo
 {
-  GemmParallelInfo() : sync(-1), users(0), lhs_start(0), lhs_length(0) {}
+  GemmParallelTaskInfo() : sync(-1), users(0), lhs_start(0), lhs_length(0) {}
 
   // volatile is not enough on all architectures (see bug 1572)
   // to guarantee that when thread A says to thread B that it is
@@ -96,6 +164,164 @@ template<typename Index> struct GemmParallelInfo
   Index lhs_length;
 };
 
+/** \internal What a thread taking part in a parallel GEMM session knows about it:
+  * its logical id, the number of participating threads, and the shared per-thread task info. */
+template<typename Index> struct GemmParallelInfo
+{
+  GemmParallelInfo(Index logical_thread_id_, Index num_threads_, GemmParallelTaskInfo<Index>* task_info_)
+    : logical_thread_id(logical_thread_id_), num_threads(num_threads_), task_info(task_info_)
+  {}
+
+  const Index logical_thread_id;
+  const Index num_threads;
+  GemmParallelTaskInfo<Index>* task_info;
+};
+
+#ifdef EIGEN_HAS_GEMM_THREADPOOL
+/** \internal \returns the registered pool if the calling thread may hand work to it,
+  * and a null pointer otherwise. Work is never handed to the pool from one of its own threads:
+  * a task blocking on sub-tasks queued behind it could deadlock the pool. */
+inline ThreadPoolInterface* gemm_threadpool_for_current_thread()
+{
+  ThreadPoolInterface* pool = getGemmThreadPool();
+  return (pool!=0 && pool->CurrentThreadId()==-1) ? pool : 0;
+}
+
+/** \internal Runs \a task(i) for i in [0,n), tasks 0 to n-2 on \a pool and the last one
+  * on the calling thread, and returns once all of them completed. */
+template<typename Index, typename Task>
+void run_on_gemm_threadpool(ThreadPoolInterface* pool, Index n, const Task& task)
+{
+  Barrier barrier(static_cast<unsigned int>(n-1));
+  EIGEN_INSTRUMENT_CAPTURE_SCOPE(scope);
+  for(Index i=0; i<n-1; ++i)
+    pool->Schedule([&, i]() {
+      {
+        EIGEN_INSTRUMENT_ADOPT_SCOPE(scope);
+        task(i);
+      }
+      barrier.Notify();
+    });
+  task(n-1);
+  barrier.Wait();
+}
+
+/** \internal Claims the registered pool for one parallel GEMM session.
+  * The threads of a session spin on each other's packed blocks, so two sessions sharing
+  * a pool smaller than their combined number of threads could deadlock. Hence only one
+  * session runs at a time, and products started meanwhile stay on their calling thread. */
+class gemm_threadpool_session
+{
+  public:
+    gemm_threadpool_session() : m_owns(!busy().exchange(true, std::memory_order_acquire)) {}
+    ~gemm_threadpool_session() { if(m_owns) busy().store(false, std::memory_order_release); }
+    bool owns() const { return m_owns; }
+
+  private:
+    static std::atomic<bool>& busy() { static std::atomic<bool> m_busy(false); return m_busy; }
+    bool m_owns;
+};
+
+/** \internal Calls \a func(i) for i in [0,n) using up to \a threads threads of the registered pool
+  * which dynamically grab chunks of \a chunk consecutive iterations, like an OpenMP dynamic schedule.
+  * Falls back to a sequential loop when the pool cannot be used from the calling thread. */
+template<typename Index, typename Functor>
+void parallel_for_dynamic(Index n, Index threads, Index chunk, const Functor& func)
+{
+  ThreadPoolInterface* pool = gemm_threadpool_for_current_thread();
+  if(pool==0 || threads<=1)
+  {
+    for(Index i=0; i<n; ++i)
+      func(i);
+    return;
+  }
+  std::atomic<Index> next(0);
+  run_on_gemm_threadpool(pool, threads, [&](Index) {
+    for(Index begin=next.fetch_add(chunk); begin<n; begin=next.fetch_add(chunk))
+    {
+      const Index end = (std::min)(begin+chunk, n);
+      for(Index i=begin; i<end; ++i)
+        func(i);
+    }
+  });
+}
+#endif
+
+/** \internal \returns the number of threads among which a product of \a work multiply-adds, made of at most
+  * \a maxTasks independent tasks, should be split. This is 1 when multi-threading is not enabled, when the calling
+  * thread already takes part in a parallel region, or when a thread would get less than \a minTaskWork multiply-adds. */
+template<typename Index>
+Index parallel_product_threads(double work, Index maxTasks, double minTaskWork)
+{
+#if (defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)) && !defined(EIGEN_USE_BLAS)
+#if defined(EIGEN_HAS_OPENMP)
+  if(omp_get_num_threads()>1)
+    return 1;
+#else
+  if(gemm_threadpool_for_current_thread()==0)
+    return 1;
+#endif
+  const Index threads = (std::min)(Index(nbThreads()), maxTasks);
+  return (std::max)(Index(1), static_cast<Index>((std::min)(static_cast<double>(threads), work / minTaskWork)));
+#else
+  EIGEN_UNUSED_VARIABLE(work);
+  EIGEN_UNUSED_VARIABLE(maxTasks);
+  EIGEN_UNUSED_VARIABLE(minTaskWork);
+  return 1;
+#endif
+}
+
+/** \internal Calls \a task(t) for t in [0,threads), each call running on its own thread when
+  * \a threads has been obtained from parallel_product_threads(). */
+template<typename Index, typename Task>
+void parallel_product_run(Index threads, const Task& task)
+{
+#if defined(EIGEN_HAS_OPENMP) && !defined(EIGEN_USE_BLAS)
+  EIGEN_INSTRUMENT_CAPTURE_SCOPE(scope);
+  #pragma omp parallel for schedule(static) num_threads(threads)
+  for(Index t=0; t<threads; ++t)
+  {
+    EIGEN_INSTRUMENT_ADOPT_SCOPE(scope);
+    task(t);
+  }
+#else
+#if defined(EIGEN_HAS_GEMM_THREADPOOL) && !defined(EIGEN_USE_BLAS)
+  ThreadPoolInterface* pool = gemm_threadpool_for_current_thread();
+  if(pool!=0 && threads>1)
+  {
+    run_on_gemm_threadpool(pool, threads, task);
+    return;
+  }
+#endif
+  for(Index t=0; t<threads; ++t)
+    task(t);
+#endif
+}
+
+/** \internal Runs the share of a parallel GEMM session assigned to the thread described by \a info. */
+template<typename Functor, typename Index>
+void parallelize_gemm_task(const Functor& func, Index rows, Index cols, bool transpose, GemmParallelInfo<Index>& info)
+{
+  Index i = info.logical_thread_id;
+  Index actual_threads = info.num_threads;
+
+  Index blockCols = (cols / actual_threads) & ~Index(0x3);
+  Index blockRows = (rows / actual_threads);
+  blockRows = (blockRows/Functor::Traits::mr)*Functor::Traits::mr;
+
+  Index r0 = i*blockRows;
+  Index actualBlockRows = (i+1==actual_threads) ? rows-r0 : blockRows;
+
+  Index c0 = i*blockCols;
+  Index actualBlockCols = (i+1==actual_threads) ? cols-c0 : blockCols;
+
+  info.task_info[i].lhs_start = r0;
+  info.task_info[i].lhs_length = actualBlockRows;
+
+  if(transpose) func(c0, actualBlockCols, 0, rows, &info);
+  else          func(0, rows, c0, actualBlockCols, &info);
+}
+
 template<bool Condition, typename Functor, typename Index>
 void parallelize_gemm(const Functor& func, Index rows, Index cols, Index depth, bool transpose)
 {
@@ -104,7 +330,7 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, Index depth,
   // Without C++11, we have to disable GEMM's parallelization on
   // non x86 architectures because there volatile is not enough for our purpose.
   // See bug 1572.
-#if (! defined(EIGEN_HAS_OPENMP)) || defined(EIGEN_USE_BLAS) || ((!EIGEN_HAS_CXX11_ATOMIC) && !(EIGEN_ARCH_i386_OR_x86_64))
+#if (! (defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL))) || defined(EIGEN_USE_BLAS) || ((!EIGEN_HAS_CXX11_ATOMIC) && !(EIGEN_ARCH_i386_OR_x86_64))
   // FIXME the transpose variable is only needed to properly split
   // the matrix product when multithreading is enabled. This is a temporary
   // fix to support row-major destination matrices. This whole
@@ -114,7 +340,7 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, Index depth,
   func(0,rows, 0,cols);
 #else
 
-  // Dynamically check whether we should enable or disable OpenMP.
+  // Dynamically check whether we should enable or disable multi-threading.
   // The conditions are:
   // - the max number of threads we can create is greater than 1
   // - we are not already in a parallel code
@@ -131,14 +357,31 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, Index depth,
   double kMinTaskSize = 50000;  // FIXME improve this heuristic.
   pb_max_threads = std::max<Index>(1, std::min<Index>(pb_max_threads, static_cast<Index>( work / kMinTaskSize ) ));
 
+  // the gebp kernel saturates the floating point units of a core, so SMT siblings only compete for them
+  // and for the L1 and L2 caches the blocking sizes were computed for: use at most one thread per physical core,
+  // unless the number of threads was set explicitly by setNbThreads().
+  int max_threads;
+  bool explicit_threads;
+  manage_multi_threading(GetAction, &max_threads, &explicit_threads);
+  if(!explicit_threads && cache_topology().cores>0)
+    pb_max_threads = std::min<Index>(pb_max_threads, cache_topology().cores);
+
   // compute the number of threads we are going to use
-  Index threads = std::min<Index>(nbThreads(), pb_max_threads);
+  Index threads = std::min<Index>(max_threads, pb_max_threads);
 
   // if multi-threading is explicitly disabled, not useful, or if we already are in a parallel session,
   // then abort multi-threading
-  // FIXME omp_get_num_threads()>1 only works for openmp, what if the user does not use openmp?
+#if defined(EIGEN_HAS_OPENMP)
   if((!Condition) || (threads==1) || (omp_get_num_threads()>1))
     return func(0,rows, 0,cols);
+#else
+  ThreadPoolInterface* pool = gemm_threadpool_for_current_thread();
+  if((!Condition) || (threads==1) || pool==0)
+    return func(0,rows, 0,cols);
+  gemm_threadpool_session session;
+  if(!session.owns())
+    return func(0,rows, 0,cols);
+#endif
 
   Eigen::initParallel();
   func.initParallelSession(threads);
@@ -146,32 +389,63 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, Index depth,
   if(transpose)
     std::swap(rows,cols);
 
-  ei_declare_aligned_stack_constructed_variable(GemmParallelInfo<Index>,info,threads,0);
+  ei_declare_aligned_stack_constructed_variable(GemmParallelTaskInfo<Index>,task_info,threads,0);
 
+#if defined(EIGEN_HAS_OPENMP)
+  EIGEN_INSTRUMENT_CAPTURE_SCOPE(scope);
   #pragma omp parallel num_threads(threads)
   {
-    Index i = omp_get_thread_num();
+    EIGEN_INSTRUMENT_ADOPT_SCOPE(scope);
     // Note that the actual number of threads might be lower than the number of request ones.
-    Index actual_threads = omp_get_num_threads();
-
-    Index blockCols = (cols / actual_threads) & ~Index(0x3);
-    Index blockRows = (rows / actual_threads);
-    blockRows = (blockRows/Functor::Traits::mr)*Functor::Traits::mr;
+    GemmParallelInfo<Index> info(omp_get_thread_num(), omp_get_num_threads(), task_info);
+    parallelize_gemm_task(func, rows, cols, transpose, info);
+  }
+#else
+  run_on_gemm_threadpool(pool, threads, [&](Index i) {
+    GemmParallelInfo<Index> info(i, threads, task_info);
+    parallelize_gemm_task(func, rows, cols, transpose, info);
+  });
+#endif
+#endif
+}
 
-    Index r0 = i*blockRows;
-    Index actualBlockRows = (i+1==actual_threads) ? rows-r0 : blockRows;
+#if EIGEN_HAS_LARGE_PAGES
+/** \internal Task of first_touch_large_pages() run by the thread \a t out of \a threads: it writes one byte of each
+  * small page of its share of the large pages. */
+struct first_touch_task
+{
+  first_touch_task(char* data, std::size_t size, Index threads, int policy)
+    : m_data(data), m_size(size), m_threads(threads), m_policy(policy) {}
 
-    Index c0 = i*blockCols;
-    Index actualBlockCols = (i+1==actual_threads) ? cols-c0 : blockCols;
+  void operator()(Index t) const
+  {
+    const Index largePages = Index((m_size + EIGEN_LARGE_PAGE_SIZE-1) / EIGEN_LARGE_PAGE_SIZE);
+    const bool blocked = m_policy==BlockedFirstTouch;
+    const Index begin = blocked ? t*largePages/m_threads : t;
+    const Index end = blocked ? (t+1)*largePages/m_threads : largePages;
+    const Index step = blocked ? 1 : m_threads;
+    for(Index p=begin; p<end; p+=step)
+    {
+      const std::size_t last = (std::min)(m_size, std::size_t(p+1)*EIGEN_LARGE_PAGE_SIZE);
+      // 4 kB is the smallest page size of the Linux targets
+      for(std::size_t i=std::size_t(p)*EIGEN_LARGE_PAGE_SIZE; i<last; i+=4096)
+        static_cast<volatile char*>(m_data)[i] = 0;
+    }
+  }
 
-    info[i].lhs_start = r0;
-    info[i].lhs_length = actualBlockRows;
+  char* m_data;
+  std::size_t m_size;
+  Index m_threads;
+  int m_policy;
+};
 
-    if(transpose) func(c0, actualBlockCols, 0, rows, info);
-    else          func(0, rows, c0, actualBlockCols, info);
-  }
-#endif
+inline void first_touch_large_pages(char* data, std::size_t size, int policy)
+{
+  const Index largePages = Index((size + EIGEN_LARGE_PAGE_SIZE-1) / EIGEN_LARGE_PAGE_SIZE);
+  const Index threads = parallel_product_threads<Index>(double(largePages), largePages, 1.0);
+  parallel_product_run(threads, first_touch_task(data, size, threads, policy));
 }
+#endif
 
 } // end namespace internal
 
@@ -0,0 +1,160 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_QUANTIZED_MATRIX_MATRIX_H
+#define EIGEN_QUANTIZED_MATRIX_MATRIX_H
+
+namespace Eigen {
+
+namespace internal {
+
+// reads the 4 bytes of a group as a single int32, e.g., to broadcast it
+EIGEN_STRONG_INLINE numext::int32_t qgemm_load_group(const void* from)
+{
+  numext::int32_t group;
+  std::memcpy(&group, from, sizeof(group));
+  return group;
+}
+
+/* Product of an int8 lhs by an uint8 rhs accumulated in int32.
+ *
+ * Both operands are packed by groups of 4 consecutive coefficients along the depth, the layout used
+ * by the u8*s8 dot-product instructions (vpdpbusd), which accumulate four byte products into each
+ * int32 lane:
+ *  - a lhs micro panel of mr rows holds, for each group of 4 depth indices, mr consecutive 4-byte
+ *    groups, one per row,
+ *  - a rhs micro panel of nr columns holds, for each group of 4 depth indices, nr consecutive 4-byte
+ *    groups, one per column.
+ * The depth and the panels are padded with zeros, which do not contribute to the products.
+ *
+ * qgemm_kernel computes the product of two such micro panels and adds it to the result. The generic
+ * version below is a plain scalar implementation, the SSE4.1, AVX2 and AVX512-VNNI specializations
+ * live in the respective arch directories.
+ */
+template<typename LhsScalar, typename RhsScalar, typename Index>
+struct qgemm_kernel
+{
+  typedef numext::int32_t ResScalar;
+  enum { mr = 4, nr = 4 };
+
+  // res(0:rows,0:cols) += A' * B' where A' and B' are micro panels spanning kg groups of 4 depth indices
+  static void run(const LhsScalar* blA, const RhsScalar* blB, Index kg, ResScalar* res, Index resStride, Index rows, Index cols)
+  {
+    ResScalar acc[mr*nr] = {0};
+    for(Index g=0; g<kg; ++g)
+    {
+      for(Index j=0; j<nr; ++j)
+        for(Index i=0; i<mr; ++i)
+          for(Index t=0; t<4; ++t)
+            acc[i+j*mr] += ResScalar(blA[(g*mr+i)*4+t]) * ResScalar(blB[(g*nr+j)*4+t]);
+    }
+    for(Index j=0; j<cols; ++j)
+      for(Index i=0; i<rows; ++i)
+        res[i+j*resStride] += acc[i+j*mr];
+  }
+};
+
+// packs rows x depth coefficients of lhs into micro panels of Pack rows
+template<typename Scalar, typename Index, int Pack, int StorageOrder>
+struct qgemm_pack_lhs
+{
+  void operator()(Scalar* blockA, const const_blas_data_mapper<Scalar, Index, StorageOrder>& lhs, Index depth, Index rows) const
+  {
+    const Index kg = (depth+3)/4;
+    Index count = 0;
+    for(Index i0=0; i0<rows; i0+=Pack)
+      for(Index g=0; g<kg; ++g)
+        for(Index i=i0; i<i0+Pack; ++i)
+          for(Index k=4*g; k<4*g+4; ++k)
+            blockA[count++] = (i<rows && k<depth) ? lhs(i,k) : Scalar(0);
+  }
+};
+
+// packs depth x cols coefficients of rhs into micro panels of Pack columns
+template<typename Scalar, typename Index, int Pack, int StorageOrder>
+struct qgemm_pack_rhs
+{
+  void operator()(Scalar* blockB, const const_blas_data_mapper<Scalar, Index, StorageOrder>& rhs, Index depth, Index cols) const
+  {
+    const Index kg = (depth+3)/4;
+    Index count = 0;
+    for(Index j0=0; j0<cols; j0+=Pack)
+      for(Index g=0; g<kg; ++g)
+        for(Index j=j0; j<j0+Pack; ++j)
+          for(Index k=4*g; k<4*g+4; ++k)
+            blockB[count++] = (j<cols && k<depth) ? rhs(k,j) : Scalar(0);
+  }
+};
+
+template<typename Index, int LhsStorageOrder, int RhsStorageOrder>
+struct quantized_matrix_matrix_product
+{
+  typedef numext::int8_t LhsScalar;
+  typedef numext::uint8_t RhsScalar;
+  typedef numext::int32_t ResScalar;
+  typedef qgemm_kernel<LhsScalar,RhsScalar,Index> Kernel;
+  enum { mr = Kernel::mr, nr = Kernel::nr };
+
+  // res += lhs * rhs, res being column-major
+  static void run(Index rows, Index cols, Index depth,
+                  const LhsScalar* _lhs, Index lhsStride,
+                  const RhsScalar* _rhs, Index rhsStride,
+                  ResScalar* res, Index resStride)
+  {
+    typedef const_blas_data_mapper<LhsScalar, Index, LhsStorageOrder> LhsMapper;
+    typedef const_blas_data_mapper<RhsScalar, Index, RhsStorageOrder> RhsMapper;
+    LhsMapper lhs(_lhs, lhsStride);
+    RhsMapper rhs(_rhs, rhsStride);
+
+    // A lhs micro panel (mr x kc bytes) stays in L1 while it sweeps a kc x nc block of the rhs held in L2,
+    // and a mc x kc block of the lhs is kept in L2 as well.
+    std::ptrdiff_t l1, l2, l3;
+    manage_caching_sizes(GetAction, &l1, &l2, &l3);
+    Index kc = (std::min<Index>)((depth+3) & ~Index(3), (std::max<Index>)(64, (Index(l1)/2/mr) & ~Index(3)));
+    Index mc = (std::min<Index>)(rows, (std::max<Index>)(mr, (Index(l2)/2/kc) / mr * mr));
+    Index nc = (std::min<Index>)(cols, (std::max<Index>)(nr, (Index(l2)/2/kc) / nr * nr));
+
+    std::size_t sizeA = kc * ((mc+mr-1)/mr*mr);
+    std::size_t sizeB = kc * ((nc+nr-1)/nr*nr);
+    ei_declare_aligned_stack_constructed_variable(LhsScalar, blockA, sizeA, 0);
+    ei_declare_aligned_stack_constructed_variable(RhsScalar, blockB, sizeB, 0);
+
+    qgemm_pack_lhs<LhsScalar, Index, mr, LhsStorageOrder> pack_lhs;
+    qgemm_pack_rhs<RhsScalar, Index, nr, RhsStorageOrder> pack_rhs;
+
+    for(Index i2=0; i2<rows; i2+=mc)
+    {
+      const Index actual_mc = (std::min)(i2+mc,rows)-i2;
+      for(Index k2=0; k2<depth; k2+=kc)
+      {
+        const Index actual_kc = (std::min)(k2+kc,depth)-k2;
+        const Index kg = (actual_kc+3)/4;
+        pack_lhs(blockA, lhs.getSubMapper(i2,k2), actual_kc, actual_mc);
+
+        for(Index j2=0; j2<cols; j2+=nc)
+        {
+          const Index actual_nc = (std::min)(j2+nc,cols)-j2;
+          pack_rhs(blockB, rhs.getSubMapper(k2,j2), actual_kc, actual_nc);
+
+          for(Index i=0; i<actual_mc; i+=mr)
+          {
+            const LhsScalar* blA = blockA + i*kg*4;
+            for(Index j=0; j<actual_nc; j+=nr)
+              Kernel::run(blA, blockB + j*kg*4, kg, res + (i2+i) + (j2+j)*resStride, resStride,
+                          (std::min<Index>)(mr, actual_mc-i), (std::min<Index>)(nr, actual_nc-j));
+          }
+        }
+      }
+    }
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_QUANTIZED_MATRIX_MATRIX_H
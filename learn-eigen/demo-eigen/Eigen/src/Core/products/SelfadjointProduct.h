@@ -106,7 +106,7 @@ struct selfadjoint_product_selector<MatrixType,OtherType,UpLo,false>
     BlockingType blocking(size, size, depth, 1, false);
 
 
-    internal::general_matrix_matrix_triangular_product<Index,
+    internal::parallel_general_matrix_matrix_triangular_product<Index,
       Scalar, OtherIsRowMajor ? RowMajor : ColMajor,   OtherBlasTraits::NeedToConjugate  && NumTraits<Scalar>::IsComplex,
       Scalar, OtherIsRowMajor ? ColMajor : RowMajor, (!OtherBlasTraits::NeedToConjugate) && NumTraits<Scalar>::IsComplex,
       IsRowMajor ? RowMajor : ColMajor, MatrixType::InnerStrideAtCompileTime, UpLo>
@@ -401,6 +401,89 @@ EIGEN_DONT_INLINE void product_triangular_matrix_matrix<Scalar,Index,Mode,false,
 } // end namespace internal
 
 namespace internal {
+/* Multi-threaded triangular matrix * general matrix product.
+ *
+ * The columns (resp. rows) of the general operand on the right (resp. left) lead to independent blocks of
+ * columns (resp. rows) of the result, which all hold the same amount of work. When nbThreads() allows it,
+ * they are split into one block per thread, each thread running product_triangular_matrix_matrix on its
+ * block with its own packing buffers.
+ */
+template <typename Scalar, typename Index,
+          int Mode, bool LhsIsTriangular,
+          int LhsStorageOrder, bool ConjugateLhs,
+          int RhsStorageOrder, bool ConjugateRhs,
+          int ResStorageOrder, int ResInnerStride>
+struct parallel_product_triangular_matrix_matrix
+{
+  typedef product_triangular_matrix_matrix<Scalar,Index,Mode,LhsIsTriangular,LhsStorageOrder,ConjugateLhs,RhsStorageOrder,ConjugateRhs,
+                                           ResStorageOrder,ResInnerStride> Product;
+  typedef gebp_traits<Scalar,Scalar> Traits;
+  typedef gemm_blocking_space<ResStorageOrder,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> BlockingType;
+  enum {
+    // the columns of the result are split when the triangular matrix is on the left, and its rows otherwise
+    SplitCols = LhsIsTriangular,
+    Alignment = SplitCols ? Traits::nr : Traits::mr
+  };
+
+  // computes the t-th of threads blocks of the result
+  struct Task
+  {
+    Task(Index threads, Index blockSize, Index rows, Index cols, Index depth, const Scalar* lhs, Index lhsStride,
+         const Scalar* rhs, Index rhsStride, Scalar* res, Index resIncr, Index resStride, const Scalar& alpha)
+      : m_threads(threads), m_blockSize(blockSize), m_rows(rows), m_cols(cols), m_depth(depth), m_lhs(lhs), m_lhsStride(lhsStride),
+        m_rhs(rhs), m_rhsStride(rhsStride), m_res(res), m_resIncr(resIncr), m_resStride(resStride), m_alpha(alpha)
+    {}
+
+    void operator()(Index t) const
+    {
+      const Index start = t*m_blockSize;
+      const Index length = (t+1==m_threads) ? (SplitCols ? m_cols : m_rows)-start : m_blockSize;
+      const Index rows = SplitCols ? m_rows : length;
+      const Index cols = SplitCols ? length : m_cols;
+      BlockingType blocking(rows, cols, m_depth, 1, false);
+      if(SplitCols)
+        Product::run(rows, cols, m_depth, m_lhs, m_lhsStride,
+                     m_rhs + (RhsStorageOrder==RowMajor ? start : start*m_rhsStride), m_rhsStride,
+                     m_res + (ResStorageOrder==RowMajor ? start*m_resIncr : start*m_resStride), m_resIncr, m_resStride,
+                     m_alpha, blocking);
+      else
+        Product::run(rows, cols, m_depth, m_lhs + (LhsStorageOrder==RowMajor ? start*m_lhsStride : start), m_lhsStride,
+                     m_rhs, m_rhsStride,
+                     m_res + (ResStorageOrder==RowMajor ? start*m_resStride : start*m_resIncr), m_resIncr, m_resStride,
+                     m_alpha, blocking);
+    }
+
+    const Index m_threads, m_blockSize, m_rows, m_cols, m_depth;
+    const Scalar* m_lhs;
+    const Index m_lhsStride;
+    const Scalar* m_rhs;
+    const Index m_rhsStride;
+    Scalar* m_res;
+    const Index m_resIncr, m_resStride;
+    const Scalar& m_alpha;
+  };
+
+  static void run(Index rows, Index cols, Index depth,
+                  const Scalar* lhs, Index lhsStride,
+                  const Scalar* rhs, Index rhsStride,
+                  Scalar* res, Index resIncr, Index resStride,
+                  const Scalar& alpha, level3_blocking<Scalar,Scalar>& blocking)
+  {
+    // as in parallelize_gemm, give each thread full micro panels and at least 50k multiply-adds
+    const double work = 0.5 * static_cast<double>(rows) * static_cast<double>(cols) * static_cast<double>(depth);
+    const Index size = SplitCols ? cols : rows;
+    const Index threads = parallel_product_threads(work, size / Index(Alignment), 50000.);
+    if(threads>1)
+    {
+      const Index blockSize = (size / threads) / Alignment * Alignment;
+      parallel_product_run(threads, Task(threads, blockSize, rows, cols, depth, lhs, lhsStride, rhs, rhsStride,
+                                         res, resIncr, resStride, alpha));
+      return;
+    }
+    Product::run(rows, cols, depth, lhs, lhsStride, rhs, rhsStride, res, resIncr, resStride, alpha, blocking);
+  }
+};
+
 template<int Mode, bool LhsIsTriangular, typename Lhs, typename Rhs>
 struct triangular_product_impl<Mode,LhsIsTriangular,Lhs,false,Rhs,false>
 {
@@ -435,7 +518,7 @@ struct triangular_product_impl<Mode,LhsIsTriangular,Lhs,false,Rhs,false>
 
     BlockingType blocking(stripedRows, stripedCols, stripedDepth, 1, false);
 
-    internal::product_triangular_matrix_matrix<Scalar, Index,
+    internal::parallel_product_triangular_matrix_matrix<Scalar, Index,
       Mode, LhsIsTriangular,
       (internal::traits<ActualLhsTypeCleaned>::Flags&RowMajorBit) ? RowMajor : ColMajor, LhsBlasTraits::NeedToConjugate,
       (internal::traits<ActualRhsTypeCleaned>::Flags&RowMajorBit) ? RowMajor : ColMajor, RhsBlasTraits::NeedToConjugate,
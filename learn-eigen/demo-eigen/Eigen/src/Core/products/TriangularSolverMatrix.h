@@ -330,6 +330,68 @@ EIGEN_DONT_INLINE void triangular_solve_matrix<Scalar,Index,OnTheRight,Mode,Conj
     }
   }
 
+/* Multi-threaded triangular solver with multiple right hand sides.
+ *
+ * The right hand sides are independent: each column of other is solved on its own when the triangular matrix
+ * is on the left, and each row when it is on the right. When nbThreads() allows it and the solve is large
+ * enough, other is thus split into one block of right hand sides per thread, each thread running the
+ * triangular_solve_matrix above on its block with its own packing buffers.
+ */
+template <typename Scalar, typename Index, int Side, int Mode, bool Conjugate, int TriStorageOrder, int OtherStorageOrder, int OtherInnerStride>
+struct parallel_triangular_solve_matrix
+{
+  typedef triangular_solve_matrix<Scalar,Index,Side,Mode,Conjugate,TriStorageOrder,OtherStorageOrder,OtherInnerStride> Solver;
+  typedef gebp_traits<Scalar,Scalar> Traits;
+  typedef gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> BlockingType;
+  enum {
+    // whether the right hand sides are the columns of other seen as a column-major matrix
+    SplitCols = (int(Side)==OnTheLeft) == (int(OtherStorageOrder)==ColMajor),
+    Alignment = SplitCols ? Traits::nr : Traits::mr
+  };
+
+  // solves the t-th of threads blocks of right hand sides
+  struct Task
+  {
+    Task(Index threads, Index blockSize, Index size, Index otherSize, const Scalar* tri, Index triStride,
+         Scalar* other, Index otherIncr, Index otherStride)
+      : m_threads(threads), m_blockSize(blockSize), m_size(size), m_otherSize(otherSize), m_tri(tri), m_triStride(triStride),
+        m_other(other), m_otherIncr(otherIncr), m_otherStride(otherStride)
+    {}
+
+    void operator()(Index t) const
+    {
+      const Index start = t*m_blockSize;
+      const Index length = (t+1==m_threads) ? m_otherSize-start : m_blockSize;
+      BlockingType blocking(SplitCols ? m_size : length, SplitCols ? length : m_size, m_size, 1, false);
+      Solver::run(m_size, length, m_tri, m_triStride,
+                  m_other + start * (SplitCols ? m_otherStride : m_otherIncr), m_otherIncr, m_otherStride, blocking);
+    }
+
+    const Index m_threads, m_blockSize, m_size, m_otherSize;
+    const Scalar* m_tri;
+    const Index m_triStride;
+    Scalar* m_other;
+    const Index m_otherIncr, m_otherStride;
+  };
+
+  static void run(Index size, Index otherSize,
+                  const Scalar* tri, Index triStride,
+                  Scalar* other, Index otherIncr, Index otherStride,
+                  level3_blocking<Scalar,Scalar>& blocking)
+  {
+    // as in parallelize_gemm, give each thread full micro panels and at least 50k multiply-adds
+    const double work = 0.5 * static_cast<double>(size) * static_cast<double>(size) * static_cast<double>(otherSize);
+    const Index threads = parallel_product_threads(work, otherSize / Index(Alignment), 50000.);
+    if(threads>1)
+    {
+      const Index blockSize = (otherSize / threads) / Alignment * Alignment;
+      parallel_product_run(threads, Task(threads, blockSize, size, otherSize, tri, triStride, other, otherIncr, otherStride));
+      return;
+    }
+    Solver::run(size, otherSize, tri, triStride, other, otherIncr, otherStride, blocking);
+  }
+};
+
 } // end namespace internal
 
 } // end namespace Eigen
@@ -26,6 +26,55 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheRight, Mode, Co
   }
 };
 
+/* Blocked substitution for large systems with a single right hand side.
+ *
+ * The diagonal blocks of size BlockSize are solved by the panel-wise substitutions below, each of them
+ * being followed by the update of the remaining part of rhs. This trailing update is a large
+ * matrix-vector product, which parallel_general_matrix_vector_product splits across threads.
+ * \returns false, leaving rhs untouched, when the system is too small or would not be split across threads.
+ */
+template<typename LhsScalar, typename RhsScalar, typename Index, int Mode, bool Conjugate, int StorageOrder>
+struct triangular_solve_vector_blocked
+{
+  enum {
+    IsLower = ((Mode&Lower)==Lower),
+    BlockSize = 512
+  };
+  static bool run(Index size, const LhsScalar* _lhs, Index lhsStride, RhsScalar* rhs)
+  {
+    if(size < 4*Index(BlockSize)
+       || parallel_product_threads(0.5 * static_cast<double>(size) * static_cast<double>(size), size, 50000.)<=1)
+      return false;
+
+    typedef Map<const Matrix<LhsScalar,Dynamic,Dynamic,StorageOrder>, 0, OuterStride<> > LhsMap;
+    const LhsMap lhs(_lhs,size,size,OuterStride<>(lhsStride));
+    typedef const_blas_data_mapper<LhsScalar,Index,StorageOrder> LhsMapper;
+    typedef const_blas_data_mapper<RhsScalar,Index,ColMajor> RhsMapper;
+    typedef triangular_solve_vector<LhsScalar,RhsScalar,Index,OnTheLeft,Mode,Conjugate,StorageOrder> BlockSolver;
+
+    for(Index bi=IsLower ? 0 : size;
+        IsLower ? bi<size : bi>0;
+        IsLower ? bi+=BlockSize : bi-=BlockSize)
+    {
+      Index actualBlockSize = (std::min)(IsLower ? size - bi : bi, Index(BlockSize));
+      Index startBlock = IsLower ? bi : bi-actualBlockSize;
+      BlockSolver::run(actualBlockSize, &lhs.coeffRef(startBlock,startBlock), lhsStride, rhs+startBlock);
+
+      Index startRest = IsLower ? startBlock+actualBlockSize : 0;
+      Index r = IsLower ? size - startRest : startBlock; // remaining size
+      if (r > 0)
+      {
+        parallel_general_matrix_vector_product<Index,LhsScalar,LhsMapper,StorageOrder,Conjugate,RhsScalar,RhsMapper,false>::run(
+            r, actualBlockSize,
+            LhsMapper(&lhs.coeffRef(startRest,startBlock), lhsStride),
+            RhsMapper(rhs+startBlock, 1),
+            rhs+startRest, 1, RhsScalar(-1));
+      }
+    }
+    return true;
+  }
+};
+
 // forward and backward substitution, row-major, rhs is a vector
 template<typename LhsScalar, typename RhsScalar, typename Index, int Mode, bool Conjugate>
 struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Conjugate, RowMajor>
@@ -35,6 +84,9 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
   };
   static void run(Index size, const LhsScalar* _lhs, Index lhsStride, RhsScalar* rhs)
   {
+    if(triangular_solve_vector_blocked<LhsScalar,RhsScalar,Index,Mode,Conjugate,RowMajor>::run(size, _lhs, lhsStride, rhs))
+      return;
+
     typedef Map<const Matrix<LhsScalar,Dynamic,Dynamic,RowMajor>, 0, OuterStride<> > LhsMap;
     const LhsMap lhs(_lhs,size,size,OuterStride<>(lhsStride));
 
@@ -93,6 +145,9 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
   };
   static void run(Index size, const LhsScalar* _lhs, Index lhsStride, RhsScalar* rhs)
   {
+    if(triangular_solve_vector_blocked<LhsScalar,RhsScalar,Index,Mode,Conjugate,ColMajor>::run(size, _lhs, lhsStride, rhs))
+      return;
+
     typedef Map<const Matrix<LhsScalar,Dynamic,Dynamic,ColMajor>, 0, OuterStride<> > LhsMap;
     const LhsMap lhs(_lhs,size,size,OuterStride<>(lhsStride));
     typedef const_blas_data_mapper<LhsScalar,Index,ColMajor> LhsMapper;
@@ -292,6 +292,9 @@
         #ifdef __AVX512BF16__
           #define EIGEN_VECTORIZE_AVX512BF16
         #endif
+        #ifdef __AVX512VNNI__
+          #define EIGEN_VECTORIZE_AVX512VNNI
+        #endif
       #endif
     #endif
 
@@ -325,6 +325,33 @@ enum StorageOptions {
   DontAlign = 0x2
 };
 
+/** \ingroup enums
+  * Storage option giving a dynamic-size matrix or array an inline buffer of \p N coefficients, in which its
+  * coefficients are stored instead of on the heap as long as its size does not exceed \p N. It is combined with
+  * the other StorageOptions, e.g., \c Matrix<float,Dynamic,1,ColMajor|InlineStorage<16>::value>, and is
+  * ignored by the types whose maximal size is fixed, which never allocate.
+  * \sa SmallVectorX, SmallMatrixX */
+template<int N> struct InlineStorage
+{
+  enum { value = N << 8 };
+};
+
+/** \ingroup enums
+  * Enum used by setLargeAllocationPolicy() to choose the threads which touch first the pages of a large
+  * allocation. On NUMA systems, each page is placed on the node of the thread touching it first. */
+enum FirstTouchPolicy {
+  /** The pages are not touched when allocated, and land on the node of the thread which first writes them,
+    * usually the one which allocated them. */
+  NoFirstTouch = 0,
+  /** The allocation is split into as many contiguous blocks as there are threads (see nbThreads()), each
+    * thread touching one of them, so that the pages stay local to the threads working on the matching
+    * slices of the matrix, such as the column blocks of the parallel products. */
+  BlockedFirstTouch = 1,
+  /** The pages are touched by the threads in turn, which interleaves them across the nodes of the threads
+    * and balances the memory traffic to the data all of them read. */
+  InterleavedFirstTouch = 2
+};
+
 /** \ingroup enums
   * Enum for specifying whether to apply or solve on the left or right. */
 enum SideType {
@@ -556,6 +583,13 @@ enum ComparisonName {
   cmp_GT = 5,
   cmp_GE = 6
 };
+
+/** \internal \returns the capacity of the inline buffer requested by the StorageOptions \a Options
+  * \sa InlineStorage */
+template<int Options> struct inline_storage_capacity
+{
+  enum { value = Options >> 8 };
+};
 } // end namespace internal
 
 } // end namespace Eigen
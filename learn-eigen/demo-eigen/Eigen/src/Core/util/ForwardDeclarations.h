@@ -74,6 +74,7 @@ template<typename Derived> class ArrayBase;
 
 template<typename ExpressionType, unsigned int Added, unsigned int Removed> class Flagged;
 template<typename ExpressionType, template <typename> class StorageBase > class NoAlias;
+template<typename ExpressionType, typename Device> class DeviceWrapper;
 template<typename ExpressionType> class NestByValue;
 template<typename ExpressionType> class ForceAlignedAccess;
 template<typename ExpressionType> class SwapWrapper;
@@ -95,6 +96,9 @@ template<typename XprType>                                class Inverse;
 
 template<typename Lhs, typename Rhs, int Option = DefaultProduct> class Product;
 
+template<typename _Scalar, int _Side> class PackedMatrix;
+template<typename _Scalar, int _Rows, int _Cols> class MatrixBatch;
+
 template<typename Derived> class DiagonalBase;
 template<typename _DiagonalVectorType> class DiagonalWrapper;
 template<typename _Scalar, int SizeAtCompileTime, int MaxSizeAtCompileTime=SizeAtCompileTime> class DiagonalMatrix;
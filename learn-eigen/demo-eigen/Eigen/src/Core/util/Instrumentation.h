@@ -0,0 +1,309 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_INSTRUMENTATION_H
+#define EIGEN_INSTRUMENTATION_H
+
+#ifdef EIGEN_INSTRUMENTATION
+
+namespace Eigen {
+
+/** \class InstrumentationSnapshot
+  * \ingroup Core_Module
+  *
+  * \brief Counters of the heap allocations and of the hot kernels, collected when EIGEN_INSTRUMENTATION is defined
+  *
+  * The heap allocations of Eigen, their sizes, and the reallocations, are attributed to the innermost
+  * EIGEN_INSTRUMENT_SCOPE() active on the allocating thread, which records the file and the line where it is
+  * declared:
+  * \code
+  * {
+  *   EIGEN_INSTRUMENT_SCOPE();
+  *   y = A * x + b;
+  * }
+  * std::cout << instrumentationSnapshot();
+  * \endcode
+  * The allocations made outside of any scope are gathered under an empty file name. The threads of the parallel
+  * products work on behalf of the thread which started the product, and their allocations go to its scope.
+  *
+  * The kernels are the general matrix products ("gemm"), split into the packing of their operands and the
+  * block-panel kernel ("gemm:pack_lhs", "gemm:pack_rhs", "gemm:gebp"), the matrix-vector products ("gemv") and
+  * the triangular solves with a matrix right-hand side ("trsm"), as well as the epilogues of productWithEpilogue()
+  * ("gemm:epilogue"). Their times add up the ones of all the threads, and their floating point operations count
+  * two per multiply-add. The time of a kernel excludes the one of the epilogues run meanwhile by the same thread,
+  * so that the rate of the products does not depend on their epilogues.
+  *
+  * \sa instrumentationSnapshot(), resetInstrumentation()
+  */
+struct InstrumentationSnapshot
+{
+  /** Heap allocations attributed to the EIGEN_INSTRUMENT_SCOPE() at \a file:\a line */
+  struct CallSite
+  {
+    std::string file;
+    int line;
+    std::size_t allocations;
+    std::size_t bytes;
+  };
+
+  /** Calls, cumulated duration and floating point operations of a kernel */
+  struct Kernel
+  {
+    std::string name;
+    std::size_t calls;
+    double seconds;
+    double flops;
+  };
+
+  std::vector<CallSite> callSites;
+  std::vector<Kernel> kernels;
+};
+
+namespace internal {
+
+enum InstrumentedKernel {
+  InstrumentGemm,
+  InstrumentGemmPackLhs,
+  InstrumentGemmPackRhs,
+  InstrumentGebp,
+  InstrumentGemv,
+  InstrumentTrsm,
+  InstrumentGemmEpilogue,
+  InstrumentedKernels
+};
+
+inline const char* instrumented_kernel_name(int kernel)
+{
+  static const char* const names[InstrumentedKernels] = { "gemm", "gemm:pack_lhs", "gemm:pack_rhs", "gemm:gebp", "gemv", "trsm", "gemm:epilogue" };
+  return names[kernel];
+}
+
+/** \internal The EIGEN_INSTRUMENT_SCOPE() objects of a thread, which form a stack */
+class instrumentation_scope : noncopyable
+{
+  public:
+    instrumentation_scope(const char* file, int line) : m_file(file), m_line(line), m_parent(current())
+    {
+      current() = this;
+    }
+    ~instrumentation_scope() { current() = m_parent; }
+
+    static const instrumentation_scope*& current()
+    {
+      static thread_local const instrumentation_scope* scope = 0;
+      return scope;
+    }
+
+    const char* m_file;
+    int m_line;
+
+  private:
+    const instrumentation_scope* m_parent;
+};
+
+/** \internal Attributes the allocations of a worker thread to the scope of the thread which handed it a task, until
+  * its destruction */
+class instrumentation_scope_guard : noncopyable
+{
+  public:
+    explicit instrumentation_scope_guard(const instrumentation_scope* scope) : m_previous(instrumentation_scope::current())
+    {
+      instrumentation_scope::current() = scope;
+    }
+    ~instrumentation_scope_guard() { instrumentation_scope::current() = m_previous; }
+
+  private:
+    const instrumentation_scope* m_previous;
+};
+
+/** \internal The counters shared by all threads. The allocations are counted under a lock, and the kernels by
+  * atomic increments. */
+class instrumentation_counters : noncopyable
+{
+  public:
+    static instrumentation_counters& instance()
+    {
+      static instrumentation_counters counters;
+      return counters;
+    }
+
+    void allocation(std::size_t bytes)
+    {
+      const instrumentation_scope* scope = instrumentation_scope::current();
+      const std::pair<const char*,int> site = scope ? std::make_pair(scope->m_file, scope->m_line) : std::make_pair("", 0);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::pair<std::size_t,std::size_t>& counts = m_sites[site];
+      counts.first += 1;
+      counts.second += bytes;
+    }
+
+    void kernel(int kernel, std::chrono::steady_clock::duration duration, double flops)
+    {
+      m_kernels[kernel].calls.fetch_add(1, std::memory_order_relaxed);
+      m_kernels[kernel].nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+      m_kernels[kernel].flops.fetch_add(static_cast<unsigned long long>(flops), std::memory_order_relaxed);
+    }
+
+    InstrumentationSnapshot snapshot()
+    {
+      InstrumentationSnapshot result;
+      {
+        // the sites declared in the headers have a copy of their file name per translation unit
+        std::map<std::pair<std::string,int>, std::pair<std::size_t,std::size_t> > sites;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(SiteMap::const_iterator it = m_sites.begin(); it != m_sites.end(); ++it)
+        {
+          std::pair<std::size_t,std::size_t>& counts = sites[std::make_pair(std::string(it->first.first), it->first.second)];
+          counts.first += it->second.first;
+          counts.second += it->second.second;
+        }
+        for(std::map<std::pair<std::string,int>, std::pair<std::size_t,std::size_t> >::const_iterator it = sites.begin(); it != sites.end(); ++it)
+        {
+          InstrumentationSnapshot::CallSite site = { it->first.first, it->first.second, it->second.first, it->second.second };
+          result.callSites.push_back(site);
+        }
+      }
+      for(int k = 0; k < InstrumentedKernels; ++k)
+      {
+        InstrumentationSnapshot::Kernel kernel = { instrumented_kernel_name(k), m_kernels[k].calls.load(),
+                                                   1e-9 * double(m_kernels[k].nanoseconds.load()), double(m_kernels[k].flops.load()) };
+        result.kernels.push_back(kernel);
+      }
+      return result;
+    }
+
+    void reset()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_sites.clear();
+      for(int k = 0; k < InstrumentedKernels; ++k)
+      {
+        m_kernels[k].calls.store(0);
+        m_kernels[k].nanoseconds.store(0);
+        m_kernels[k].flops.store(0);
+      }
+    }
+
+  private:
+    instrumentation_counters() {}
+
+    struct KernelCounters
+    {
+      KernelCounters() : calls(0), nanoseconds(0), flops(0) {}
+      std::atomic<std::size_t> calls;
+      std::atomic<long long> nanoseconds;
+      std::atomic<unsigned long long> flops;
+    };
+
+    typedef std::map<std::pair<const char*,int>, std::pair<std::size_t,std::size_t> > SiteMap;
+    std::mutex m_mutex;
+    SiteMap m_sites;
+    KernelCounters m_kernels[InstrumentedKernels];
+};
+
+/** \internal Adds the time elapsed between its construction and its destruction to a kernel, less the time of the
+  * epilogues run meanwhile by the thread, which are counted on their own */
+class instrumentation_timer : noncopyable
+{
+  public:
+    typedef std::chrono::steady_clock::duration duration;
+
+    instrumentation_timer(int kernel, double flops)
+      : m_kernel(kernel), m_flops(flops), m_epilogues(epilogues()), m_start(std::chrono::steady_clock::now()) {}
+    ~instrumentation_timer()
+    {
+      const duration elapsed = std::chrono::steady_clock::now() - m_start - (epilogues() - m_epilogues);
+      if(m_kernel==InstrumentGemmEpilogue)
+        epilogues() += elapsed;
+      instrumentation_counters::instance().kernel(m_kernel, elapsed, m_flops);
+    }
+
+  private:
+    // the cumulated time of the epilogues run by the calling thread
+    static duration& epilogues()
+    {
+      static thread_local duration time(0);
+      return time;
+    }
+
+    int m_kernel;
+    double m_flops;
+    duration m_epilogues;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // end namespace internal
+
+/** \returns the counters collected since the start of the program or the last call to resetInstrumentation()
+  * \sa class InstrumentationSnapshot */
+inline InstrumentationSnapshot instrumentationSnapshot()
+{
+  return internal::instrumentation_counters::instance().snapshot();
+}
+
+/** Sets all the counters of the instrumentation to zero \sa instrumentationSnapshot() */
+inline void resetInstrumentation()
+{
+  internal::instrumentation_counters::instance().reset();
+}
+
+#ifndef EIGEN_NO_IO
+/** Writes the call sites which allocated, and the kernels which ran, as two tables */
+inline std::ostream& operator<<(std::ostream& s, const InstrumentationSnapshot& snapshot)
+{
+  s << "call site\tallocations\tbytes\n";
+  for(std::size_t i = 0; i < snapshot.callSites.size(); ++i)
+  {
+    const InstrumentationSnapshot::CallSite& site = snapshot.callSites[i];
+    if(site.file.empty())
+      s << "(no scope)";
+    else
+      s << site.file << ':' << site.line;
+    s << '\t' << site.allocations << '\t' << site.bytes << '\n';
+  }
+  s << "kernel\tcalls\tseconds\tGFLOP\tGFLOP/s\n";
+  for(std::size_t i = 0; i < snapshot.kernels.size(); ++i)
+  {
+    const InstrumentationSnapshot::Kernel& kernel = snapshot.kernels[i];
+    s << kernel.name << '\t' << kernel.calls << '\t' << kernel.seconds << '\t' << 1e-9 * kernel.flops << '\t'
+      << (kernel.seconds > 0 && kernel.flops > 0 ? 1e-9 * kernel.flops / kernel.seconds : 0.) << '\n';
+  }
+  return s;
+}
+#endif
+
+} // end namespace Eigen
+
+/** \ingroup Core_Module
+  * Attributes the heap allocations of Eigen made by the calling thread until the end of the enclosing block to the
+  * current file and line, when EIGEN_INSTRUMENTATION is defined. \sa class InstrumentationSnapshot */
+#define EIGEN_INSTRUMENT_SCOPE() \
+  ::Eigen::internal::instrumentation_scope EIGEN_CAT(eigen_instrumentation_scope_, __LINE__)(__FILE__, __LINE__)
+
+#define EIGEN_INSTRUMENT_ALLOCATION(BYTES) ::Eigen::internal::instrumentation_counters::instance().allocation(BYTES)
+
+#define EIGEN_INSTRUMENT_KERNEL(KERNEL, FLOPS) \
+  ::Eigen::internal::instrumentation_timer EIGEN_CAT(eigen_instrumentation_timer_, __LINE__)(::Eigen::internal::KERNEL, FLOPS)
+
+// NAME is the scope of the calling thread, to be adopted by the threads running its tasks
+#define EIGEN_INSTRUMENT_CAPTURE_SCOPE(NAME) \
+  const ::Eigen::internal::instrumentation_scope* const NAME = ::Eigen::internal::instrumentation_scope::current()
+
+#define EIGEN_INSTRUMENT_ADOPT_SCOPE(NAME) \
+  ::Eigen::internal::instrumentation_scope_guard EIGEN_CAT(eigen_instrumentation_guard_, __LINE__)(NAME)
+
+#else
+
+#define EIGEN_INSTRUMENT_SCOPE() (void)0
+#define EIGEN_INSTRUMENT_ALLOCATION(BYTES) (void)0
+#define EIGEN_INSTRUMENT_KERNEL(KERNEL, FLOPS) (void)0
+#define EIGEN_INSTRUMENT_CAPTURE_SCOPE(NAME) (void)0
+#define EIGEN_INSTRUMENT_ADOPT_SCOPE(NAME) (void)0
+
+#endif // EIGEN_INSTRUMENTATION
+
+#endif // EIGEN_INSTRUMENTATION_H
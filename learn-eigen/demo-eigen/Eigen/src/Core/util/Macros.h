@@ -54,6 +54,18 @@
 #define EIGEN_STACK_ALLOCATION_LIMIT 131072
 #endif
 
+// Maximal size in bytes of the thread-local arena from which the temporary buffers larger than
+// EIGEN_STACK_ALLOCATION_LIMIT are taken; see setScratchArenaLimit()
+#ifndef EIGEN_SCRATCH_ARENA_LIMIT
+// 67108864 == 64 MB
+#define EIGEN_SCRATCH_ARENA_LIMIT 67108864
+#endif
+
+#ifndef EIGEN_LARGE_PAGE_SIZE
+// 2097152 == 2 MB, the size of the transparent huge pages of x86-64 and of most aarch64 kernels
+#define EIGEN_LARGE_PAGE_SIZE 2097152
+#endif
+
 //------------------------------------------------------------------------------------------
 // Compiler identification, EIGEN_COMP_*
 //------------------------------------------------------------------------------------------
@@ -832,6 +844,33 @@
   #endif
 #endif
 
+// thread-local scratch arenas for the temporary buffers of the products and solvers, see setScratchArenaLimit()
+#ifndef EIGEN_HAS_SCRATCH_ARENA
+  #if EIGEN_HAS_CXX11_ATOMIC && !defined(EIGEN_GPUCC) && !defined(SYCL_DEVICE_ONLY) && !defined(EIGEN_NO_SCRATCH_ARENA)
+    #define EIGEN_HAS_SCRATCH_ARENA 1
+  #else
+    #define EIGEN_HAS_SCRATCH_ARENA 0
+  #endif
+#endif
+
+// memory resources of the dynamic-size dense storage installed per thread, see class ScopedMemoryResource
+#ifndef EIGEN_HAS_MEMORY_RESOURCE
+  #if EIGEN_HAS_CXX11 && !defined(EIGEN_GPUCC) && !defined(SYCL_DEVICE_ONLY) && !defined(EIGEN_NO_MEMORY_RESOURCE)
+    #define EIGEN_HAS_MEMORY_RESOURCE 1
+  #else
+    #define EIGEN_HAS_MEMORY_RESOURCE 0
+  #endif
+#endif
+
+// huge page and first-touch policy of the large dynamic-size dense storage, see setLargeAllocationPolicy
+#ifndef EIGEN_HAS_LARGE_PAGES
+  #if EIGEN_HAS_CXX11_ATOMIC && EIGEN_OS_LINUX && !defined(EIGEN_GPUCC) && !defined(SYCL_DEVICE_ONLY) && !defined(EIGEN_NO_LARGE_PAGES)
+    #define EIGEN_HAS_LARGE_PAGES 1
+  #else
+    #define EIGEN_HAS_LARGE_PAGES 0
+  #endif
+#endif
+
 #ifndef EIGEN_HAS_CXX11_OVERRIDE_FINAL
   #if    EIGEN_MAX_CPP_VER>=11 && \
        (EIGEN_COMP_CXXVER >= 11 || EIGEN_COMP_MSVC >= 1700)
@@ -174,6 +174,7 @@ EIGEN_DEVICE_FUNC inline void check_that_malloc_is_allowed()
 EIGEN_DEVICE_FUNC inline void* aligned_malloc(std::size_t size)
 {
   check_that_malloc_is_allowed();
+  EIGEN_INSTRUMENT_ALLOCATION(size);
 
   void *result;
   #if (EIGEN_DEFAULT_ALIGN_BYTES==0) || EIGEN_MALLOC_ALREADY_ALIGNED
@@ -215,6 +216,7 @@ EIGEN_DEVICE_FUNC inline void aligned_free(void *ptr)
 inline void* aligned_realloc(void *ptr, std::size_t new_size, std::size_t old_size)
 {
   EIGEN_UNUSED_VARIABLE(old_size)
+  EIGEN_INSTRUMENT_ALLOCATION(new_size);
 
   void *result;
 #if (EIGEN_DEFAULT_ALIGN_BYTES==0) || EIGEN_MALLOC_ALREADY_ALIGNED
@@ -244,6 +246,7 @@ template<bool Align> EIGEN_DEVICE_FUNC inline void* conditional_aligned_malloc(s
 template<> EIGEN_DEVICE_FUNC inline void* conditional_aligned_malloc<false>(std::size_t size)
 {
   check_that_malloc_is_allowed();
+  EIGEN_INSTRUMENT_ALLOCATION(size);
 
   EIGEN_USING_STD(malloc)
   void *result = malloc(size);
@@ -272,9 +275,433 @@ template<bool Align> inline void* conditional_aligned_realloc(void* ptr, std::si
 
 template<> inline void* conditional_aligned_realloc<false>(void* ptr, std::size_t new_size, std::size_t)
 {
+  EIGEN_INSTRUMENT_ALLOCATION(new_size);
   return std::realloc(ptr, new_size);
 }
 
+/*****************************************************************************
+*** Large allocations of the dynamic-size dense storage                    ***
+*****************************************************************************/
+
+#if EIGEN_HAS_LARGE_PAGES
+
+/** \internal Gets or sets the policy of the large allocations of the dynamic-size dense storage: the size in bytes
+  * from which it applies, 0 disabling it, and the FirstTouchPolicy. A SetAction leaves alone the settings
+  * given by a null pointer. */
+inline void manage_large_allocations(Action action, std::size_t* threshold, int* firstTouch)
+{
+  static std::atomic<std::size_t> m_threshold(0);
+  static std::atomic<int> m_firstTouch(NoFirstTouch);
+  if(action==SetAction)
+  {
+    if(threshold)
+      m_threshold.store(*threshold);
+    if(firstTouch)
+      m_firstTouch.store(*firstTouch);
+  }
+  else if(action==GetAction)
+  {
+    *threshold = m_threshold.load(std::memory_order_relaxed);
+    *firstTouch = m_firstTouch.load(std::memory_order_relaxed);
+  }
+  else
+  {
+    eigen_internal_assert(false);
+  }
+}
+
+/** \internal Touches the pages of the \a size bytes at \a data from the threads of the parallel products, following
+  * the FirstTouchPolicy \a policy. Defined in Parallelizer.h. */
+inline void first_touch_large_pages(char* data, std::size_t size, int policy);
+
+/** \internal Allocates \a size bytes aligned on EIGEN_LARGE_PAGE_SIZE, advised to be backed by transparent huge pages,
+  * which conditional_aligned_free<Align> releases.
+  * \throws std::bad_alloc on allocation failure */
+template<bool Align> inline void* large_page_malloc(std::size_t size)
+{
+  check_that_malloc_is_allowed();
+  EIGEN_INSTRUMENT_ALLOCATION(size);
+
+  void* result = 0;
+  // aligned_free releases the memory of handmade_aligned_malloc, and std::free the one of posix_memalign
+  if(Align && !((EIGEN_DEFAULT_ALIGN_BYTES==0) || EIGEN_MALLOC_ALREADY_ALIGNED))
+    result = handmade_aligned_malloc(size, EIGEN_LARGE_PAGE_SIZE);
+  else if(posix_memalign(&result, EIGEN_LARGE_PAGE_SIZE, size)!=0)
+    result = 0;
+
+  if(!result)
+    throw_std_bad_alloc();
+#ifdef MADV_HUGEPAGE
+  ::madvise(result, size, MADV_HUGEPAGE);
+#endif
+  return result;
+}
+
+/** \internal Allocates the \a size bytes of a dynamic-size dense storage from the heap, following the policy set by
+  * setLargeAllocationPolicy() */
+template<bool Align> inline void* dense_storage_heap_malloc(std::size_t size)
+{
+  std::size_t threshold;
+  int firstTouch;
+  manage_large_allocations(GetAction, &threshold, &firstTouch);
+  if(threshold==0 || size<threshold)
+    return conditional_aligned_malloc<Align>(size);
+  void* result = large_page_malloc<Align>(size);
+  if(firstTouch!=NoFirstTouch)
+    first_touch_large_pages(static_cast<char*>(result), size, firstTouch);
+  return result;
+}
+
+template<bool Align> inline void* dense_storage_heap_realloc(void* ptr, std::size_t new_size, std::size_t old_size)
+{
+  std::size_t threshold;
+  int firstTouch;
+  manage_large_allocations(GetAction, &threshold, &firstTouch);
+  // a large allocation is moved rather than reallocated in place, which would lose its alignment, or which
+  // handmade_aligned_realloc could not do
+  const bool large = (threshold!=0 && new_size>=threshold) || (ptr!=0 && UIntPtr(ptr)%EIGEN_LARGE_PAGE_SIZE==0);
+  if(!large)
+    return conditional_aligned_realloc<Align>(ptr, new_size, old_size);
+  void* result = dense_storage_heap_malloc<Align>(new_size);
+  if(ptr)
+  {
+    std::memcpy(result, ptr, (std::min)(new_size, old_size));
+    conditional_aligned_free<Align>(ptr);
+  }
+  return result;
+}
+
+#else
+
+template<bool Align> EIGEN_DEVICE_FUNC inline void* dense_storage_heap_malloc(std::size_t size)
+{
+  return conditional_aligned_malloc<Align>(size);
+}
+
+template<bool Align> inline void* dense_storage_heap_realloc(void* ptr, std::size_t new_size, std::size_t old_size)
+{
+  return conditional_aligned_realloc<Align>(ptr, new_size, old_size);
+}
+
+#endif // EIGEN_HAS_LARGE_PAGES
+
+/*****************************************************************************
+*** Memory resources of the dynamic-size dense storage                     ***
+*****************************************************************************/
+
+#if EIGEN_HAS_MEMORY_RESOURCE
+
+} // end namespace internal
+
+/** \class MemoryResource
+  * \ingroup Core_Module
+  *
+  * \brief Interface of the memory resources from which dynamic-size matrices and arrays can take their coefficients
+  *
+  * While a ScopedMemoryResource installs a resource on a thread, the coefficients of the dynamic-size Matrix and
+  * Array objects allocated or resized on this thread, including the temporaries of the expressions, are taken
+  * from it. This does not change the types of the matrices, nor their layout.
+  *
+  * Each block records the resource which served it, and is given back to it by the thread which frees it, without
+  * any lookup nor lock. Hence, unless the resource is thread-safe, the matrices taking their coefficients from it
+  * must be freed on the thread which uses it, or while no thread uses it.
+  *
+  * \sa ScopedMemoryResource, MonotonicBuffer
+  */
+class MemoryResource
+{
+  public:
+    virtual ~MemoryResource() {}
+
+    /** \returns \a bytes bytes aligned on \a alignment bytes, or a null pointer to let the heap serve the request */
+    virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+    /** Releases the memory \a ptr of \a bytes bytes returned by allocate() */
+    virtual void deallocate(void* ptr, std::size_t bytes) = 0;
+};
+
+/** \class ScopedMemoryResource
+  * \ingroup Core_Module
+  *
+  * \brief Installs a memory resource on the calling thread for the lifetime of the object
+  *
+  * \code
+  * MonotonicBuffer buffer(16 << 20);
+  * while(nextRequest())
+  * {
+  *   {
+  *     ScopedMemoryResource scope(buffer);
+  *     MatrixXd T = A * B.transpose();  // T and the temporaries take their coefficients from buffer
+  *     ...
+  *   }
+  *   buffer.release();  // the matrices of the request are gone
+  * }
+  * \endcode
+  *
+  * The scopes of a thread nest: the innermost resource serves the allocations, and the memory is handed back to the
+  * heap or to the resource which served it, even once its scope has ended. Hence, a matrix whose coefficients come
+  * from a resource must be destroyed, resized or swapped away before the resource is destroyed or its memory
+  * reclaimed.
+  *
+  * \sa MemoryResource, MonotonicBuffer
+  */
+class ScopedMemoryResource : internal::noncopyable
+{
+  public:
+    explicit ScopedMemoryResource(MemoryResource& resource) : m_resource(resource), m_previous(top())
+    {
+      top() = this;
+    }
+
+    ~ScopedMemoryResource()
+    {
+      checkInnermost(this);
+      top() = m_previous;
+    }
+
+    /** \returns the innermost memory resource installed on the calling thread, or a null pointer */
+    static MemoryResource* current() { return top() ? &top()->m_resource : 0; }
+
+  protected:
+    static ScopedMemoryResource*& top()
+    {
+      static thread_local ScopedMemoryResource* scope = 0;
+      return scope;
+    }
+
+    // out of the destructor, which cannot let the exception of an eigen_assert escape
+    static void checkInnermost(const ScopedMemoryResource* scope)
+    {
+      eigen_assert(top()==scope && "ScopedMemoryResource objects must be destroyed in the reverse order of their construction");
+      EIGEN_UNUSED_VARIABLE(scope);
+    }
+
+    MemoryResource& m_resource;
+    ScopedMemoryResource* m_previous;
+};
+
+/** \class MonotonicBuffer
+  * \ingroup Core_Module
+  *
+  * \brief A memory resource handing out consecutive parts of a buffer, which are reclaimed all at once
+  *
+  * The allocations are served from an initial buffer, and then from chunks of the heap of increasing sizes. Memory is
+  * not reused before release() is called, except when the last allocation is released first, as when a temporary
+  * is destroyed right after its creation. release() rewinds the buffer and, when chunks were needed, replaces them
+  * and the initial buffer if it owns it by a single one as large as all of them, so that the following rounds of
+  * allocations of the same size do not touch the heap.
+  *
+  * A MonotonicBuffer is not thread-safe, and must be installed on a single thread at a time. The memory freed on the
+  * other threads, or on its thread while it is not the innermost resource, is left alone until release().
+  *
+  * \sa ScopedMemoryResource
+  */
+class MonotonicBuffer : public MemoryResource, internal::noncopyable
+{
+  public:
+    /** Serves the allocations from a buffer of \a size bytes allocated on the heap, and then from chunks of the heap */
+    explicit MonotonicBuffer(std::size_t size = std::size_t(1) << 20) : m_ownsInitialBuffer(true)
+    {
+      m_chunks.push_back(Chunk(static_cast<char*>(internal::aligned_malloc(size)), size));
+      rewind();
+    }
+
+    /** Serves the allocations from the \a size bytes at \a buffer, which must outlive the object, and then from
+      * chunks of the heap */
+    MonotonicBuffer(void* buffer, std::size_t size) : m_ownsInitialBuffer(false)
+    {
+      m_chunks.push_back(Chunk(static_cast<char*>(buffer), size));
+      rewind();
+    }
+
+    ~MonotonicBuffer()
+    {
+      for(std::size_t i = m_ownsInitialBuffer ? 0 : 1; i < m_chunks.size(); ++i)
+        internal::aligned_free(m_chunks[i].data);
+    }
+
+    /** Reclaims all the memory handed out so far, which must not be in use anymore */
+    void release()
+    {
+      const std::size_t total = capacity();
+      for(std::size_t i = 1; i < m_chunks.size(); ++i)
+        internal::aligned_free(m_chunks[i].data);
+      m_chunks.erase(m_chunks.begin()+1, m_chunks.end());
+      if(m_ownsInitialBuffer && total>m_chunks[0].size)
+      {
+        internal::aligned_free(m_chunks[0].data);
+        m_chunks[0] = Chunk(static_cast<char*>(internal::aligned_malloc(total)), total);
+      }
+      rewind();
+    }
+
+    /** \returns the total size of the buffers, in bytes */
+    std::size_t capacity() const
+    {
+      std::size_t total = 0;
+      for(std::size_t i = 0; i < m_chunks.size(); ++i)
+        total += m_chunks[i].size;
+      return total;
+    }
+
+    /** \returns the number of bytes handed out since the construction or the last call to release() */
+    std::size_t used() const { return m_used; }
+
+    virtual void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+      for(;;)
+      {
+        const Chunk& chunk = m_chunks[m_current];
+        const std::size_t start = (internal::UIntPtr(chunk.data + m_top) + alignment-1) / alignment * alignment - internal::UIntPtr(chunk.data);
+        if(start<=chunk.size && bytes<=chunk.size-start)
+        {
+          m_used += start + bytes - m_top;
+          m_top = start + bytes;
+          return chunk.data + start;
+        }
+        if(m_current+1 == m_chunks.size())
+        {
+          const std::size_t size = (std::max)(2*m_chunks.back().size, bytes+alignment);
+          m_chunks.push_back(Chunk(static_cast<char*>(internal::aligned_malloc(size)), size));
+        }
+        ++m_current;
+        m_top = 0;
+      }
+    }
+
+    virtual void deallocate(void* ptr, std::size_t bytes)
+    {
+      // only the last allocation can be given back, and only by the thread using the buffer
+      if(ScopedMemoryResource::current()!=this)
+        return;
+      char* begin = m_chunks[m_current].data;
+      if(static_cast<char*>(ptr)+bytes == begin+m_top)
+      {
+        m_used -= bytes;
+        m_top = std::size_t(static_cast<char*>(ptr)-begin);
+      }
+    }
+
+    /** \returns whether \a ptr points into one of the buffers */
+    bool owns(const void* ptr) const
+    {
+      for(std::size_t i = 0; i < m_chunks.size(); ++i)
+        if(static_cast<const char*>(ptr)>=m_chunks[i].data && static_cast<const char*>(ptr)<m_chunks[i].data+m_chunks[i].size)
+          return true;
+      return false;
+    }
+
+  protected:
+    struct Chunk
+    {
+      Chunk(char* d, std::size_t s) : data(d), size(s) {}
+      char* data;
+      std::size_t size;
+    };
+
+    void rewind()
+    {
+      m_current = 0;
+      m_top = 0;
+      m_used = 0;
+    }
+
+    std::vector<Chunk> m_chunks;
+    std::size_t m_current;
+    std::size_t m_top;
+    std::size_t m_used;
+    bool m_ownsInitialBuffer;
+};
+
+namespace internal {
+
+// The coefficients of a dynamic-size dense storage are followed by a trailer recording the memory resource which
+// served them, or a null pointer for the heap, which keeps the alignment of the block.
+
+/** \internal \returns the offset of the trailer of \a size bytes of coefficients */
+inline std::size_t dense_storage_trailer_offset(std::size_t size)
+{
+  const std::size_t align = sizeof(MemoryResource*);
+  if(size > std::size_t(-1) - 2*align)
+    throw_std_bad_alloc();
+  return (size + align-1) / align * align;
+}
+
+/** \internal \returns the trailer of the \a size bytes of coefficients \a ptr of a dynamic-size dense storage */
+inline MemoryResource*& dense_storage_resource(void* ptr, std::size_t size)
+{
+  return *reinterpret_cast<MemoryResource**>(static_cast<char*>(ptr) + dense_storage_trailer_offset(size));
+}
+
+/** \internal \returns the size of the block holding \a size bytes of coefficients and their trailer */
+inline std::size_t dense_storage_block_size(std::size_t size)
+{
+  return dense_storage_trailer_offset(size) + sizeof(MemoryResource*);
+}
+
+/** \internal Allocates the coefficients of a dynamic-size dense storage, from the memory resource installed on the
+  * calling thread if any */
+template<bool Align> inline void* dense_storage_malloc(std::size_t size)
+{
+  const std::size_t bytes = dense_storage_block_size(size);
+  MemoryResource* resource = ScopedMemoryResource::current();
+  void* result = resource ? resource->allocate(bytes, Align && EIGEN_DEFAULT_ALIGN_BYTES>16 ? EIGEN_DEFAULT_ALIGN_BYTES : 16) : 0;
+  if(result==0)
+  {
+    resource = 0;
+    result = dense_storage_heap_malloc<Align>(bytes);
+  }
+  dense_storage_resource(result, size) = resource;
+  return result;
+}
+
+/** \internal Frees memory allocated with dense_storage_malloc, giving it back to the resource which served it */
+template<bool Align> inline void dense_storage_free(void* ptr, std::size_t size)
+{
+  if(ptr==0)
+    return;
+  if(MemoryResource* resource = dense_storage_resource(ptr, size))
+    resource->deallocate(ptr, dense_storage_block_size(size));
+  else
+    conditional_aligned_free<Align>(ptr);
+}
+
+template<bool Align> inline void* dense_storage_realloc(void* ptr, std::size_t new_size, std::size_t old_size)
+{
+  if(ScopedMemoryResource::current()==0 && (ptr==0 || dense_storage_resource(ptr, old_size)==0))
+  {
+    void* result = dense_storage_heap_realloc<Align>(ptr, dense_storage_block_size(new_size), ptr ? dense_storage_block_size(old_size) : 0);
+    dense_storage_resource(result, new_size) = 0;
+    return result;
+  }
+  void* result = dense_storage_malloc<Align>(new_size);
+  if(ptr)
+  {
+    std::memcpy(result, ptr, (std::min)(new_size, old_size));
+    dense_storage_free<Align>(ptr, old_size);
+  }
+  return result;
+}
+
+#else
+
+template<bool Align> EIGEN_DEVICE_FUNC inline void* dense_storage_malloc(std::size_t size)
+{
+  return dense_storage_heap_malloc<Align>(size);
+}
+
+template<bool Align> EIGEN_DEVICE_FUNC inline void dense_storage_free(void* ptr, std::size_t)
+{
+  conditional_aligned_free<Align>(ptr);
+}
+
+template<bool Align> inline void* dense_storage_realloc(void* ptr, std::size_t new_size, std::size_t old_size)
+{
+  return dense_storage_heap_realloc<Align>(ptr, new_size, old_size);
+}
+
+#endif // EIGEN_HAS_MEMORY_RESOURCE
+
 /*****************************************************************************
 *** Construction/destruction of array elements                             ***
 *****************************************************************************/
@@ -401,7 +828,7 @@ template<typename T, bool Align> EIGEN_DEVICE_FUNC inline T* conditional_aligned
   if(size==0)
     return 0; // short-cut. Also fixes Bug 884
   check_size_for_overflow<T>(size);
-  T *result = reinterpret_cast<T*>(conditional_aligned_malloc<Align>(sizeof(T)*size));
+  T *result = reinterpret_cast<T*>(dense_storage_malloc<Align>(sizeof(T)*size));
   if(NumTraits<T>::RequireInitialization)
   {
     EIGEN_TRY
@@ -410,7 +837,7 @@ template<typename T, bool Align> EIGEN_DEVICE_FUNC inline T* conditional_aligned
     }
     EIGEN_CATCH(...)
     {
-      conditional_aligned_free<Align>(result);
+      dense_storage_free<Align>(result, sizeof(T)*size);
       EIGEN_THROW;
     }
   }
@@ -423,7 +850,7 @@ template<typename T, bool Align> inline T* conditional_aligned_realloc_new_auto(
   check_size_for_overflow<T>(old_size);
   if(NumTraits<T>::RequireInitialization && (new_size < old_size))
     destruct_elements_of_array(pts+new_size, old_size-new_size);
-  T *result = reinterpret_cast<T*>(conditional_aligned_realloc<Align>(reinterpret_cast<void*>(pts), sizeof(T)*new_size, sizeof(T)*old_size));
+  T *result = reinterpret_cast<T*>(dense_storage_realloc<Align>(reinterpret_cast<void*>(pts), sizeof(T)*new_size, sizeof(T)*old_size));
   if(NumTraits<T>::RequireInitialization && (new_size > old_size))
   {
     EIGEN_TRY
@@ -432,7 +859,7 @@ template<typename T, bool Align> inline T* conditional_aligned_realloc_new_auto(
     }
     EIGEN_CATCH(...)
     {
-      conditional_aligned_free<Align>(result);
+      dense_storage_free<Align>(result, sizeof(T)*new_size);
       EIGEN_THROW;
     }
   }
@@ -443,7 +870,7 @@ template<typename T, bool Align> EIGEN_DEVICE_FUNC inline void conditional_align
 {
   if(NumTraits<T>::RequireInitialization)
     destruct_elements_of_array<T>(ptr, size);
-  conditional_aligned_free<Align>(ptr);
+  dense_storage_free<Align>(ptr, sizeof(T)*size);
 }
 
 /****************************************************************************/
@@ -601,6 +1028,188 @@ template<typename T> EIGEN_DEVICE_FUNC T* smart_move(T* start, T* end, T* target
   #undef EIGEN_ALLOCA
 #endif
 
+/*****************************************************************************
+*** Thread-local scratch arenas                                            ***
+*****************************************************************************/
+
+#if EIGEN_HAS_SCRATCH_ARENA
+
+/** \internal Gets or sets the settings shared by the scratch arenas of all threads: the maximal capacity of an
+  * arena in bytes, and a generation number telling the arenas to release their memory when it changes.
+  * Each SetAction increments the generation, and sets the limit unless \a limit is null. */
+inline void manage_scratch_arenas(Action action, std::size_t* limit, unsigned* generation)
+{
+  static std::atomic<std::size_t> m_limit(EIGEN_SCRATCH_ARENA_LIMIT);
+  static std::atomic<unsigned> m_generation(0);
+  if(action==SetAction)
+  {
+    if(limit)
+      m_limit.store(*limit);
+    m_generation.fetch_add(1);
+  }
+  else if(action==GetAction)
+  {
+    *limit = m_limit.load(std::memory_order_relaxed);
+    *generation = m_generation.load(std::memory_order_relaxed);
+  }
+  else
+  {
+    eigen_internal_assert(false);
+  }
+}
+
+/** \internal
+  * A grow-only buffer from which a thread takes its temporary buffers: the packed blocks of the products and
+  * the workspaces of the solvers too large for the stack. Buffers are taken from the top of the arena and
+  * are expected to be released in the reverse order, the space of a buffer released out of order being
+  * recovered once all of them are released. The arena is resized only when it is empty, to the largest
+  * amount of memory requested at once so far, within the limit set by setScratchArenaLimit(). Requests it
+  * cannot serve fail, and are served by the heap instead. */
+class scratch_arena : noncopyable
+{
+  public:
+    enum { Alignment = EIGEN_DEFAULT_ALIGN_BYTES>64 ? EIGEN_DEFAULT_ALIGN_BYTES : 64 };
+
+    scratch_arena() : m_data(0), m_capacity(0), m_top(0), m_live(0), m_peak(0), m_generation(0) {}
+    ~scratch_arena() { handmade_aligned_free(m_data); }
+
+    /** \returns a buffer of \a bytes bytes aligned on \c Alignment bytes, or 0 if the arena cannot hold it */
+    void* allocate(std::size_t bytes)
+    {
+      bytes = round(bytes);
+      if(m_live==0)
+        reserve(bytes);
+      if(bytes>m_capacity-m_top)
+      {
+        m_peak = (std::max)(m_peak, m_top+bytes);
+        return 0;
+      }
+      void* ptr = m_data + m_top;
+      m_top += bytes;
+      m_peak = (std::max)(m_peak, m_top);
+      ++m_live;
+      return ptr;
+    }
+
+    /** \returns whether \a ptr was returned by allocate() */
+    bool owns(const void* ptr) const
+    {
+      return m_data!=0 && static_cast<const char*>(ptr)>=m_data && static_cast<const char*>(ptr)<m_data+m_capacity;
+    }
+
+    /** Releases the buffer \a ptr of \a bytes bytes returned by allocate() */
+    void release(void* ptr, std::size_t bytes)
+    {
+      eigen_internal_assert(owns(ptr) && m_live>0);
+      --m_live;
+      if(m_live==0)
+        m_top = 0;
+      else if(static_cast<char*>(ptr)+round(bytes)==m_data+m_top)
+        m_top -= round(bytes);
+    }
+
+    /** Frees the memory of the arena if no buffer is in use */
+    void clear()
+    {
+      if(m_live>0)
+        return;
+      handmade_aligned_free(m_data);
+      m_data = 0;
+      m_capacity = m_top = m_peak = 0;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+
+  protected:
+    static std::size_t round(std::size_t bytes) { return (bytes+Alignment-1) & ~std::size_t(Alignment-1); }
+
+    // resizes the empty arena to hold at least the largest amount of memory requested so far
+    void reserve(std::size_t bytes)
+    {
+      std::size_t limit;
+      unsigned generation;
+      manage_scratch_arenas(GetAction, &limit, &generation);
+      if(generation!=m_generation)
+      {
+        clear();
+        m_generation = generation;
+      }
+      const std::size_t wanted = (std::min)((std::max)(m_peak, bytes), limit);
+      if(wanted>m_capacity && bytes<=wanted)
+      {
+        clear();
+        check_that_malloc_is_allowed();
+        EIGEN_INSTRUMENT_ALLOCATION(wanted);
+        m_data = static_cast<char*>(handmade_aligned_malloc(wanted, Alignment));
+        m_capacity = m_data ? wanted : 0;
+      }
+      m_peak = (std::max)(m_peak, bytes);
+    }
+
+    char* m_data;
+    std::size_t m_capacity;
+    std::size_t m_top;
+    std::size_t m_live;
+    std::size_t m_peak;
+    unsigned m_generation;
+};
+
+/** \internal \returns the scratch arena of the calling thread */
+inline scratch_arena& thread_scratch_arena()
+{
+  static thread_local scratch_arena arena;
+  return arena;
+}
+
+/** \internal Allocates \a bytes bytes of aligned temporary memory, from the scratch arena of the calling thread
+  * when possible. The buffer must be freed by scratch_free() on the same thread. */
+inline void* scratch_malloc(std::size_t bytes)
+{
+  void* ptr = thread_scratch_arena().allocate(bytes);
+  return ptr ? ptr : aligned_malloc(bytes);
+}
+
+/** \internal Frees the buffer \a ptr of \a bytes bytes returned by scratch_malloc() */
+inline void scratch_free(void* ptr, std::size_t bytes)
+{
+  scratch_arena& arena = thread_scratch_arena();
+  if(arena.owns(ptr))
+    arena.release(ptr, bytes);
+  else
+    aligned_free(ptr);
+}
+
+#else
+
+EIGEN_DEVICE_FUNC inline void* scratch_malloc(std::size_t bytes) { return aligned_malloc(bytes); }
+EIGEN_DEVICE_FUNC inline void scratch_free(void* ptr, std::size_t) { aligned_free(ptr); }
+
+#endif // EIGEN_HAS_SCRATCH_ARENA
+
+/** \internal Constructs \a size objects of type T in memory taken by scratch_malloc() */
+template<typename T> EIGEN_DEVICE_FUNC inline T* scratch_new(std::size_t size)
+{
+  check_size_for_overflow<T>(size);
+  T *result = reinterpret_cast<T*>(scratch_malloc(sizeof(T)*size));
+  EIGEN_TRY
+  {
+    return construct_elements_of_array(result, size);
+  }
+  EIGEN_CATCH(...)
+  {
+    scratch_free(result, sizeof(T)*size);
+    EIGEN_THROW;
+  }
+  return result;
+}
+
+/** \internal Deletes objects constructed with scratch_new */
+template<typename T> EIGEN_DEVICE_FUNC inline void scratch_delete(T *ptr, std::size_t size)
+{
+  destruct_elements_of_array<T>(ptr, size);
+  scratch_free(ptr, sizeof(T)*size);
+}
+
 // This helper class construct the allocated memory, and takes care of destructing and freeing the handled data
 // at destruction time. In practice this helper class is mainly useful to avoid memory leak in case of exceptions.
 template<typename T> class aligned_stack_memory_handler : noncopyable
@@ -625,7 +1234,7 @@ template<typename T> class aligned_stack_memory_handler : noncopyable
       if(NumTraits<T>::RequireInitialization && m_ptr)
         Eigen::internal::destruct_elements_of_array<T>(m_ptr, m_size);
       if(m_deallocate)
-        Eigen::internal::aligned_free(m_ptr);
+        Eigen::internal::scratch_free(m_ptr, sizeof(T)*m_size);
     }
   protected:
     T* m_ptr;
@@ -713,12 +1322,102 @@ template<typename T> void swap(scoped_array<T> &a,scoped_array<T> &b)
 
 } // end namespace internal
 
+#if EIGEN_HAS_SCRATCH_ARENA
+
+/** Sets to \a bytes the maximal size of the scratch arena of each thread, and releases the arenas.
+  *
+  * The packed blocks of the matrix products and the temporary buffers of the solvers and of other algorithms
+  * which are too large for the stack (see EIGEN_STACK_ALLOCATION_LIMIT) are taken from an arena owned by the
+  * calling thread. The arena grows to the largest amount of memory requested at once, up to this limit, and
+  * is then reused by the following products, without calls to malloc or page faults. Requests beyond the
+  * limit are served by the heap. The default limit is EIGEN_SCRATCH_ARENA_LIMIT, 64 MB, and a limit of 0
+  * disables the arenas.
+  *
+  * \sa releaseScratchArenas(), scratchArenaSize()
+  */
+inline void setScratchArenaLimit(std::size_t bytes)
+{
+  internal::manage_scratch_arenas(SetAction, &bytes, 0);
+}
+
+/** \returns the maximal size of the scratch arena of each thread \sa setScratchArenaLimit() */
+inline std::size_t scratchArenaLimit()
+{
+  std::size_t limit;
+  unsigned generation;
+  internal::manage_scratch_arenas(GetAction, &limit, &generation);
+  return limit;
+}
+
+/** Releases the memory of the scratch arenas: the one of the calling thread right away if it is not in use,
+  * and the ones of the other threads the next time they use them. The threads exiting release theirs.
+  *
+  * \sa setScratchArenaLimit()
+  */
+inline void releaseScratchArenas()
+{
+  internal::manage_scratch_arenas(SetAction, 0, 0);
+  internal::thread_scratch_arena().clear();
+}
+
+/** \returns the size of the scratch arena of the calling thread \sa setScratchArenaLimit() */
+inline std::size_t scratchArenaSize()
+{
+  return internal::thread_scratch_arena().capacity();
+}
+
+#endif // EIGEN_HAS_SCRATCH_ARENA
+
+#if EIGEN_HAS_LARGE_PAGES
+
+/** Sets the policy applied to the allocations of the coefficients of dynamic-size matrices and arrays of at least
+  * \a bytes bytes, 0 disabling it, which is the default.
+  *
+  * Such allocations are aligned on EIGEN_LARGE_PAGE_SIZE, 2 MB, and advised with madvise(MADV_HUGEPAGE) to be
+  * backed by transparent huge pages, which saves most of the TLB misses of the traversals of multi-gigabyte
+  * matrices. Their pages are then touched first by the threads chosen by \a firstTouch, which on NUMA systems
+  * places each page on the node of the thread touching it:
+  * \code
+  * setLargeAllocationPolicy(64 << 20, BlockedFirstTouch);
+  * MatrixXf A(40000, 40000); // the column blocks of A are local to the threads of the products
+  * \endcode
+  * The coefficients taken from a ScopedMemoryResource are left alone. This is available on Linux.
+  *
+  * \sa FirstTouchPolicy, largeAllocationThreshold()
+  */
+inline void setLargeAllocationPolicy(std::size_t bytes, FirstTouchPolicy firstTouch = NoFirstTouch)
+{
+  int policy = firstTouch;
+  internal::manage_large_allocations(SetAction, &bytes, &policy);
+}
+
+/** \returns the size from which the policy set by setLargeAllocationPolicy() applies, 0 if it is disabled */
+inline std::size_t largeAllocationThreshold()
+{
+  std::size_t threshold;
+  int firstTouch;
+  internal::manage_large_allocations(GetAction, &threshold, &firstTouch);
+  return threshold;
+}
+
+/** \returns the FirstTouchPolicy of the large allocations \sa setLargeAllocationPolicy() */
+inline FirstTouchPolicy largeAllocationFirstTouch()
+{
+  std::size_t threshold;
+  int firstTouch;
+  internal::manage_large_allocations(GetAction, &threshold, &firstTouch);
+  return FirstTouchPolicy(firstTouch);
+}
+
+#endif // EIGEN_HAS_LARGE_PAGES
+
 /** \internal
   *
   * The macro ei_declare_aligned_stack_constructed_variable(TYPE,NAME,SIZE,BUFFER) declares, allocates,
   * and construct an aligned buffer named NAME of SIZE elements of type TYPE on the stack
   * if the size in bytes is smaller than EIGEN_STACK_ALLOCATION_LIMIT, and if stack allocation is supported by the platform
-  * (currently, this is Linux, OSX and Visual Studio only). Otherwise the memory is allocated on the heap.
+  * (currently, this is Linux, OSX and Visual Studio only). Otherwise the memory is taken from the scratch arena
+  * of the calling thread, or allocated on the heap when the arena cannot hold it (see setScratchArenaLimit()).
   * The allocated buffer is automatically deleted when exiting the scope of this declaration.
   * If BUFFER is non null, then the declared variable is simply an alias for BUFFER, and no allocation/deletion occurs.
   * Here is an example:
@@ -753,7 +1452,7 @@ template<typename T> void swap(scoped_array<T> &a,scoped_array<T> &b)
     TYPE* NAME = (BUFFER)!=0 ? (BUFFER) \
                : reinterpret_cast<TYPE*>( \
                       (sizeof(TYPE)*SIZE<=EIGEN_STACK_ALLOCATION_LIMIT) ? EIGEN_ALIGNED_ALLOCA(sizeof(TYPE)*SIZE) \
-                    : Eigen::internal::aligned_malloc(sizeof(TYPE)*SIZE) );  \
+                    : Eigen::internal::scratch_malloc(sizeof(TYPE)*SIZE) );  \
     Eigen::internal::aligned_stack_memory_handler<TYPE> EIGEN_CAT(NAME,_stack_memory_destructor)((BUFFER)==0 ? NAME : 0,SIZE,sizeof(TYPE)*SIZE>EIGEN_STACK_ALLOCATION_LIMIT)
 
 
@@ -767,7 +1466,7 @@ template<typename T> void swap(scoped_array<T> &a,scoped_array<T> &b)
 
   #define ei_declare_aligned_stack_constructed_variable(TYPE,NAME,SIZE,BUFFER) \
     Eigen::internal::check_size_for_overflow<TYPE>(SIZE); \
-    TYPE* NAME = (BUFFER)!=0 ? BUFFER : reinterpret_cast<TYPE*>(Eigen::internal::aligned_malloc(sizeof(TYPE)*SIZE));    \
+    TYPE* NAME = (BUFFER)!=0 ? BUFFER : reinterpret_cast<TYPE*>(Eigen::internal::scratch_malloc(sizeof(TYPE)*SIZE));    \
     Eigen::internal::aligned_stack_memory_handler<TYPE> EIGEN_CAT(NAME,_stack_memory_destructor)((BUFFER)==0 ? NAME : 0,SIZE,true)
 
 
@@ -1156,6 +1855,179 @@ inline int queryTopLevelCacheSize()
   return (std::max)(l2,l3);
 }
 
+/** \internal Sizes and sharing of the data caches of the host.
+  *
+  * For each level l in 1..3, size[l] is the size in Bytes of one instance of the level l data (or unified)
+  * cache, and shared[l] the number of logical cpus sharing such an instance, e.g., the SMT siblings of a core
+  * for a per-core L2 cache, or all the cores of a socket or of a core complex for a L3 cache. On hybrid cpus,
+  * the smallest instance of each level is reported. Unknown values are 0. Without sysfs, the numbers of
+  * logical cpus and of cores are the ones of a single package, as reported by cpuid.
+  */
+struct CacheTopology
+{
+  CacheTopology() : cpus(0), cores(0)
+  {
+    for(int l=0; l<4; ++l)
+      size[l] = shared[l] = 0;
+  }
+
+  int size[4];
+  int shared[4];
+  int cpus;   // number of online logical cpus
+  int cores;  // number of online physical cores
+};
+
+// \returns the number of cpus of a list of cpus such as "0-3,8,10-11", and calls f(cpu) for each of them if f is given
+inline int parse_cpu_list(const char* list, void (*f)(int, void*) = 0, void* data = 0)
+{
+  int count = 0;
+  const char* p = list;
+  while(*p>='0' && *p<='9')
+  {
+    char* end;
+    const long first = std::strtol(p, &end, 10);
+    long last = first;
+    if(*end=='-')
+      last = std::strtol(end+1, &end, 10);
+    for(long cpu=first; cpu<=last; ++cpu, ++count)
+      if(f!=0)
+        f(int(cpu), data);
+    p = (*end==',') ? end+1 : end;
+  }
+  return count;
+}
+
+// reads the first line of a file into line, \returns false if the file cannot be read
+inline bool read_sysfs_line(const char* path, char* line, int size)
+{
+  std::FILE* file = std::fopen(path, "r");
+  if(file==0)
+    return false;
+  const bool ok = std::fgets(line, size, file)!=0;
+  std::fclose(file);
+  return ok;
+}
+
+inline void query_cache_topology_sysfs_cpu(int cpu, void* data)
+{
+  CacheTopology& topology = *static_cast<CacheTopology*>(data);
+  char path[128], line[256];
+
+  std::sprintf(path, "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+  // the cores are counted once, by their first logical cpu
+  if(read_sysfs_line(path, line, sizeof(line)) && std::strtol(line, 0, 10)==cpu)
+    ++topology.cores;
+
+  for(int index=0; index<16; ++index)
+  {
+    std::sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+    if(!read_sysfs_line(path, line, sizeof(line)))
+      break;
+    const int level = int(std::strtol(line, 0, 10));
+    std::sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/type", cpu, index);
+    if(level<1 || level>3 || !read_sysfs_line(path, line, sizeof(line)) || std::strncmp(line, "Instruction", 11)==0)
+      continue;
+
+    std::sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/size", cpu, index);
+    if(!read_sysfs_line(path, line, sizeof(line)))
+      continue;
+    char* unit;
+    long size = std::strtol(line, &unit, 10);
+    if(*unit=='K') size *= 1024;
+    else if(*unit=='M') size *= 1024*1024;
+    else if(*unit=='G') size *= 1024*1024*1024;
+    if(size<=0 || size>long(INT_MAX))
+      continue;
+
+    std::sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+    const int shared = read_sysfs_line(path, line, sizeof(line)) ? parse_cpu_list(line) : 0;
+    if(topology.size[level]==0 || size<topology.size[level])
+    {
+      topology.size[level] = int(size);
+      topology.shared[level] = shared;
+    }
+  }
+}
+
+/** \internal Fills \a topology from /sys/devices/system/cpu. \returns false if it is not available. */
+inline bool queryCacheTopology_sysfs(CacheTopology& topology)
+{
+#if EIGEN_OS_LINUX
+  char line[4096];
+  if(!read_sysfs_line("/sys/devices/system/cpu/online", line, sizeof(line)))
+    return false;
+  topology.cpus = parse_cpu_list(line, query_cache_topology_sysfs_cpu, &topology);
+  return topology.cpus>0 && topology.size[1]>0 && topology.size[2]>0;
+#else
+  EIGEN_UNUSED_VARIABLE(topology);
+  return false;
+#endif
+}
+
+/** \internal Fills \a topology with the cache sizes of queryCacheSizes(), and on x86 with the sharing of
+  * the caches reported by the deterministic cache parameters of cpuid (leaf 4), and with the logical cpus and
+  * the cores of one package reported by the extended topology enumeration (leaf 0xB) or by leaves 1 and 4. */
+inline void queryCacheTopology_cpuid(CacheTopology& topology)
+{
+  queryCacheSizes(topology.size[1], topology.size[2], topology.size[3]);
+  for(int l=1; l<4; ++l)
+    topology.size[l] = (std::max)(topology.size[l], 0);
+#ifdef EIGEN_CPUID
+  int abcd[4] = {0,0,0,0};
+  EIGEN_CPUID(abcd,0x0,0);
+  const int max_leaf = abcd[0];
+  if(max_leaf<1)
+    return;
+
+  int threads_per_core = 0;
+  if(max_leaf>=0xB)
+  {
+    EIGEN_CPUID(abcd,0xB,0);
+    if(((abcd[2] >> 8) & 0xFF)==1) // SMT level: B[15:0] = number of logical cpus per core
+      threads_per_core = abcd[1] & 0xFFFF;
+    EIGEN_CPUID(abcd,0xB,1);
+    if(((abcd[2] >> 8) & 0xFF)==2) // core level: B[15:0] = number of logical cpus per package
+      topology.cpus = abcd[1] & 0xFFFF;
+  }
+  if(topology.cpus<=0)
+  {
+    EIGEN_CPUID(abcd,0x1,0);
+    // B[23:16] = max number of logical cpus per package, valid if the HTT flag D[28] is set
+    topology.cpus = (abcd[3] & (1<<28)) ? ((abcd[1] >> 16) & 0xFF) : 1;
+  }
+  if(threads_per_core>0)
+    topology.cores = (std::max)(1, topology.cpus/threads_per_core);
+
+  if(max_leaf<4)
+    return;
+  for(int cache_id=0; cache_id<16; ++cache_id)
+  {
+    abcd[0] = abcd[1] = abcd[2] = abcd[3] = 0;
+    EIGEN_CPUID(abcd,0x4,cache_id);
+    const int cache_type = abcd[0] & 0x1F;
+    if(cache_type==0)
+      break;
+    if(cache_id==0 && topology.cores==0) // A[31:26] = max number of cores per package, minus 1
+      topology.cores = (std::min)(topology.cpus, ((abcd[0] >> 26) & 0x3F) + 1);
+    const int level = (abcd[0] & 0xE0) >> 5;
+    if((cache_type==1 || cache_type==3) && level>=1 && level<=3)
+      topology.shared[level] = ((abcd[0] >> 14) & 0xFFF) + 1; // A[25:14] = max number of logical cpus sharing the cache, minus 1
+  }
+#endif
+}
+
+/** \internal \returns the cache topology of the host, from /sys/devices/system/cpu when available, and cpuid otherwise */
+inline CacheTopology queryCacheTopology()
+{
+  CacheTopology topology;
+  if(!queryCacheTopology_sysfs(topology))
+  {
+    topology = CacheTopology();
+    queryCacheTopology_cpuid(topology);
+  }
+  return topology;
+}
+
 } // end namespace internal
 
 } // end namespace Eigen
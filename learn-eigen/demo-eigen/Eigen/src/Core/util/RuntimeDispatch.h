@@ -0,0 +1,283 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_RUNTIME_DISPATCH_H
+#define EIGEN_RUNTIME_DISPATCH_H
+
+/* Runtime selection of the instruction set of the hot kernels.
+ *
+ * The packet math of Eigen is fixed when a translation unit is compiled. When EIGEN_RUNTIME_DISPATCH
+ * is defined, the program may in addition link translation units built with Eigen/DispatchTarget,
+ * each of which compiles a fixed set of kernels (GEMM, GEMV, sum and dot product of float and double)
+ * for a higher instruction set, AVX2 or AVX-512. The first time a kernel is needed, the best table
+ * of kernels whose instruction sets are supported by the host is selected from cpuid, and the
+ * products and reductions of Eigen call its kernels instead of the compiled-in ones.
+ *
+ * A DispatchTarget translation unit builds its own copy of Eigen under another namespace name, so the
+ * table below lives outside of namespace Eigen and only involves builtin types: both sides see the
+ * exact same definition. The tables are weak symbols which are null when no such unit is linked in.
+ */
+
+// instruction sets a table of kernels has been compiled for
+#define EIGEN_DISPATCH_AVX        0x001
+#define EIGEN_DISPATCH_AVX2       0x002
+#define EIGEN_DISPATCH_FMA        0x004
+#define EIGEN_DISPATCH_F16C       0x008
+#define EIGEN_DISPATCH_AVX512F    0x010
+#define EIGEN_DISPATCH_AVX512DQ   0x020
+#define EIGEN_DISPATCH_AVX512BW   0x040
+#define EIGEN_DISPATCH_AVX512VL   0x080
+#define EIGEN_DISPATCH_AVX512VNNI 0x100
+#define EIGEN_DISPATCH_AVX512BF16 0x200
+#define EIGEN_DISPATCH_AVX512FP16 0x400
+
+struct eigen_dispatch_kernels
+{
+  // EIGEN_DISPATCH_* flags of the instruction sets the kernels use
+  unsigned int features;
+  // res += alpha * lhs * rhs, res being column-major, lhs (resp. rhs) being row-major when lhsRowMajor (resp. rhsRowMajor) is set
+  void (*sgemm)(std::ptrdiff_t rows, std::ptrdiff_t cols, std::ptrdiff_t depth,
+                const float* lhs, std::ptrdiff_t lhsStride, int lhsRowMajor,
+                const float* rhs, std::ptrdiff_t rhsStride, int rhsRowMajor,
+                float* res, std::ptrdiff_t resStride, float alpha);
+  void (*dgemm)(std::ptrdiff_t rows, std::ptrdiff_t cols, std::ptrdiff_t depth,
+                const double* lhs, std::ptrdiff_t lhsStride, int lhsRowMajor,
+                const double* rhs, std::ptrdiff_t rhsStride, int rhsRowMajor,
+                double* res, std::ptrdiff_t resStride, double alpha);
+  // res += alpha * lhs * rhs, rhs and res being vectors
+  void (*sgemv)(std::ptrdiff_t rows, std::ptrdiff_t cols, const float* lhs, std::ptrdiff_t lhsStride, int lhsRowMajor,
+                const float* rhs, std::ptrdiff_t rhsIncr, float* res, std::ptrdiff_t resIncr, float alpha);
+  void (*dgemv)(std::ptrdiff_t rows, std::ptrdiff_t cols, const double* lhs, std::ptrdiff_t lhsStride, int lhsRowMajor,
+                const double* rhs, std::ptrdiff_t rhsIncr, double* res, std::ptrdiff_t resIncr, double alpha);
+  // sum of the n contiguous coefficients of x
+  float (*ssum)(std::ptrdiff_t n, const float* x);
+  double (*dsum)(std::ptrdiff_t n, const double* x);
+  // dot product of the n contiguous coefficients of x and y
+  float (*sdot)(std::ptrdiff_t n, const float* x, const float* y);
+  double (*ddot)(std::ptrdiff_t n, const double* x, const double* y);
+};
+
+#ifdef EIGEN_HAS_RUNTIME_DISPATCH
+
+extern "C" const eigen_dispatch_kernels eigen_dispatch_kernels_avx2 __attribute__((weak));
+extern "C" const eigen_dispatch_kernels eigen_dispatch_kernels_avx512 __attribute__((weak));
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal \returns the EIGEN_DISPATCH_* instruction sets supported by both the cpu and the operating system */
+inline unsigned int cpu_dispatch_features()
+{
+  int abcd[4] = {0,0,0,0};
+  EIGEN_CPUID(abcd,0x0,0);
+  const int max_leaf = abcd[0];
+  if(max_leaf<1)
+    return 0;
+  EIGEN_CPUID(abcd,0x1,0);
+  const unsigned int ecx1 = abcd[2];
+  // the AVX registers must be enabled by the operating system (OSXSAVE, then XCR0)
+  if(!(ecx1 & (1u<<27)) || !(ecx1 & (1u<<28)))
+    return 0;
+  unsigned int xcr0, xcr0_high;
+  __asm__ __volatile__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0_high) : "c" (0));
+  EIGEN_UNUSED_VARIABLE(xcr0_high);
+  if((xcr0 & 0x6)!=0x6)
+    return 0;
+
+  unsigned int features = EIGEN_DISPATCH_AVX;
+  if(ecx1 & (1u<<12)) features |= EIGEN_DISPATCH_FMA;
+  if(ecx1 & (1u<<29)) features |= EIGEN_DISPATCH_F16C;
+  if(max_leaf<7)
+    return features;
+
+  EIGEN_CPUID(abcd,0x7,0);
+  const unsigned int ebx7 = abcd[1], ecx7 = abcd[2], edx7 = abcd[3];
+  const int max_subleaf = abcd[0];
+  if(ebx7 & (1u<<5)) features |= EIGEN_DISPATCH_AVX2;
+  // the opmask and upper zmm registers must be enabled as well
+  if((xcr0 & 0xe0)==0xe0 && (ebx7 & (1u<<16)))
+  {
+    features |= EIGEN_DISPATCH_AVX512F;
+    if(ebx7 & (1u<<17)) features |= EIGEN_DISPATCH_AVX512DQ;
+    if(ebx7 & (1u<<30)) features |= EIGEN_DISPATCH_AVX512BW;
+    if(ebx7 & (1u<<31)) features |= EIGEN_DISPATCH_AVX512VL;
+    if(ecx7 & (1u<<11)) features |= EIGEN_DISPATCH_AVX512VNNI;
+    if(edx7 & (1u<<23)) features |= EIGEN_DISPATCH_AVX512FP16;
+    if(max_subleaf>=1)
+    {
+      EIGEN_CPUID(abcd,0x7,1);
+      if(abcd[0] & (1u<<5)) features |= EIGEN_DISPATCH_AVX512BF16;
+    }
+  }
+  return features;
+}
+
+/** \internal \returns the table of kernels to use, or a null pointer to use the compiled-in kernels.
+  *
+  * The tables linked in are tried from the highest instruction set down, skipping the ones which are not
+  * higher than the instruction set Eigen is compiled for. The environment variable \c EIGEN_DISPATCH caps
+  * the choice: \c avx512 (the default) allows any table, \c avx2 the AVX2 one only, and \c none disables
+  * the dispatch. */
+inline const eigen_dispatch_kernels* select_dispatch_kernels()
+{
+#if defined(EIGEN_VECTORIZE_AVX512)
+  const int compiled_level = 2;
+#elif defined(EIGEN_VECTORIZE_AVX2)
+  const int compiled_level = 1;
+#else
+  const int compiled_level = 0;
+#endif
+  int max_level = 2;
+  if(const char* env = std::getenv("EIGEN_DISPATCH"))
+  {
+    if(std::strcmp(env,"none")==0)        max_level = 0;
+    else if(std::strcmp(env,"avx2")==0)   max_level = 1;
+    else if(std::strcmp(env,"avx512")==0) max_level = 2;
+  }
+
+  const eigen_dispatch_kernels* candidates[2] = { &eigen_dispatch_kernels_avx512, &eigen_dispatch_kernels_avx2 };
+  const unsigned int host_features = cpu_dispatch_features();
+  for(int level=2; level>compiled_level; --level)
+  {
+    const eigen_dispatch_kernels* kernels = candidates[2-level];
+    if(level<=max_level && kernels!=0 && (kernels->features & ~host_features)==0)
+      return kernels;
+  }
+  return 0;
+}
+
+/** \internal \returns the kernels selected at the first call by select_dispatch_kernels() */
+inline const eigen_dispatch_kernels* dispatch_kernels()
+{
+  static const eigen_dispatch_kernels* kernels = select_dispatch_kernels();
+  return kernels;
+}
+
+/** \internal Access to the entries of a table of kernels by scalar type. Only \c float and \c double are dispatched. */
+template<typename Scalar> struct dispatch_traits { enum { Supported = 0 }; };
+
+template<typename Scalar> struct dispatch_kernel_types
+{
+  typedef void (*Gemm)(std::ptrdiff_t, std::ptrdiff_t, std::ptrdiff_t, const Scalar*, std::ptrdiff_t, int,
+                       const Scalar*, std::ptrdiff_t, int, Scalar*, std::ptrdiff_t, Scalar);
+  typedef void (*Gemv)(std::ptrdiff_t, std::ptrdiff_t, const Scalar*, std::ptrdiff_t, int,
+                       const Scalar*, std::ptrdiff_t, Scalar*, std::ptrdiff_t, Scalar);
+};
+
+template<> struct dispatch_traits<float> : dispatch_kernel_types<float>
+{
+  enum { Supported = 1 };
+  static Gemm gemm(const eigen_dispatch_kernels& k) { return k.sgemm; }
+  static Gemv gemv(const eigen_dispatch_kernels& k) { return k.sgemv; }
+  static float sum(const eigen_dispatch_kernels& k, std::ptrdiff_t n, const float* x) { return k.ssum(n, x); }
+  static float dot(const eigen_dispatch_kernels& k, std::ptrdiff_t n, const float* x, const float* y) { return k.sdot(n, x, y); }
+};
+
+template<> struct dispatch_traits<double> : dispatch_kernel_types<double>
+{
+  enum { Supported = 1 };
+  static Gemm gemm(const eigen_dispatch_kernels& k) { return k.dgemm; }
+  static Gemv gemv(const eigen_dispatch_kernels& k) { return k.dgemv; }
+  static double sum(const eigen_dispatch_kernels& k, std::ptrdiff_t n, const double* x) { return k.dsum(n, x); }
+  static double dot(const eigen_dispatch_kernels& k, std::ptrdiff_t n, const double* x, const double* y) { return k.ddot(n, x, y); }
+};
+
+/** \internal \returns a pointer to the coefficients of \a x when they are contiguous in memory, and a null pointer otherwise.
+  * The flags of the evaluator are checked as well since some expressions, e.g., IndexedView, have the DirectAccessBit
+  * without data(). */
+template<typename Derived, bool HasDirectAccess = (int(traits<Derived>::Flags) & int(evaluator<Derived>::Flags) & DirectAccessBit)!=0>
+struct dispatch_contiguous_data
+{
+  static const typename traits<Derived>::Scalar* run(const Derived&) { return 0; }
+};
+
+template<typename Derived>
+struct dispatch_contiguous_data<Derived,true>
+{
+  static const typename traits<Derived>::Scalar* run(const Derived& x)
+  {
+    const bool contiguous = x.innerStride()==1 && (x.outerSize()==1 || x.outerStride()==x.innerSize());
+    return contiguous ? x.data() : 0;
+  }
+};
+
+// below this number of coefficients, the compiled-in reductions are inlined and faster than a call through the table
+enum { DispatchMinReduxSize = 64 };
+
+/** \internal Computes the sum of \a x with the selected kernels. \returns false when no kernel applies. */
+template<typename Derived, bool Supported = dispatch_traits<typename traits<Derived>::Scalar>::Supported!=0>
+struct dispatched_sum
+{
+  static bool run(const Derived&, typename traits<Derived>::Scalar&) { return false; }
+};
+
+template<typename Derived>
+struct dispatched_sum<Derived,true>
+{
+  typedef typename traits<Derived>::Scalar Scalar;
+  static bool run(const Derived& x, Scalar& res)
+  {
+    if(x.size()<DispatchMinReduxSize)
+      return false;
+    const eigen_dispatch_kernels* kernels = dispatch_kernels();
+    const Scalar* data = dispatch_contiguous_data<Derived>::run(x);
+    if(kernels==0 || data==0)
+      return false;
+    res = dispatch_traits<Scalar>::sum(*kernels, x.size(), data);
+    return true;
+  }
+};
+
+/** \internal Computes the dot product of \a x and \a y with the selected kernels. \returns false when no kernel applies. */
+template<typename T, typename U,
+         bool Supported = dispatch_traits<typename traits<T>::Scalar>::Supported!=0
+                       && is_same<typename traits<T>::Scalar, typename traits<U>::Scalar>::value>
+struct dispatched_dot
+{
+  static bool run(const T&, const U&, typename traits<T>::Scalar&) { return false; }
+};
+
+template<typename T, typename U>
+struct dispatched_dot<T,U,true>
+{
+  typedef typename traits<T>::Scalar Scalar;
+  static bool run(const T& x, const U& y, Scalar& res)
+  {
+    if(x.size()<DispatchMinReduxSize)
+      return false;
+    const eigen_dispatch_kernels* kernels = dispatch_kernels();
+    const Scalar* xData = dispatch_contiguous_data<T>::run(x);
+    const Scalar* yData = dispatch_contiguous_data<U>::run(y);
+    if(kernels==0 || xData==0 || yData==0)
+      return false;
+    res = dispatch_traits<Scalar>::dot(*kernels, x.size(), xData, yData);
+    return true;
+  }
+};
+
+} // end namespace internal
+
+/** \returns the name of the instruction set of the kernels selected at runtime: \c "avx512", \c "avx2", or
+  * \c "none" when the kernels compiled in the current translation unit are used.
+  *
+  * This function is only available when \c EIGEN_RUNTIME_DISPATCH is defined.
+  *
+  * \sa Eigen/DispatchTarget */
+inline const char* dispatchedInstructionSet()
+{
+  const eigen_dispatch_kernels* kernels = internal::dispatch_kernels();
+  if(kernels!=0 && kernels==&eigen_dispatch_kernels_avx512) return "avx512";
+  if(kernels!=0 && kernels==&eigen_dispatch_kernels_avx2)   return "avx2";
+  return "none";
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_HAS_RUNTIME_DISPATCH
+
+#endif // EIGEN_RUNTIME_DISPATCH_H
@@ -106,7 +106,8 @@
         SELFADJOINTVIEW_ACCEPTS_UPPER_AND_LOWER_MODE_ONLY=1,
         INVALID_TEMPLATE_PARAMETER=1,
         GPU_TENSOR_CONTRACTION_DOES_NOT_SUPPORT_OUTPUT_KERNELS=1,
-        THE_ARRAY_SIZE_SHOULD_EQUAL_WITH_PACKET_SIZE=1
+        THE_ARRAY_SIZE_SHOULD_EQUAL_WITH_PACKET_SIZE=1,
+        THE_PACKED_MATRIX_WAS_PACKED_FOR_THE_OTHER_SIDE_OF_THE_PRODUCT=1
       };
     };
 
@@ -293,7 +293,7 @@ template<typename XprType> struct size_of_xpr_at_compile_time
  */
 
 template<typename T, typename StorageKind = typename traits<T>::StorageKind> struct plain_matrix_type;
-template<typename T, typename BaseClassType, int Flags> struct plain_matrix_type_dense;
+template<typename T, typename BaseClassType, int Flags, int InlineOptions = 0> struct plain_matrix_type_dense;
 template<typename T> struct plain_matrix_type<T,Dense>
 {
   typedef typename plain_matrix_type_dense<T,typename traits<T>::XprKind, traits<T>::Flags>::type type;
@@ -303,28 +303,49 @@ template<typename T> struct plain_matrix_type<T,DiagonalShape>
   typedef typename T::PlainObject type;
 };
 
-template<typename T, int Flags> struct plain_matrix_type_dense<T,MatrixXpr,Flags>
+template<typename T, int Flags, int InlineOptions> struct plain_matrix_type_dense<T,MatrixXpr,Flags,InlineOptions>
 {
   typedef Matrix<typename traits<T>::Scalar,
                 traits<T>::RowsAtCompileTime,
                 traits<T>::ColsAtCompileTime,
-                AutoAlign | (Flags&RowMajorBit ? RowMajor : ColMajor),
+                AutoAlign | (Flags&RowMajorBit ? RowMajor : ColMajor) | InlineOptions,
                 traits<T>::MaxRowsAtCompileTime,
                 traits<T>::MaxColsAtCompileTime
           > type;
 };
 
-template<typename T, int Flags> struct plain_matrix_type_dense<T,ArrayXpr,Flags>
+template<typename T, int Flags, int InlineOptions> struct plain_matrix_type_dense<T,ArrayXpr,Flags,InlineOptions>
 {
   typedef Array<typename traits<T>::Scalar,
                 traits<T>::RowsAtCompileTime,
                 traits<T>::ColsAtCompileTime,
-                AutoAlign | (Flags&RowMajorBit ? RowMajor : ColMajor),
+                AutoAlign | (Flags&RowMajorBit ? RowMajor : ColMajor) | InlineOptions,
                 traits<T>::MaxRowsAtCompileTime,
                 traits<T>::MaxColsAtCompileTime
           > type;
 };
 
+/* aliasing_temporary_type : the type of the temporary evaluating the source of an assignment which may alias
+ * its destination. This is the plain type of the source, with the inline buffer of a destination declared
+ * with InlineStorage, so that assigning, e.g., a small product to such a matrix does not allocate.
+ */
+template<typename Dst, typename Src, typename StorageKind = typename traits<Src>::StorageKind> struct aliasing_temporary_type
+{
+  typedef typename plain_matrix_type<Src>::type type;
+};
+
+template<typename _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols, typename Src>
+struct aliasing_temporary_type<Matrix<_Scalar,_Rows,_Cols,_Options,_MaxRows,_MaxCols>, Src, Dense>
+{
+  typedef typename plain_matrix_type_dense<Src,typename traits<Src>::XprKind,traits<Src>::Flags,_Options & ~0xff>::type type;
+};
+
+template<typename _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols, typename Src>
+struct aliasing_temporary_type<Array<_Scalar,_Rows,_Cols,_Options,_MaxRows,_MaxCols>, Src, Dense>
+{
+  typedef typename plain_matrix_type_dense<Src,typename traits<Src>::XprKind,traits<Src>::Flags,_Options & ~0xff>::type type;
+};
+
 /* eval : the return type of eval(). For matrices, this is just a const reference
  * in order to avoid a useless copy
  */
@@ -0,0 +1,157 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_MAPPED_NPY_FILE_H
+#define EIGEN_MAPPED_NPY_FILE_H
+
+namespace Eigen {
+
+/** \class MappedNpyFile
+  * \ingroup NpyIO_Module
+  *
+  * \brief A read-only .npy file whose array is accessed in place through a Map
+  *
+  * On POSIX systems, the file is mapped in memory by mmap, so that opening it neither copies nor parses
+  * its coefficients, which are paged in on first access and shared with the page cache:
+  * \code
+  * MappedNpyFile file("weights.npy");
+  * if(file.isOpen() && file.isCompatible<MatrixXf>())
+  *   y.noalias() = file.map<MatrixXf>() * x;
+  * \endcode
+  * Elsewhere, the whole file is read into memory by a single call to fread.
+  *
+  * The Map returned by map() is valid as long as the file is open. Since the .npy writers pad the header
+  * to a multiple of 16 or 64 bytes, the coefficients are usually aligned, but the Map does not assume it.
+  *
+  * \sa saveNpy(), loadNpy()
+  */
+class MappedNpyFile
+{
+  public:
+    MappedNpyFile() : m_bytes(0), m_size(0) {}
+
+    /** Opens the .npy file \a filename, isOpen() telling whether it succeeded */
+    explicit MappedNpyFile(const char* filename) : m_bytes(0), m_size(0) { open(filename); }
+
+    ~MappedNpyFile() { close(); }
+
+    /** Closes the current file if any, and opens the .npy file \a filename.
+      * \returns false, leaving the object closed, if the file cannot be read, is not a .npy file, or holds
+      * an array of more than two dimensions */
+    bool open(const char* filename)
+    {
+      close();
+#if EIGEN_NPYIO_HAS_MMAP
+      const int fd = ::open(filename, O_RDONLY);
+      if(fd<0)
+        return false;
+      struct stat status;
+      void* bytes = MAP_FAILED;
+      if(::fstat(fd, &status)==0 && status.st_size>0)
+        bytes = ::mmap(0, std::size_t(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+      // the mapping keeps the file alive
+      ::close(fd);
+      if(bytes==MAP_FAILED)
+        return false;
+      m_bytes = static_cast<unsigned char*>(bytes);
+      m_size = std::size_t(status.st_size);
+#else
+      std::FILE* file = std::fopen(filename, "rb");
+      if(file==0)
+        return false;
+      long size = -1;
+      if(std::fseek(file, 0, SEEK_END)==0 && (size = std::ftell(file))>0 && std::fseek(file, 0, SEEK_SET)==0)
+      {
+        m_bytes = static_cast<unsigned char*>(internal::aligned_malloc(std::size_t(size)));
+        m_size = std::size_t(size);
+        if(std::fread(m_bytes, 1, m_size, file)!=m_size)
+          close();
+      }
+      std::fclose(file);
+      if(m_bytes==0)
+        return false;
+#endif
+      const std::size_t dataOffset = internal::npy_data_offset(m_bytes, m_size);
+      if(dataOffset==0 || dataOffset>m_size || !internal::npy_parse_header(m_bytes, dataOffset, m_header))
+      {
+        close();
+        return false;
+      }
+      return true;
+    }
+
+    /** Unmaps the current file, invalidating the maps returned by map() */
+    void close()
+    {
+      if(m_bytes==0)
+        return;
+#if EIGEN_NPYIO_HAS_MMAP
+      ::munmap(m_bytes, m_size);
+#else
+      internal::aligned_free(m_bytes);
+#endif
+      m_bytes = 0;
+      m_size = 0;
+    }
+
+    bool isOpen() const { return m_bytes!=0; }
+
+    /** \returns the numpy descriptor of the scalar type, e.g., "<f4" */
+    const std::string& descr() const { eigen_assert(isOpen()); return m_header.descr; }
+
+    /** \returns the number of dimensions of the array: 0, 1 or 2 */
+    int dimensions() const { eigen_assert(isOpen()); return m_header.dimensions; }
+
+    /** \returns the extent of the \a i-th dimension of the array */
+    Index extent(int i) const { eigen_assert(isOpen() && i>=0 && i<m_header.dimensions); return m_header.shape[i]; }
+
+    /** \returns whether the array is stored in row-major order */
+    bool isRowMajor() const { eigen_assert(isOpen()); return !m_header.fortranOrder; }
+
+    /** \returns whether the file holds scalars of type \a Scalar in the byte order of the host */
+    template<typename Scalar>
+    bool holds() const { return isOpen() && internal::npy_holds<Scalar>(m_header.descr); }
+
+    /** \returns whether map<MatrixType>() can view the array: the scalar types must be the same, \a MatrixType
+      * must be able to have the shape of the array and, unless it is a vector, its storage order. One
+      * dimensional arrays are viewed as column vectors, or as row vectors when \a MatrixType is one at
+      * compile time. */
+    template<typename MatrixType>
+    bool isCompatible() const
+    {
+      Index rows, cols;
+      bool sameStorageOrder;
+      return holds<typename MatrixType::Scalar>()
+          && internal::npy_matrix_dimensions<MatrixType>(m_header, rows, cols, sameStorageOrder) && sameStorageOrder
+          && m_header.dataOffset<=m_size
+          && internal::npy_data_fits(rows, cols, sizeof(typename MatrixType::Scalar), m_size-m_header.dataOffset);
+    }
+
+    /** \returns a read-only view of the array of the file, without copying it
+      * \pre isCompatible<MatrixType>() */
+    template<typename MatrixType>
+    Map<const MatrixType> map() const
+    {
+      eigen_assert(isCompatible<MatrixType>() && "the array of the file cannot be viewed as a MatrixType");
+      Index rows, cols;
+      bool sameStorageOrder;
+      internal::npy_matrix_dimensions<MatrixType>(m_header, rows, cols, sameStorageOrder);
+      return Map<const MatrixType>(reinterpret_cast<const typename MatrixType::Scalar*>(m_bytes + m_header.dataOffset), rows, cols);
+    }
+
+  private:
+    MappedNpyFile(const MappedNpyFile&);
+    MappedNpyFile& operator=(const MappedNpyFile&);
+
+    unsigned char* m_bytes;
+    std::size_t m_size;
+    internal::npy_header m_header;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_MAPPED_NPY_FILE_H
@@ -0,0 +1,297 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_NPY_FORMAT_H
+#define EIGEN_NPY_FORMAT_H
+
+namespace Eigen {
+
+namespace internal {
+
+// type character and size of the numpy descriptor of Scalar, Kind being 0 for unsupported types
+template<typename Scalar, bool IsInteger = NumTraits<Scalar>::IsInteger, bool IsComplex = NumTraits<Scalar>::IsComplex>
+struct npy_scalar
+{
+  enum { Kind = 'f', Size = sizeof(Scalar) };
+};
+
+template<typename Scalar>
+struct npy_scalar<Scalar,true,false>
+{
+  enum { Kind = NumTraits<Scalar>::IsSigned ? 'i' : 'u', Size = sizeof(Scalar) };
+};
+
+template<typename Scalar>
+struct npy_scalar<Scalar,false,true>
+{
+  enum { Kind = 'c', Size = sizeof(Scalar) };
+};
+
+template<> struct npy_scalar<bool,true,false> { enum { Kind = 'b', Size = 1 }; };
+// numpy has no bfloat16, and '<f2' is half
+template<> struct npy_scalar<bfloat16,false,false> { enum { Kind = 0, Size = 2 }; };
+
+/** \internal \returns '<' on little endian hosts and '>' on big endian ones */
+inline char npy_byte_order()
+{
+  const numext::uint16_t one = 1;
+  return *reinterpret_cast<const unsigned char*>(&one)==1 ? '<' : '>';
+}
+
+/** \internal \returns the numpy descriptor of Scalar in the byte order of the host, e.g., "<f8" */
+template<typename Scalar>
+std::string npy_descr()
+{
+  EIGEN_STATIC_ASSERT(int(npy_scalar<Scalar>::Kind)!=0, THIS_TYPE_IS_NOT_SUPPORTED)
+  std::ostringstream descr;
+  descr << (npy_scalar<Scalar>::Size==1 ? '|' : npy_byte_order()) << char(npy_scalar<Scalar>::Kind) << int(npy_scalar<Scalar>::Size);
+  return descr.str();
+}
+
+/** \internal \returns whether the descriptor \a descr read from a file denotes Scalar in the byte order of the host */
+template<typename Scalar>
+bool npy_holds(const std::string& descr)
+{
+  const std::string expected = npy_descr<Scalar>();
+  if(descr.size()!=expected.size() || descr.compare(1, std::string::npos, expected, 1, std::string::npos)!=0)
+    return false;
+  return descr[0]==expected[0] || descr[0]=='=' || npy_scalar<Scalar>::Size==1;
+}
+
+// the part of the header of a .npy file the readers use
+struct npy_header
+{
+  std::string descr;
+  bool fortranOrder;
+  int dimensions;       // 0, 1 or 2, larger arrays being rejected
+  Index shape[2];
+  std::size_t dataOffset;
+};
+
+// the headers longer than NpyMaxHeaderSize bytes are rejected, as numpy does by default
+enum { NpyPreambleSize = 10, NpyHeaderAlignment = 64, NpyMaxHeaderSize = 10000 };
+
+/** \internal Reads the version and the header length from the \a size first bytes of a .npy file.
+  * \returns the offset of the data, or 0 if the bytes are not the start of a .npy file or announce a header
+  * longer than NpyMaxHeaderSize */
+inline std::size_t npy_data_offset(const unsigned char* bytes, std::size_t size)
+{
+  if(size<NpyPreambleSize || std::memcmp(bytes, "\x93NUMPY", 6)!=0)
+    return 0;
+  std::size_t length;
+  if(bytes[6]==1)
+    length = std::size_t(bytes[8]) | std::size_t(bytes[9])<<8;
+  else if((bytes[6]==2 || bytes[6]==3) && size>=NpyPreambleSize+2)
+    length = 2 + (std::size_t(bytes[8]) | std::size_t(bytes[9])<<8 | std::size_t(bytes[10])<<16 | std::size_t(bytes[11])<<24);
+  else
+    return 0;
+  return length<=std::size_t(NpyMaxHeaderSize) ? NpyPreambleSize + length : 0;
+}
+
+/** \internal Parses the header of a .npy file, \a bytes holding at least its \a dataOffset first bytes.
+  * \returns false if the header is malformed or describes an array of more than two dimensions */
+inline bool npy_parse_header(const unsigned char* bytes, std::size_t dataOffset, npy_header& header)
+{
+  const std::size_t begin = bytes[6]==1 ? std::size_t(NpyPreambleSize) : std::size_t(NpyPreambleSize+2);
+  const std::string dict(reinterpret_cast<const char*>(bytes) + begin, dataOffset - begin);
+  header.dataOffset = dataOffset;
+
+  std::size_t pos = dict.find("'descr'");
+  std::size_t open = pos==std::string::npos ? pos : dict.find('\'', dict.find(':', pos));
+  std::size_t close = open==std::string::npos ? open : dict.find('\'', open+1);
+  if(close==std::string::npos)
+    return false;
+  header.descr = dict.substr(open+1, close-open-1);
+
+  pos = dict.find("'fortran_order'");
+  if(pos==std::string::npos || (pos = dict.find_first_not_of(" :", pos+15))==std::string::npos)
+    return false;
+  header.fortranOrder = dict.compare(pos, 4, "True")==0;
+  if(!header.fortranOrder && dict.compare(pos, 5, "False")!=0)
+    return false;
+
+  pos = dict.find("'shape'");
+  open = pos==std::string::npos ? pos : dict.find('(', pos);
+  close = open==std::string::npos ? open : dict.find(')', open);
+  if(close==std::string::npos)
+    return false;
+  header.dimensions = 0;
+  const char* it = dict.c_str() + open + 1;
+  const char* end = dict.c_str() + close;
+  while(it<end)
+  {
+    char* next;
+    const long extent = std::strtol(it, &next, 10);
+    if(next==it)
+      break;
+    if(extent<0 || long(Index(extent))!=extent || header.dimensions==2)
+      return false;
+    header.shape[header.dimensions++] = Index(extent);
+    it = next;
+    while(it<end && (*it==',' || *it==' '))
+      ++it;
+  }
+  return it==end;
+}
+
+/** \internal \returns the numpy header of an array of Scalar of the given shape, padded so that the data
+  * starts on a multiple of 64 bytes */
+template<typename Scalar>
+std::string npy_make_header(bool fortranOrder, int dimensions, Index rows, Index cols)
+{
+  std::ostringstream dict;
+  dict << "{'descr': '" << npy_descr<Scalar>() << "', 'fortran_order': " << (fortranOrder ? "True" : "False") << ", 'shape': (";
+  if(dimensions==1)
+    dict << rows*cols << ",), }";
+  else
+    dict << rows << ", " << cols << "), }";
+  std::string header = "\x93NUMPY\x01";
+  header += '\0';
+  const std::size_t length = (NpyPreambleSize + dict.str().size() + 1 + NpyHeaderAlignment-1) / NpyHeaderAlignment * NpyHeaderAlignment;
+  const std::size_t headerLength = length - NpyPreambleSize;
+  header += char(headerLength & 0xff);
+  header += char(headerLength >> 8);
+  header += dict.str();
+  header.append(length - header.size() - 1, ' ');
+  header += '\n';
+  return header;
+}
+
+/** \internal Computes the dimensions of a MatrixType holding the array described by \a header.
+  * \returns false if such a matrix cannot hold it, or cannot share its storage order */
+template<typename MatrixType>
+bool npy_matrix_dimensions(const npy_header& header, Index& rows, Index& cols, bool& sameStorageOrder)
+{
+  if(header.dimensions==0)
+    rows = cols = 1;
+  else if(header.dimensions==1)
+  {
+    rows = MatrixType::RowsAtCompileTime==1 ? 1 : header.shape[0];
+    cols = MatrixType::RowsAtCompileTime==1 ? header.shape[0] : 1;
+  }
+  else
+  {
+    rows = header.shape[0];
+    cols = header.shape[1];
+  }
+  // the two storage orders coincide for vectors
+  sameStorageOrder = header.dimensions<2 || rows==1 || cols==1 || header.fortranOrder!=bool(MatrixType::IsRowMajor);
+  return (MatrixType::RowsAtCompileTime==Dynamic || MatrixType::RowsAtCompileTime==rows)
+      && (MatrixType::ColsAtCompileTime==Dynamic || MatrixType::ColsAtCompileTime==cols)
+      && (MatrixType::MaxRowsAtCompileTime==Dynamic || rows<=MatrixType::MaxRowsAtCompileTime)
+      && (MatrixType::MaxColsAtCompileTime==Dynamic || cols<=MatrixType::MaxColsAtCompileTime);
+}
+
+/** \internal \returns whether \a rows by \a cols coefficients of \a scalarSize bytes fit in \a available
+  * bytes, without overflowing on the huge shapes a corrupted header may announce */
+inline bool npy_data_fits(Index rows, Index cols, std::size_t scalarSize, std::size_t available)
+{
+  return rows>=0 && cols>=0
+      && (cols==0 || std::size_t(rows) <= available / scalarSize / std::size_t(cols));
+}
+
+} // end namespace internal
+
+/** \ingroup NpyIO_Module
+  *
+  * Writes \a m to the file \a filename in the .npy format of numpy (version 1.0): a header recording the
+  * scalar type, the shape and the storage order, padded to 64 bytes, followed by the coefficients in the
+  * storage order of \a m, written by a single call to fwrite. Vectors at compile time are written as one
+  * dimensional arrays, and everything else as two dimensional arrays. The scalars are written in the byte
+  * order of the host. Expressions other than plain matrices and arrays are evaluated first.
+  *
+  * \returns false if the file cannot be written
+  *
+  * \sa loadNpy(), class MappedNpyFile
+  */
+template<typename Derived>
+bool saveNpy(const char* filename, const DenseBase<Derived>& m)
+{
+  typedef typename Derived::Scalar Scalar;
+  typedef typename internal::remove_all<typename Derived::EvalReturnType>::type PlainObject;
+  const typename Derived::EvalReturnType plain = m.eval();
+  const bool isVector = Derived::IsVectorAtCompileTime;
+  const std::string header = internal::npy_make_header<Scalar>(!isVector && !PlainObject::IsRowMajor, isVector ? 1 : 2,
+                                                               plain.rows(), plain.cols());
+  std::FILE* file = std::fopen(filename, "wb");
+  if(file==0)
+    return false;
+  const std::size_t size = std::size_t(plain.size());
+  bool ok = std::fwrite(header.data(), 1, header.size(), file)==header.size();
+  ok = ok && (size==0 || std::fwrite(plain.data(), sizeof(Scalar), size, file)==size);
+  return std::fclose(file)==0 && ok;
+}
+
+/** \ingroup NpyIO_Module
+  *
+  * Reads the .npy file \a filename into \a m, which is resized to the shape of the stored array. The
+  * coefficients are read by a single call to fread straight into the storage of \a m, or into a temporary
+  * when the storage orders of the file and of \a m differ. One dimensional arrays are read into column
+  * vectors, or into row vectors when \a m is one at compile time.
+  *
+  * \returns false, leaving \a m in an unspecified state, if the file cannot be read, is not a .npy file,
+  * does not hold scalars of the type of \a m in the byte order of the host, or has a shape which \a m
+  * cannot have.
+  *
+  * \sa saveNpy(), class MappedNpyFile
+  */
+template<typename Derived>
+bool loadNpy(const char* filename, PlainObjectBase<Derived>& m)
+{
+  typedef typename Derived::Scalar Scalar;
+  std::FILE* file = std::fopen(filename, "rb");
+  if(file==0)
+    return false;
+  // the preamble of a version 2.0 file is 12 bytes long, and the shortest header is longer than that
+  std::vector<unsigned char> bytes(internal::NpyPreambleSize+2);
+  const std::size_t dataOffset = internal::npy_data_offset(&bytes[0], std::fread(&bytes[0], 1, bytes.size(), file));
+  internal::npy_header header;
+  Index rows, cols;
+  bool sameStorageOrder;
+  bool ok = dataOffset>bytes.size();
+  if(ok)
+  {
+    const std::size_t read = bytes.size();
+    bytes.resize(dataOffset);
+    ok = std::fread(&bytes[read], 1, dataOffset-read, file)==dataOffset-read
+      && internal::npy_parse_header(&bytes[0], dataOffset, header)
+      && internal::npy_holds<Scalar>(header.descr)
+      && internal::npy_matrix_dimensions<Derived>(header, rows, cols, sameStorageOrder);
+  }
+  if(ok)
+  {
+    // m is not resized to more coefficients than the file holds, when its size is known
+    std::size_t available = std::size_t(NumTraits<Index>::highest());
+    long end = -1;
+    if(std::fseek(file, 0, SEEK_END)==0 && (end = std::ftell(file))>=0)
+    {
+      available = std::size_t(end)>dataOffset ? std::size_t(end)-dataOffset : 0;
+      ok = std::fseek(file, long(dataOffset), SEEK_SET)==0;
+    }
+    ok = ok && internal::npy_data_fits(rows, cols, sizeof(Scalar), available);
+  }
+  if(ok)
+  {
+    m.resize(rows, cols);
+    const std::size_t size = std::size_t(m.size());
+    if(sameStorageOrder)
+      ok = size==0 || std::fread(m.data(), sizeof(Scalar), size, file)==size;
+    else
+    {
+      typedef Matrix<Scalar,Dynamic,Dynamic,Derived::IsRowMajor ? ColMajor : RowMajor> Transposed;
+      Transposed tmp(rows, cols);
+      ok = std::fread(tmp.data(), sizeof(Scalar), size, file)==size;
+      Map<Matrix<Scalar,Dynamic,Dynamic,Derived::IsRowMajor ? RowMajor : ColMajor> >(m.data(), rows, cols) = tmp;
+    }
+  }
+  std::fclose(file);
+  return ok;
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_NPY_FORMAT_H
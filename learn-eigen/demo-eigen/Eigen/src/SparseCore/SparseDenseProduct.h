@@ -36,21 +36,26 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, t
     LhsEval lhsEval(lhs);
     
     Index n = lhs.outerSize();
-#ifdef EIGEN_HAS_OPENMP
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
     Eigen::initParallel();
     Index threads = Eigen::nbThreads();
 #endif
     
     for(Index c=0; c<rhs.cols(); ++c)
     {
-#ifdef EIGEN_HAS_OPENMP
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
       // This 20000 threshold has been found experimentally on 2D and 3D Poisson problems.
       // It basically represents the minimal amount of work to be done to be worth it.
       if(threads>1 && lhsEval.nonZerosEstimate() > 20000)
       {
+#ifdef EIGEN_HAS_OPENMP
         #pragma omp parallel for schedule(dynamic,(n+threads*4-1)/(threads*4)) num_threads(threads)
         for(Index i=0; i<n; ++i)
           processRow(lhsEval,rhs,res,alpha,i,c);
+#else
+        internal::parallel_for_dynamic(n, threads, (n+threads*4-1)/(threads*4),
+                                       [&](Index i) { processRow(lhsEval,rhs,res,alpha,i,c); });
+#endif
       }
       else
 #endif
@@ -119,16 +124,21 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, t
     Index n = lhs.rows();
     LhsEval lhsEval(lhs);
 
-#ifdef EIGEN_HAS_OPENMP
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
     Eigen::initParallel();
     Index threads = Eigen::nbThreads();
     // This 20000 threshold has been found experimentally on 2D and 3D Poisson problems.
     // It basically represents the minimal amount of work to be done to be worth it.
     if(threads>1 && lhsEval.nonZerosEstimate()*rhs.cols() > 20000)
     {
+#ifdef EIGEN_HAS_OPENMP
       #pragma omp parallel for schedule(dynamic,(n+threads*4-1)/(threads*4)) num_threads(threads)
       for(Index i=0; i<n; ++i)
         processRow(lhsEval,rhs,res,alpha,i);
+#else
+      internal::parallel_for_dynamic(n, threads, (n+threads*4-1)/(threads*4),
+                                     [&](Index i) { processRow(lhsEval,rhs,res,alpha,i); });
+#endif
     }
     else
 #endif
@@ -0,0 +1,212 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_CORE_THREAD_POOL_DEVICE_H
+#define EIGEN_CORE_THREAD_POOL_DEVICE_H
+
+namespace Eigen {
+
+/** \class CoreThreadPoolDevice
+  * \ingroup ThreadPool_Module
+  *
+  * \brief A device evaluating the coefficients of dense expressions on the threads of a thread pool
+  *
+  * The assignments made through DenseBase::device() with this device split the coefficients of the
+  * destination into contiguous ranges, linear ones or ranges of inner slices (columns of a column-major
+  * matrix), each task being run by a thread of \c pool while the calling thread runs the last one.
+  * The number of tasks is deduced from the cost model of the evaluators: an assignment is split only
+  * when each task gets at least \c minTaskCost units of work, which is roughly a number of cycles.
+  * \code
+  * Eigen::ThreadPool pool(8);  // from unsupported/Eigen/CXX11/ThreadPool
+  * Eigen::CoreThreadPoolDevice device(pool);
+  * C.device(device) = (A.array() * B.array()).exp() + D.array();
+  * \endcode
+  *
+  * Assignments made from one of the threads of the pool run sequentially, since waiting for tasks
+  * queued behind the calling one could deadlock the pool. The pool is not owned by the device.
+  *
+  * \sa DenseBase::device(), class DeviceWrapper
+  */
+class CoreThreadPoolDevice
+{
+  public:
+    explicit CoreThreadPoolDevice(ThreadPoolInterface& pool, double minTaskCost = 40000.)
+      : m_pool(pool), m_minTaskCost(minTaskCost)
+    {
+      eigen_assert(minTaskCost>0);
+    }
+
+    ThreadPoolInterface& pool() const { return m_pool; }
+
+    /** \returns the number of threads a job may use, the calling thread running one of its tasks */
+    int numThreads() const { return (std::max)(1, m_pool.NumThreads()); }
+
+    /** \internal \returns the number of tasks, at most \a maxTasks, among which a job of cost \a cost should be split */
+    Index numTasks(double cost, Index maxTasks) const
+    {
+      if(m_pool.CurrentThreadId()!=-1)
+        return 1;
+      const double tasks = (std::min)(double((std::min)(Index(numThreads()), maxTasks)), cost / m_minTaskCost);
+      return (std::max)(Index(1), Index(tasks));
+    }
+
+    /** \internal Calls \a task(t) for t in [0,tasks), tasks 0 to \a tasks-2 on the pool and the last one
+      * on the calling thread, and returns once all of them completed. */
+    template<typename Task>
+    void run(Index tasks, const Task& task) const
+    {
+      Barrier barrier(static_cast<unsigned int>(tasks-1));
+      for(Index t=0; t<tasks-1; ++t)
+        m_pool.Schedule([&task, &barrier, t]() { task(t); barrier.Notify(); });
+      task(tasks-1);
+      barrier.Wait();
+    }
+
+  private:
+    ThreadPoolInterface& m_pool;
+    double m_minTaskCost;
+};
+
+namespace internal {
+
+// Assigns the units [begin,end) of a kernel: inner slices, or coefficients or packets of the linear
+// traversals. The traversals are the ones of the sequential dense_assignment_loop.
+template<typename Kernel, int Traversal = Kernel::AssignmentTraits::Traversal>
+struct thread_pool_assignment_range
+{
+  // units are inner slices
+  static void run(Kernel &kernel, Index begin, Index end)
+  {
+    const Index innerSize = kernel.innerSize();
+    for(Index outer = begin; outer < end; ++outer)
+      for(Index inner = 0; inner < innerSize; ++inner)
+        kernel.assignCoeffByOuterInner(outer, inner);
+  }
+};
+
+template<typename Kernel>
+struct thread_pool_assignment_range<Kernel, LinearTraversal>
+{
+  // units are coefficients
+  static void run(Kernel &kernel, Index begin, Index end)
+  {
+    for(Index index = begin; index < end; ++index)
+      kernel.assignCoeff(index);
+  }
+};
+
+template<typename Kernel>
+struct thread_pool_assignment_range<Kernel, InnerVectorizedTraversal>
+{
+  // units are inner slices, made of whole packets
+  static void run(Kernel &kernel, Index begin, Index end)
+  {
+    typedef typename Kernel::PacketType PacketType;
+    typedef typename Kernel::AssignmentTraits Traits;
+    const Index innerSize = kernel.innerSize();
+    const Index packetSize = unpacket_traits<PacketType>::size;
+    for(Index outer = begin; outer < end; ++outer)
+      for(Index inner = 0; inner < innerSize; inner += packetSize)
+        kernel.template assignPacketByOuterInner<Traits::DstAlignment, Traits::SrcAlignment, PacketType>(outer, inner);
+  }
+};
+
+template<typename Kernel>
+struct thread_pool_assignment_range<Kernel, SliceVectorizedTraversal>
+{
+  // units are inner slices, each one being assigned by unaligned packets followed by its remaining coefficients
+  static void run(Kernel &kernel, Index begin, Index end)
+  {
+    typedef typename Kernel::PacketType PacketType;
+    typedef typename Kernel::Scalar Scalar;
+    if((UIntPtr(kernel.dstDataPtr()) % sizeof(Scalar))>0)
+      return thread_pool_assignment_range<Kernel,DefaultTraversal>::run(kernel, begin, end);
+    const Index innerSize = kernel.innerSize();
+    const Index packetSize = unpacket_traits<PacketType>::size;
+    const Index alignedEnd = (innerSize/packetSize)*packetSize;
+    for(Index outer = begin; outer < end; ++outer)
+    {
+      for(Index inner = 0; inner < alignedEnd; inner += packetSize)
+        kernel.template assignPacketByOuterInner<Unaligned, Unaligned, PacketType>(outer, inner);
+      for(Index inner = alignedEnd; inner < innerSize; ++inner)
+        kernel.assignCoeffByOuterInner(outer, inner);
+    }
+  }
+};
+
+template<typename Kernel>
+struct thread_pool_assignment_range<Kernel, LinearVectorizedTraversal>
+{
+  typedef typename Kernel::Scalar Scalar;
+  typedef typename Kernel::PacketType PacketType;
+  enum {
+    requestedAlignment = Kernel::AssignmentTraits::LinearRequiredAlignment,
+    dstAlignment = packet_traits<Scalar>::AlignedOnScalar ? int(requestedAlignment)
+                                                          : int(Kernel::AssignmentTraits::DstAlignment),
+    srcAlignment = Kernel::AssignmentTraits::JointAlignment
+  };
+
+  // units are packets, the start of the range being aligned as in the sequential loop
+  static void run(Kernel &kernel, Index begin, Index end)
+  {
+    for(Index index = begin; index < end; index += unpacket_traits<PacketType>::size)
+      kernel.template assignPacket<dstAlignment, srcAlignment, PacketType>(index);
+  }
+};
+
+template<typename Kernel>
+struct dense_assignment_loop_with_device<Kernel, CoreThreadPoolDevice>
+{
+  typedef typename Kernel::AssignmentTraits Traits;
+  typedef typename Kernel::PacketType PacketType;
+  enum {
+    Traversal = Traits::Traversal,
+    IsLinear = int(Traversal)==LinearVectorizedTraversal || int(Traversal)==LinearTraversal,
+    PacketSize = Traits::Vectorized ? int(unpacket_traits<PacketType>::size) : 1,
+    // cost of the assignment of one coefficient according to the cost model of the evaluators
+    CoeffCost = int(Kernel::DstEvaluatorType::CoeffReadCost) + int(Kernel::SrcEvaluatorType::CoeffReadCost)
+  };
+  typedef thread_pool_assignment_range<Kernel> Range;
+
+  static void run(Kernel &kernel, CoreThreadPoolDevice &device)
+  {
+    const Index size = kernel.size();
+    const double cost = double(size) * double(CoeffCost) / double(PacketSize);
+    const Index units = IsLinear ? size / PacketSize : kernel.outerSize();
+    const Index tasks = int(Traversal)==AllAtOnceTraversal ? 1 : device.numTasks(cost, units);
+    if(tasks<=1)
+      return dense_assignment_loop<Kernel>::run(kernel);
+
+    Index start = 0, end = IsLinear ? size : kernel.outerSize();
+    if(int(Traversal)==LinearVectorizedTraversal)
+    {
+      // the unaligned head and the tail are assigned by the calling thread
+      const bool dstIsAligned = int(Traits::DstAlignment)>=int(Traits::LinearRequiredAlignment);
+      start = dstIsAligned ? 0 : internal::first_aligned<Traits::LinearRequiredAlignment>(kernel.dstDataPtr(), size);
+      end = start + ((size-start)/PacketSize)*PacketSize;
+      for(Index index = 0; index < start; ++index)
+        kernel.assignCoeff(index);
+      for(Index index = end; index < size; ++index)
+        kernel.assignCoeff(index);
+    }
+
+    // the tasks get consecutive ranges of whole units (packets for LinearVectorizedTraversal)
+    const Index step = int(Traversal)==LinearVectorizedTraversal ? Index(PacketSize) : Index(1);
+    const Index count = (end-start)/step;
+    device.run(tasks, [&kernel, start, step, count, tasks](Index t) {
+      const Index first = start + (count*t/tasks)*step;
+      const Index last = start + (count*(t+1)/tasks)*step;
+      Range::run(kernel, first, last);
+    });
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_CORE_THREAD_POOL_DEVICE_H
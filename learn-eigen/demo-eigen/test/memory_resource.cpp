@@ -0,0 +1,162 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "main.h"
+
+#if EIGEN_HAS_MEMORY_RESOURCE
+
+#include <atomic>
+#include <thread>
+
+// a thread-safe resource counting its blocks, served by the heap
+class counting_resource : public MemoryResource
+{
+  public:
+    counting_resource() : live(0), total(0) {}
+
+    virtual void* allocate(std::size_t bytes, std::size_t)
+    {
+      ++live;
+      ++total;
+      return internal::aligned_malloc(bytes);
+    }
+
+    virtual void deallocate(void* ptr, std::size_t)
+    {
+      --live;
+      internal::aligned_free(ptr);
+    }
+
+    std::atomic<int> live;
+    std::atomic<int> total;
+};
+
+void memory_resource_scopes()
+{
+  MonotonicBuffer buffer(1 << 16);
+  const MatrixXd H = MatrixXd::Random(20,20);
+  MatrixXd outlive;
+  {
+    ScopedMemoryResource scope(buffer);
+    VERIFY(ScopedMemoryResource::current()==&buffer);
+    MatrixXd A = MatrixXd::Random(30,30);
+    VERIFY(buffer.owns(A.data()));
+    VERIFY_IS_EQUAL(internal::UIntPtr(A.data()) % EIGEN_DEFAULT_ALIGN_BYTES, internal::UIntPtr(0));
+    MatrixXd B = A * A.transpose() + A;
+    VERIFY(buffer.owns(B.data()));
+    VERIFY_IS_APPROX(B, (A.lazyProduct(A.transpose()) + A).eval());
+
+    // the last allocation is given back
+    const std::size_t used = buffer.used();
+    {
+      VectorXd tmp = VectorXd::Ones(100);
+      VERIFY(buffer.used()>used);
+    }
+    VERIFY_IS_EQUAL(buffer.used(), used);
+
+    // nested scopes, the memory of the outer resource going back to it
+    counting_resource inner;
+    {
+      ScopedMemoryResource innerScope(inner);
+      VERIFY(ScopedMemoryResource::current()==&inner);
+      MatrixXd C = A;
+      VERIFY(!buffer.owns(C.data()));
+      A.resize(10,10);
+      VERIFY(!buffer.owns(A.data()));
+      VERIFY_IS_EQUAL(inner.live.load(), 2);
+    }
+    VERIFY(ScopedMemoryResource::current()==&buffer);
+    A.resize(0,0);
+    VERIFY_IS_EQUAL(inner.live.load(), 0);
+    outlive.swap(B);
+  }
+  VERIFY(ScopedMemoryResource::current()==0);
+
+  // memory freed or moved after the end of its scope
+  VERIFY(buffer.owns(outlive.data()));
+  outlive.conservativeResize(40,40);
+  VERIFY(!buffer.owns(outlive.data()));
+  outlive.resize(0,0);
+  MatrixXd G = H;
+  G.conservativeResize(30,30);
+  VERIFY_IS_EQUAL(G.topLeftCorner(20,20), H);
+
+  buffer.release();
+  VERIFY_IS_EQUAL(buffer.used(), std::size_t(0));
+}
+
+// each thread serves its requests from its own buffer, while the blocks of a shared resource and of the heap are
+// freed by other threads
+void memory_resource_threads()
+{
+  const int threads = 4, rounds = 50;
+  const MatrixXd A = MatrixXd::Random(24,24);
+  const MatrixXd ref = A * A.transpose() + A;
+  MonotonicBuffer buffers[threads];
+  counting_resource shared;
+  std::vector<MatrixXd> handed(threads*rounds), kept(threads);
+  std::vector<MatrixXd> heap(threads*rounds, MatrixXd::Ones(8,8));
+  std::atomic<int> errors(0);
+
+  std::vector<std::thread> workers;
+  for(int t = 0; t < threads; ++t)
+    workers.push_back(std::thread([&, t]() {
+      MonotonicBuffer& buffer = buffers[t];
+      for(int r = 0; r < rounds; ++r)
+      {
+        {
+          ScopedMemoryResource scope(buffer);
+          MatrixXd B = A * A.transpose() + A;
+          B.conservativeResize(30,24);
+          if(!B.topRows(24).isApprox(ref) || !buffer.owns(B.data()))
+            ++errors;
+          if(r==rounds-1)
+            kept[t] = B.topRows(24);
+        }
+        {
+          ScopedMemoryResource scope(shared);
+          MatrixXd C = A.transpose();
+          handed[((t+1)%threads)*rounds+r].swap(C);
+        }
+        heap[((t+2)%threads)*rounds+r].resize(0,0);
+        if(r<rounds-1)
+          buffer.release();
+      }
+    }));
+  for(int t = 0; t < threads; ++t)
+    workers[t].join();
+  VERIFY_IS_EQUAL(errors.load(), 0);
+  VERIFY_IS_EQUAL(shared.total.load(), threads*rounds);
+  VERIFY_IS_EQUAL(shared.live.load(), threads*rounds);
+
+  // the blocks of the shared resource go back to it from the main thread, and the ones of the buffers, which are
+  // not installed on it, are left alone
+  for(std::size_t i = 0; i < handed.size(); ++i)
+    VERIFY_IS_APPROX(handed[i], A.transpose());
+  handed.clear();
+  VERIFY_IS_EQUAL(shared.live.load(), 0);
+  for(int t = 0; t < threads; ++t)
+  {
+    VERIFY(buffers[t].owns(kept[t].data()));
+    VERIFY_IS_APPROX(kept[t], ref);
+    const std::size_t used = buffers[t].used();
+    kept[t].resize(0,0);
+    VERIFY_IS_EQUAL(buffers[t].used(), used);
+  }
+}
+
+#endif // EIGEN_HAS_MEMORY_RESOURCE
+
+EIGEN_DECLARE_TEST(memory_resource)
+{
+#if EIGEN_HAS_MEMORY_RESOURCE
+  for(int i = 0; i < g_repeat; i++) {
+    CALL_SUBTEST_1( memory_resource_scopes() );
+    CALL_SUBTEST_2( memory_resource_threads() );
+  }
+#endif
+}
@@ -0,0 +1,95 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "main.h"
+#include <Eigen/NpyIO>
+
+static const char* npyio_filename = "npyio_test.npy";
+
+// writes a version 1.0 file made of the header dictionary \a dict and \a dataSize zero bytes
+static void write_npy(const std::string& dict, std::size_t dataSize)
+{
+  std::string header = "\x93NUMPY\x01";
+  header += '\0';
+  header += char(dict.size() & 0xff);
+  header += char(dict.size() >> 8);
+  header += dict;
+  header.append(dataSize, '\0');
+  std::FILE* file = std::fopen(npyio_filename, "wb");
+  VERIFY(file!=0);
+  VERIFY(std::fwrite(header.data(), 1, header.size(), file)==header.size());
+  std::fclose(file);
+}
+
+template<typename MatrixType>
+void npyio_roundtrip(Index rows, Index cols)
+{
+  const MatrixType m = MatrixType::Random(rows, cols);
+  VERIFY(saveNpy(npyio_filename, m));
+  MatrixType loaded;
+  VERIFY(loadNpy(npyio_filename, loaded));
+  VERIFY_IS_EQUAL(loaded, m);
+
+  MappedNpyFile file;
+  VERIFY(file.open(npyio_filename));
+  VERIFY(file.isCompatible<MatrixType>());
+  VERIFY_IS_EQUAL(MatrixType(file.map<MatrixType>()), m);
+}
+
+void npyio_corrupted()
+{
+  typedef Matrix<double,Dynamic,Dynamic,RowMajor> RowMajorMatrix;
+  RowMajorMatrix m;
+  MappedNpyFile file;
+
+  // a shape whose number of bytes overflows
+  write_npy("{'descr': '<f8', 'fortran_order': False, 'shape': (4611686018427387904, 4), }\n", 16);
+  VERIFY(!loadNpy(npyio_filename, m));
+  VERIFY(file.open(npyio_filename));
+  VERIFY(!file.isCompatible<RowMajorMatrix>());
+
+  // a shape larger than the data, and one which fits exactly
+  write_npy("{'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }\n", 11*sizeof(double));
+  VERIFY(!loadNpy(npyio_filename, m));
+  VERIFY(file.open(npyio_filename));
+  VERIFY(!file.isCompatible<RowMajorMatrix>());
+  write_npy("{'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }\n", 12*sizeof(double));
+  VERIFY(loadNpy(npyio_filename, m));
+  VERIFY(m.rows()==3 && m.cols()==4 && m.isZero());
+  VERIFY(file.open(npyio_filename));
+  VERIFY(file.isCompatible<RowMajorMatrix>());
+
+  // empty arrays
+  write_npy("{'descr': '<f8', 'fortran_order': False, 'shape': (0, 4611686018427387904), }\n", 0);
+  VERIFY(file.open(npyio_filename));
+  VERIFY(file.isCompatible<RowMajorMatrix>());
+
+  // a version 2.0 header announcing 4GB
+  std::string header = "\x93NUMPY\x02";
+  header += '\0';
+  header.append(4, '\xff');
+  header.append(64, ' ');
+  std::FILE* f = std::fopen(npyio_filename, "wb");
+  VERIFY(f!=0);
+  VERIFY(std::fwrite(header.data(), 1, header.size(), f)==header.size());
+  std::fclose(f);
+  VERIFY(!loadNpy(npyio_filename, m));
+  VERIFY(!file.open(npyio_filename));
+}
+
+EIGEN_DECLARE_TEST(npyio)
+{
+  for(int i = 0; i < g_repeat; i++) {
+    const Index rows = internal::random<Index>(1,50), cols = internal::random<Index>(1,50);
+    CALL_SUBTEST_1( npyio_roundtrip<MatrixXd>(rows, cols) );
+    CALL_SUBTEST_1(( npyio_roundtrip<Matrix<float,Dynamic,Dynamic,RowMajor> >(rows, cols) ));
+    CALL_SUBTEST_1( npyio_roundtrip<VectorXi>(rows, 1) );
+    CALL_SUBTEST_1( npyio_roundtrip<RowVectorXf>(1, cols) );
+  }
+  CALL_SUBTEST_2( npyio_corrupted() );
+  std::remove(npyio_filename);
+}
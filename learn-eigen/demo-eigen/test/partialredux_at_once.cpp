@@ -0,0 +1,90 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// heap allocation will raise an assert if enabled at runtime
+#define EIGEN_RUNTIME_NO_MALLOC
+
+#include "main.h"
+
+template<typename MatrixType> void partialredux_at_once(Index rows, Index cols)
+{
+  typedef typename MatrixType::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,1> VectorType;
+  typedef Matrix<Scalar,1,Dynamic> RowVectorType;
+
+  MatrixType m = MatrixType::Random(rows, cols);
+  VectorType colRef(cols), rowRef(rows), colMax(cols), rowMax(rows), colNorm(cols);
+  for(Index j = 0; j < cols; ++j)
+  {
+    colRef(j) = m.col(j).sum();
+    colMax(j) = m.col(j).maxCoeff();
+    colNorm(j) = m.col(j).squaredNorm();
+  }
+  for(Index i = 0; i < rows; ++i)
+  {
+    rowRef(i) = m.row(i).sum();
+    rowMax(i) = m.row(i).maxCoeff();
+  }
+
+  RowVectorType c = m.colwise().sum();
+  VERIFY_IS_APPROX(c.transpose(), colRef);
+  VectorType ct = m.colwise().sum();
+  VERIFY_IS_APPROX(ct, colRef);
+  VectorType r = m.rowwise().sum();
+  VERIFY_IS_APPROX(r, rowRef);
+  VERIFY_IS_EQUAL((m.colwise().maxCoeff()).transpose().eval(), colMax);
+  VERIFY_IS_EQUAL(m.rowwise().maxCoeff().eval(), rowMax);
+  c = m.colwise().squaredNorm();
+  VERIFY_IS_APPROX(c.transpose(), colNorm);
+
+  // the partial reductions assigned to plain vectors of the right size do not allocate
+  RowVectorType c2(cols);
+  VectorType r2(rows);
+  internal::set_is_malloc_allowed(false);
+  c2.noalias() = m.colwise().sum();
+  r2.noalias() = m.rowwise().sum();
+  c2 = m.colwise().maxCoeff();
+  r2 = m.rowwise().minCoeff();
+  internal::set_is_malloc_allowed(true);
+  VERIFY_IS_EQUAL(c2.transpose(), colMax);
+  VERIFY_IS_EQUAL(r2, m.rowwise().minCoeff().eval());
+
+  // other destinations take the lazy evaluation
+  MatrixType d = MatrixType::Zero(2, cols);
+  d.row(1) = m.colwise().sum();
+  VERIFY_IS_APPROX(d.row(1).transpose().eval(), colRef);
+  VERIFY_IS_APPROX((m.colwise().sum() * Scalar(2)).transpose().eval(), Scalar(2) * colRef);
+
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
+  // the threaded evaluation gives the same result, whatever the shape of the result
+  const int threads = nbThreads();
+  setParallelReductions(true);
+  setNbThreads(4);
+  c = m.colwise().sum();
+  VERIFY_IS_APPROX(c.transpose(), colRef);
+  r = m.rowwise().sum();
+  VERIFY_IS_APPROX(r, rowRef);
+  VERIFY_IS_EQUAL((m.colwise().maxCoeff()).transpose().eval(), colMax);
+  VERIFY_IS_EQUAL(m.rowwise().maxCoeff().eval(), rowMax);
+  setParallelReductions(false);
+  setNbThreads(threads);
+#endif
+}
+
+EIGEN_DECLARE_TEST(partialredux_at_once)
+{
+  for(int i = 0; i < g_repeat; i++) {
+    // strided reductions with a wide result
+    CALL_SUBTEST_1(( partialredux_at_once<Matrix<float,Dynamic,Dynamic,RowMajor> >(200, 5000) ));
+    CALL_SUBTEST_2(( partialredux_at_once<MatrixXd>(5000, 200) ));
+    // with a narrow result, and sizes which are not multiples of the packets
+    CALL_SUBTEST_3(( partialredux_at_once<Matrix<double,Dynamic,Dynamic,RowMajor> >(20000, 3) ));
+    CALL_SUBTEST_4(( partialredux_at_once<MatrixXf>(internal::random<int>(1,13), internal::random<int>(1000,20000)) ));
+    CALL_SUBTEST_5(( partialredux_at_once<Matrix<float,Dynamic,Dynamic,RowMajor> >(internal::random<int>(100,1000), internal::random<int>(10,200)) ));
+    CALL_SUBTEST_6(( partialredux_at_once<Matrix<int,Dynamic,Dynamic,RowMajor> >(300, 301) ));
+  }
+}
@@ -0,0 +1,104 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "main.h"
+
+// an epilogue depending on the position of each coefficient, which counts the visits of each of them
+template<typename Scalar>
+struct indexed_epilogue
+{
+  MatrixXi* visits;
+
+  template<typename Block> void operator()(Block& block, Index row, Index col) const
+  {
+    VERIFY(row>=0 && col>=0 && row+block.rows()<=visits->rows() && col+block.cols()<=visits->cols());
+    for(Index j = 0; j < block.cols(); ++j)
+      for(Index i = 0; i < block.rows(); ++i)
+      {
+        block(i,j) = Scalar(2)*block(i,j) + Scalar(row+i) - Scalar(3*(col+j));
+        ++visits->coeffRef(row+i, col+j);
+      }
+  }
+};
+
+template<typename DstType, typename LhsType, typename RhsType>
+void product_epilogue_check(const LhsType& lhs, const RhsType& rhs)
+{
+  typedef typename DstType::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,Dynamic> PlainType;
+  const Index rows = lhs.rows(), cols = rhs.cols();
+  PlainType ref = Scalar(2) * (lhs.template cast<Scalar>().eval() * rhs.template cast<Scalar>().eval());
+  for(Index j = 0; j < cols; ++j)
+    for(Index i = 0; i < rows; ++i)
+      ref(i,j) += Scalar(i) - Scalar(3*j);
+
+  MatrixXi visits = MatrixXi::Zero(rows, cols);
+  indexed_epilogue<Scalar> epilogue = { &visits };
+  DstType dst;
+  productWithEpilogue(lhs, rhs, dst, epilogue);
+  VERIFY_IS_EQUAL(dst.rows(), rows);
+  VERIFY_IS_EQUAL(dst.cols(), cols);
+  VERIFY_IS_APPROX(PlainType(dst), ref);
+  VERIFY((visits.array()==1).all());
+
+  // a block of a larger matrix, whose surroundings are left untouched
+  DstType big = DstType::Zero(rows+3, cols+2);
+  Block<DstType> block(big, 1, 2, rows, cols);
+  visits.setZero();
+  productWithEpilogue(lhs, rhs, block, epilogue);
+  VERIFY_IS_APPROX(PlainType(block), ref);
+  VERIFY((visits.array()==1).all());
+  VERIFY(big.row(0).isZero() && big.bottomRows(2).isZero() && big.leftCols(2).isZero());
+
+  // a destination without a unit inner stride, evaluated in a temporary
+  PlainType storage = PlainType::Zero(2*rows, cols);
+  Map<PlainType, 0, Stride<Dynamic,2> > strided(storage.data(), rows, cols, Stride<Dynamic,2>(2*rows, 2));
+  visits.setZero();
+  productWithEpilogue(lhs, rhs, strided, epilogue);
+  VERIFY_IS_APPROX(PlainType(strided), ref);
+  VERIFY((visits.array()==1).all());
+}
+
+template<typename Scalar>
+void product_epilogue(Index rows, Index depth, Index cols)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> ColMajorMatrix;
+  typedef Matrix<Scalar,Dynamic,Dynamic,RowMajor> RowMajorMatrix;
+  const ColMajorMatrix lhs = ColMajorMatrix::Random(rows, depth);
+  const ColMajorMatrix rhs = ColMajorMatrix::Random(depth, cols);
+  const RowMajorMatrix rowMajorLhs = lhs;
+
+  product_epilogue_check<ColMajorMatrix>(lhs, rhs);
+  product_epilogue_check<RowMajorMatrix>(lhs, rhs);
+  product_epilogue_check<ColMajorMatrix>(rowMajorLhs, rhs);
+  product_epilogue_check<RowMajorMatrix>(rowMajorLhs, rhs.transpose().transpose());
+
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_GEMM_THREADPOOL)
+  // the threads of the product hand disjoint blocks to the epilogue
+  const int threads = nbThreads();
+  setNbThreads(4);
+  product_epilogue_check<ColMajorMatrix>(lhs, rhs);
+  product_epilogue_check<RowMajorMatrix>(rowMajorLhs, rhs);
+  setNbThreads(threads);
+#endif
+}
+
+EIGEN_DECLARE_TEST(product_epilogue)
+{
+  for(int i = 0; i < g_repeat; i++) {
+    // the small products evaluated coefficient-wise
+    CALL_SUBTEST_1( product_epilogue<float>(internal::random<int>(1,6), internal::random<int>(1,6), internal::random<int>(1,6)) );
+    CALL_SUBTEST_1( product_epilogue<double>(3, 0, 4) );
+    // the products degenerating to matrix-vector products
+    CALL_SUBTEST_2( product_epilogue<double>(1, internal::random<int>(20,200), internal::random<int>(20,200)) );
+    CALL_SUBTEST_2( product_epilogue<double>(internal::random<int>(20,200), internal::random<int>(20,200), 1) );
+    // the blocked products, with several panels along each dimension
+    CALL_SUBTEST_3( product_epilogue<float>(internal::random<int>(50,300), internal::random<int>(50,300), internal::random<int>(50,300)) );
+    CALL_SUBTEST_4( product_epilogue<double>(internal::random<int>(400,700), internal::random<int>(300,600), internal::random<int>(200,500)) );
+    CALL_SUBTEST_5( product_epilogue<std::complex<double> >(internal::random<int>(20,200), internal::random<int>(20,200), internal::random<int>(20,200)) );
+  }
+}
@@ -0,0 +1,75 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "main.h"
+
+template<typename MatrixType>
+bool parse_string(const std::string& text, MatrixType& m, char separator = ',')
+{
+  return parseText(text.data(), text.data()+text.size(), m, separator);
+}
+
+template<typename MatrixType>
+void textio_roundtrip(Index rows, Index cols)
+{
+  const MatrixType m = MatrixType::Random(rows, cols);
+  std::string text;
+  appendText(text, m, IOFormat(FullPrecision, DontAlignCols, ", ", "\n"));
+  MatrixType parsed;
+  VERIFY(parse_string(text, parsed));
+  VERIFY_IS_APPROX(parsed, m);
+}
+
+template<typename Scalar>
+void textio_out_of_range()
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  MatrixType m;
+  VERIFY(parse_string("1e400000 2\n3 -1e400000", m));
+  VERIFY(m.rows()==2 && m.cols()==2);
+  VERIFY((numext::isinf)(m(0,0)) && m(0,0)>0);
+  VERIFY((numext::isinf)(m(1,1)) && m(1,1)<0);
+  VERIFY_IS_EQUAL(m(0,1), Scalar(2));
+  VERIFY_IS_EQUAL(m(1,0), Scalar(3));
+
+  VERIFY(parse_string("1e-400000, -1e-400000\n# comment\n+1.5, 4", m));
+  VERIFY_IS_EQUAL(m(0,0), Scalar(0));
+  VERIFY_IS_EQUAL(m(0,1), Scalar(0));
+  VERIFY_IS_EQUAL(m(1,0), Scalar(1.5));
+
+  // trailing characters are still rejected
+  VERIFY(!parse_string("1e400000x 2\n3 4", m));
+  VERIFY(!parse_string("1 2\n3 4 5", m));
+  VERIFY(!parse_string("1,,2", m));
+}
+
+void textio_integers()
+{
+  MatrixXi m;
+  VERIFY(parse_string("1 -2\n3 +4", m));
+  VERIFY_IS_EQUAL(m, (MatrixXi(2,2) << 1, -2, 3, 4).finished());
+  VERIFY(!parse_string("1 99999999999\n3 4", m));
+  VERIFY(!parse_string("1 1.5\n3 4", m));
+  Matrix<unsigned char,Dynamic,1> u;
+  VERIFY(!parse_string("1\n256", u));
+  VERIFY(!parse_string("-1", u));
+}
+
+EIGEN_DECLARE_TEST(textio)
+{
+  for(int i = 0; i < g_repeat; i++) {
+    const Index rows = internal::random<Index>(1,30), cols = internal::random<Index>(1,30);
+    CALL_SUBTEST_1( textio_roundtrip<MatrixXd>(rows, cols) );
+    CALL_SUBTEST_1( textio_roundtrip<MatrixXf>(rows, cols) );
+    CALL_SUBTEST_1( textio_roundtrip<VectorXi>(rows, 1) );
+    CALL_SUBTEST_1( textio_roundtrip<RowVectorXd>(1, cols) );
+  }
+  CALL_SUBTEST_2( textio_out_of_range<float>() );
+  CALL_SUBTEST_2( textio_out_of_range<double>() );
+  CALL_SUBTEST_2( textio_out_of_range<long double>() );
+  CALL_SUBTEST_3( textio_integers() );
+}
@@ -0,0 +1,138 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "main.h"
+
+// the coefficient found by a traversal of m in column-major order, which keeps the current one unless the
+// next one is strictly better, as the scalar visitors do
+template<int NaNPropagation, bool IsMax, typename MatrixType>
+typename MatrixType::Scalar reference_extremum(const MatrixType& m, Index& row, Index& col)
+{
+  typedef typename MatrixType::Scalar Scalar;
+  Scalar res = m(0,0);
+  row = col = 0;
+  for(Index j = 0; j < m.cols(); ++j)
+    for(Index i = (j==0 ? 1 : 0); i < m.rows(); ++i)
+    {
+      const Scalar value = m(i,j);
+      const bool better = IsMax ? value > res : value < res;
+      bool take = better;
+      if(NaNPropagation==PropagateNumbers)
+        take = (numext::isnan)(res) || (!(numext::isnan)(value) && better);
+      else if(NaNPropagation==PropagateNaN)
+        take = (numext::isnan)(value) || better;
+      if(take)
+      {
+        res = value;
+        row = i;
+        col = j;
+      }
+    }
+  return res;
+}
+
+template<typename Scalar>
+bool same_value(const Scalar& a, const Scalar& b)
+{
+  return a==b || ((numext::isnan)(a) && (numext::isnan)(b));
+}
+
+template<int NaNPropagation, typename MatrixType> void check_extrema(const MatrixType& m)
+{
+  typedef typename MatrixType::Scalar Scalar;
+  Index refRow, refCol, row, col;
+
+  Scalar ref = reference_extremum<NaNPropagation,false>(m, refRow, refCol);
+  Scalar res = m.template minCoeff<NaNPropagation>(&row, &col);
+  VERIFY(same_value(res, ref));
+  VERIFY_IS_EQUAL(row, refRow);
+  VERIFY_IS_EQUAL(col, refCol);
+
+  ref = reference_extremum<NaNPropagation,true>(m, refRow, refCol);
+  res = m.template maxCoeff<NaNPropagation>(&row, &col);
+  VERIFY(same_value(res, ref));
+  VERIFY_IS_EQUAL(row, refRow);
+  VERIFY_IS_EQUAL(col, refCol);
+
+  if(m.cols()==1)
+  {
+    Index index;
+    Matrix<Scalar,Dynamic,1> v = m.col(0);
+    ref = reference_extremum<NaNPropagation,true>(m, refRow, refCol);
+    res = v.template maxCoeff<NaNPropagation>(&index);
+    VERIFY(same_value(res, ref));
+    VERIFY_IS_EQUAL(index, refRow);
+    ref = reference_extremum<NaNPropagation,false>(m, refRow, refCol);
+    res = v.template minCoeff<NaNPropagation>(&index);
+    VERIFY(same_value(res, ref));
+    VERIFY_IS_EQUAL(index, refRow);
+  }
+}
+
+template<typename MatrixType> void visitor_vectorized(Index rows, Index cols)
+{
+  typedef typename MatrixType::Scalar Scalar;
+
+  // few distinct values, so that the extrema are tied: the lowest index in column-major order wins
+  MatrixType m(rows, cols);
+  for(Index k = 0; k < m.size(); ++k)
+    m.data()[k] = Scalar(internal::random<int>(-3,3));
+  check_extrema<PropagateFast>(m);
+  check_extrema<PropagateNumbers>(m);
+  check_extrema<PropagateNaN>(m);
+
+  m.setConstant(Scalar(2));
+  check_extrema<PropagateFast>(m);
+
+  m = MatrixType::Random(rows, cols);
+  check_extrema<PropagateFast>(m);
+  check_extrema<PropagateNumbers>(m);
+  check_extrema<PropagateNaN>(m);
+
+  if(!NumTraits<Scalar>::IsInteger)
+  {
+    const Scalar nan = NumTraits<Scalar>::quiet_NaN();
+    const Index last = m.size()-1;
+    const Index positions[] = { 0, last, internal::random<Index>(0, last) };
+    for(int p = 0; p < 3; ++p)
+    {
+      MatrixType m2 = m;
+      m2(positions[p] % rows, positions[p] / rows) = nan;
+      check_extrema<PropagateNumbers>(m2);
+      check_extrema<PropagateNaN>(m2);
+    }
+
+    MatrixType m2 = m;
+    m2(0,0) = nan;
+    m2(last % rows, last / rows) = nan;
+    check_extrema<PropagateNumbers>(m2);
+    check_extrema<PropagateNaN>(m2);
+
+    m2.setConstant(nan);
+    check_extrema<PropagateNumbers>(m2);
+    check_extrema<PropagateNaN>(m2);
+  }
+}
+
+EIGEN_DECLARE_TEST(visitor_vectorized)
+{
+  for(int i = 0; i < g_repeat; i++) {
+    // sizes which are not multiples of the packets, down to a single coefficient
+    const Index n = internal::random<Index>(1, 2000);
+    CALL_SUBTEST_1( visitor_vectorized<VectorXf>(n, 1) );
+    CALL_SUBTEST_1( visitor_vectorized<VectorXf>(1, 1) );
+    CALL_SUBTEST_1( visitor_vectorized<VectorXf>(17, 1) );
+    CALL_SUBTEST_2( visitor_vectorized<VectorXd>(n, 1) );
+    CALL_SUBTEST_2( visitor_vectorized<VectorXd>(3, 1) );
+    CALL_SUBTEST_3( visitor_vectorized<VectorXi>(n, 1) );
+    CALL_SUBTEST_3( visitor_vectorized<VectorXi>(33, 1) );
+    CALL_SUBTEST_4( visitor_vectorized<MatrixXf>(internal::random<Index>(1, 60), internal::random<Index>(1, 60)) );
+    CALL_SUBTEST_5( visitor_vectorized<MatrixXd>(internal::random<Index>(1, 60), internal::random<Index>(1, 60)) );
+    CALL_SUBTEST_6(( visitor_vectorized<Matrix<float,Dynamic,Dynamic,RowMajor> >(internal::random<Index>(1, 60), internal::random<Index>(1, 60)) ));
+    CALL_SUBTEST_7( visitor_vectorized<MatrixXi>(internal::random<Index>(1, 60), internal::random<Index>(1, 60)) );
+  }
+}